@@ -1,21 +1,47 @@
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <direct.h>
+#endif
 #include "audio.h"
+#include "chunkstream.h"
 #include "config.h"
 #include "editor.h"
 #include "fps_meter.h"
 #include "game.h"
 #include "input_config.h"
 #include "level.h"
+#include "levelbake.h"
+#include "levelpack.h"
+#include "levelhistory.h"
+#include "levelsave.h"
+#include "levelthumb.h"
+#include "levelwatch.h"
 #include "menu.h"
 #include "raylib.h"
 #include "render.h"
+#include "replay.h"
+#include "rewind.h"
 #include "screens.h"
 #include "settings.h"
+#include "stress.h"
 #include "ui.h"
+#include "world.h"
 
 static const UiListSpec LIST_SPEC = {.startY = 70.0f, .stepY = 30.0f, .itemHeight = 24.0f, .fontSize = 24};
+static World gWorld;
+static WorldSnapshot gLevelStart; // state right after the current level loaded; restarts restore it
+static WorldSnapshot gEditorState; // the editor's world while a test play runs on its level
+static RewindBuffer gRewind; // per-tick history of the current run
+static bool gRewinding = false;
+static Replay gReplay; // input + state hashes of the current run
+static bool gRunReloaded = false; // the level changed on disk mid-run, so the replay cannot be re-simulated
 static LevelCatalog gCatalog;
 static int gCatalogIndex = 0;
 
@@ -24,10 +50,45 @@ static const char *CatalogLabelAtCB(int i, void *ud) {
 	return c->items[i].baseName;
 }
 
+// Cheap every frame: rescans only after the level directories change
+static void RefreshCatalog(void) {
+	if (!Level_CatalogRefresh(&gCatalog, GetTime())) return;
+	if (gCatalogIndex >= gCatalog.count) gCatalogIndex = gCatalog.count > 0 ? gCatalog.count - 1 : 0;
+}
+
 static const Color BG_CLOUD = {196, 225, 255, 255};
 
+// Preview of the selected level beside the list. The other rows on screen are prefetched as CPU
+// images so moving the selection shows them at once; only the drawn one becomes a texture. The
+// selected one is requested last so the worker renders it first.
+static void RenderLevelPreview(void) {
+	for (int i = 0; i < gCatalog.count; ++i) {
+		Rectangle row = UiListItemRect(&LIST_SPEC, i);
+		if (row.y >= (float)GetScreenHeight()) break;
+		if (row.y + row.height <= 0.0f || i == gCatalogIndex) continue;
+		LevelThumb_Prefetch(&gCatalog.items[i]);
+	}
+	if (gCatalogIndex >= gCatalog.count) return;
+	const LevelEntry *e = &gCatalog.items[gCatalogIndex];
+	const Texture2D *thumb = LevelThumb_Get(e);
+	Rectangle box = {(float)(GetScreenWidth() - LEVEL_THUMB_WIDTH - 40), LIST_SPEC.startY, (float)LEVEL_THUMB_WIDTH, (float)LEVEL_THUMB_HEIGHT};
+	DrawRectangleRec(box, (Color){235, 245, 255, 255});
+	if (thumb) {
+		// Letterbox to the box; the image already has the level's aspect
+		float sx = box.width / thumb->width, sy = box.height / thumb->height;
+		float s = sx < sy ? sx : sy;
+		Rectangle dst = {box.x + (box.width - thumb->width * s) * 0.5f, box.y + (box.height - thumb->height * s) * 0.5f, thumb->width * s, thumb->height * s};
+		DrawTexturePro(*thumb, (Rectangle){0, 0, (float)thumb->width, (float)thumb->height}, dst, (Vector2){0, 0}, 0.0f, WHITE);
+	} else {
+		DrawText("...", (int)(box.x + box.width * 0.5f) - 10, (int)(box.y + box.height * 0.5f) - 12, 24, GRAY);
+	}
+	DrawRectangleLinesEx(box, 2.0f, DARKGRAY);
+	DrawText(TextFormat("%d x %d", e->info.cols, e->info.rows), (int)box.x, (int)(box.y + box.height + 8), 20, DARKGRAY);
+}
+
 static void RenderLevelList(const char *title) {
 	UiListRenderCB(&LIST_SPEC, gCatalogIndex, gCatalog.count, CatalogLabelAtCB, &gCatalog, title, "No levels found in ./levels", "UP/DOWN/W/S to select, ENTER/CLICK to confirm, ESC to back");
+	RenderLevelPreview();
 }
 
 
@@ -56,46 +117,133 @@ static void ResetPlayerDefaults(GameState *game) {
 	game->edgeHangDir = 0;
 }
 
-static bool EnsureEditorLevel(GameState *game, bool *editorLoaded) {
+static bool EnsureEditorLevel(World *w, bool *editorLoaded) {
 	if (*editorLoaded) return true;
+	GameState *game = &w->game;
 	EnsureLevelsDir();
+	LevelSave_Flush(); // the file may still be on its way to disk
 	if (gCreateNewRequested) {
-		CreateDefaultLevel(game, &editor);
+		CreateDefaultLevel(game, &w->level);
 		int nextIdx0 = FindNextLevelIndex();
-		MakeLevelPathFromIndex(nextIdx0, gLevelBinPath, sizeof(gLevelBinPath));
-		SaveLevelBinary(game, &editor);
+		MakeLevelPathFromIndex(nextIdx0, w->levelPath, sizeof(w->levelPath));
+		SaveLevelBinary(w->levelPath, game, &w->level);
+		LevelJournal_Begin(w->levelPath, game, &w->level);
+		LevelHistory_Attach(&w->level);
 		gCreateNewRequested = false;
 		*editorLoaded = true;
 		return true;
 	}
-	FILE *bf = fopen(gLevelBinPath, "rb");
-	bool haveExisting = (bf != NULL);
-	if (bf) fclose(bf);
-	bool loaded = false;
-	if (haveExisting) loaded = LoadLevelBinary(game, &editor);
-	if (!loaded) { CreateDefaultLevel(game, &editor); }
+	bool loaded = LoadLevelBinary(w->levelPath, game, &w->level);
+	if (!loaded) { CreateDefaultLevel(game, &w->level); }
+	Level_EditPath(w->levelPath, w->levelPath, sizeof(w->levelPath)); // pack levels save as user overrides
+	LevelJournal_Begin(w->levelPath, game, &w->level); // recovers edits lost to a crash
+	LevelHistory_Attach(&w->level);
 	*editorLoaded = true;
 	return true;
 }
 
-static bool EnsureGameLevel(GameState *game, bool *gameLevelLoaded) {
+// Menu play streams chunked levels from disk
+static bool EnsureGameLevel(World *w, bool *gameLevelLoaded) {
 	if (*gameLevelLoaded) return true;
-	bool loaded = LoadLevelBinary(game, &editor);
-	if (!loaded) { CreateDefaultLevel(game, &editor); }
+	GameState *game = &w->game;
+	LevelSave_Flush(); // the editor may have just queued a save of this level
+	if (!Level_LoadStreamed(w->levelPath, game, &w->level)) { CreateDefaultLevel(game, &w->level); }
+	if (!w->level.stream) w->level.bake = LevelBake_Acquire(&w->level);
 	*gameLevelLoaded = true;
-	game->runTime = 0.0f;
-	game->score = 0;
-	Game_ResetVisuals(game);
-	Game_ClearOutcome();
-	Game_OnLevelLoaded(game, &editor);
+	Game_StartRun(w);
+	World_Snapshot(w, &gLevelStart);
+	Rewind_Reset(&gRewind);
+	Rewind_Push(&gRewind, w);
+	Replay_Begin(&gReplay, w);
+	gRunReloaded = false;
+	LevelWatch_Begin(w->levelPath);
 	return true;
 }
 
+// Between ticks: swap in the level file if it was saved since (by the editor or another tool).
+// History before the swap ran on other tiles, so rewind restarts here and a restart reloads the file.
+static void PollLevelReload(World *w) {
+	LevelEditorState fresh;
+	GameState file;
+	memset(&fresh, 0, sizeof(fresh));
+	if (!LevelWatch_Poll(GetTime(), &fresh, &file)) return;
+	Game_ReplaceLevel(w, &fresh, &file);
+	gLevelStart.valid = false;
+	Rewind_Reset(&gRewind);
+	Rewind_Push(&gRewind, w);
+	gRunReloaded = true;
+}
+
+// Test play runs on the editor's level in memory, with no save or reload. Play never writes
+// tiles, so the level is shared as is; only the simulation state is set aside for the editor.
+static void BeginTestPlay(World *w, bool *gameLevelLoaded) {
+	if (*gameLevelLoaded) return;
+	World_Snapshot(w, &gEditorState);
+	RestorePlayerPosFromTile(&w->level, &w->game);
+	Vector2 exit;
+	if (FindTileWorldPos(&w->level, TILE_EXIT, &exit)) w->game.exitPos = exit;
+	if (!w->level.bake) w->level.bake = LevelBake_Build(&w->level); // in memory: edits would churn the cache
+	*gameLevelLoaded = true;
+	Game_StartRun(w);
+	World_Snapshot(w, &gLevelStart);
+	Rewind_Reset(&gRewind);
+	Rewind_Push(&gRewind, w);
+	Replay_Begin(&gReplay, w);
+}
+
+static void EndTestPlay(World *w, bool *gameLevelLoaded) {
+	World_Restore(w, &gEditorState);
+	Game_ClearOutcome(w);
+	*gameLevelLoaded = false;
+}
+
+// Instant retry: restore the level-start snapshot, falling back to a reload from disk
+static void RestartGameLevel(World *w, bool *gameLevelLoaded) {
+	if (World_Restore(w, &gLevelStart)) {
+		Rewind_Reset(&gRewind);
+		Rewind_Push(&gRewind, w);
+		Replay_Begin(&gReplay, w);
+		gRunReloaded = false;
+		return;
+	}
+	Game_ResetVisuals(&w->game);
+	Game_ClearOutcome(w);
+	*gameLevelLoaded = false;
+}
+
+// One fixed tick of play: step back through history while rewind is held, otherwise simulate and record
+static void StepGameplay(World *w, float dt) {
+	gRewinding = InputDown(ACT_REWIND);
+	if (gRewinding) {
+		if (Rewind_StepBack(&gRewind, w)) Replay_TruncateTo(&gReplay, w->tick);
+		return;
+	}
+	if (w->level.stream) ChunkStream_Update(w->level.stream, w->game.playerPos);
+	Player_PollInput(&w->input);
+	UpdateGame(w, dt);
+	Rewind_Push(&gRewind, w);
+	Replay_RecordTick(&gReplay, w);
+}
+
+// Keep the last finished run on disk so a desync report can be reproduced with --verify-replay
+static void SaveLastReplay(void) {
+	if (gRunReloaded) return;
+#ifndef PLATFORM_WEB
+#ifndef _WIN32
+	mkdir(REPLAY_DIR, 0755);
+#else
+	_mkdir(REPLAY_DIR);
+#endif
+	Replay_Save(&gReplay, REPLAY_LAST_FILE);
+	Replay_WriteTrace(&gReplay, REPLAY_LAST_TRACE);
+#endif
+}
+
 static bool ScreenUsesFixedStep(ScreenState s) {
 	return (s == SCREEN_TEST_PLAY || s == SCREEN_GAME_LEVEL);
 }
 
-static void UpdateScreen(ScreenState *screen, GameState *game, float dt, bool *editorLoaded, bool *gameLevelLoaded, int *menuSelected) {
+static void UpdateScreen(ScreenState *screen, World *w, float dt, bool *editorLoaded, bool *gameLevelLoaded, int *menuSelected) {
 	bool blockInput = InputGate_BeginFrameBlocked();
 	switch (*screen) {
 	case SCREEN_MENU:
@@ -105,7 +253,7 @@ static void UpdateScreen(ScreenState *screen, GameState *game, float dt, bool *e
 
 	case SCREEN_SELECT_EDIT: {
 		if (blockInput) break;
-		ScanLevels(&gCatalog);
+		RefreshCatalog();
 		if (InputPressed(ACT_BACK)) {
 			InputGate_RequestBlockOnce();
 			*screen = SCREEN_MENU;
@@ -117,7 +265,7 @@ static void UpdateScreen(ScreenState *screen, GameState *game, float dt, bool *e
 		if (gCatalogIndex != prevIndex) { Audio_PlayHover(); }
 		if (activate && gCatalog.count > 0) {
 			Audio_PlayMenuClick();
-			snprintf(gLevelBinPath, sizeof(gLevelBinPath), "%s", gCatalog.items[gCatalogIndex].binPath);
+			snprintf(w->levelPath, sizeof(w->levelPath), "%s", gCatalog.items[gCatalogIndex].binPath);
 			*editorLoaded = false;
 			*screen = SCREEN_LEVEL_EDITOR;
 		}
@@ -126,7 +274,7 @@ static void UpdateScreen(ScreenState *screen, GameState *game, float dt, bool *e
 
 	case SCREEN_SELECT_PLAY: {
 		if (blockInput) break;
-		ScanLevels(&gCatalog);
+		RefreshCatalog();
 		if (InputPressed(ACT_BACK)) {
 			InputGate_RequestBlockOnce();
 			*screen = SCREEN_MENU;
@@ -138,7 +286,7 @@ static void UpdateScreen(ScreenState *screen, GameState *game, float dt, bool *e
 		if (gCatalogIndex != prevIndex) { Audio_PlayHover(); }
 		if (activate && gCatalog.count > 0) {
 			Audio_PlayMenuClick();
-			snprintf(gLevelBinPath, sizeof(gLevelBinPath), "%s", gCatalog.items[gCatalogIndex].binPath);
+			snprintf(w->levelPath, sizeof(w->levelPath), "%s", gCatalog.items[gCatalogIndex].binPath);
 			*gameLevelLoaded = false;
 			*screen = SCREEN_GAME_LEVEL;
 		}
@@ -156,55 +304,55 @@ static void UpdateScreen(ScreenState *screen, GameState *game, float dt, bool *e
 		break;
 
 	case SCREEN_LEVEL_EDITOR:
-		if (!EnsureEditorLevel(game, editorLoaded)) break;
-		if (!blockInput) UpdateLevelEditor(screen, game);
+		if (!EnsureEditorLevel(w, editorLoaded)) break;
+		if (!blockInput) UpdateLevelEditor(screen, w);
 		break;
 
 	case SCREEN_TEST_PLAY: {
-		if (!EnsureGameLevel(game, gameLevelLoaded)) break;
+		BeginTestPlay(w, gameLevelLoaded);
 		if (blockInput) break;
 		if (IsKeyPressed(KEY_ESCAPE)) {
 			InputGate_RequestBlockOnce();
-			RestorePlayerPosFromTile(&editor, game);
+			EndTestPlay(w, gameLevelLoaded);
 			*screen = SCREEN_LEVEL_EDITOR;
-			*gameLevelLoaded = false;
-			Game_ClearOutcome();
 			break;
 		}
-		UpdateGame(game, &editor, dt);
-		if (Game_Death()) {
-			RestorePlayerPosFromTile(&editor, game);
+		StepGameplay(w, dt);
+		if (Game_Death(w)) {
+			EndTestPlay(w, gameLevelLoaded);
 			*screen = SCREEN_LEVEL_EDITOR;
-			*gameLevelLoaded = false;
-			Game_ClearOutcome();
 			break;
 		}
 		break;
 	}
 
 	case SCREEN_GAME_LEVEL:
-		if (!EnsureGameLevel(game, gameLevelLoaded)) break;
+		if (!EnsureGameLevel(w, gameLevelLoaded)) break;
 		if (blockInput) break;
 		if (InputPressed(ACT_BACK)) {
 			InputGate_RequestBlockOnce();
+			SaveLastReplay();
 			*screen = SCREEN_MENU;
 			break;
 		}
-		UpdateGame(game, &editor, dt);
-		if (Game_Death()) {
+		PollLevelReload(w);
+		StepGameplay(w, dt);
+		if (Game_Death(w)) {
+			SaveLastReplay();
 			*screen = SCREEN_DEATH;
 			break;
 		}
-		if (Game_Victory()) { *screen = SCREEN_VICTORY; }
+		if (Game_Victory(w)) {
+			SaveLastReplay();
+			*screen = SCREEN_VICTORY;
+		}
 		break;
 
 	case SCREEN_DEATH:
 		if (!blockInput) {
 			if (InputPressed(ACT_ACTIVATE)) {
 				InputGate_RequestBlockOnce();
-				Game_ResetVisuals(game);
-				Game_ClearOutcome();
-				*gameLevelLoaded = false;
+				RestartGameLevel(w, gameLevelLoaded);
 				*screen = SCREEN_GAME_LEVEL;
 				break;
 			} else if (InputPressed(ACT_BACK)) {
@@ -219,8 +367,7 @@ static void UpdateScreen(ScreenState *screen, GameState *game, float dt, bool *e
 		if (!blockInput) {
 			if (InputPressed(ACT_ACTIVATE)) {
 				InputGate_RequestBlockOnce();
-				Game_ClearOutcome();
-				*gameLevelLoaded = false;
+				RestartGameLevel(w, gameLevelLoaded);
 				*screen = SCREEN_GAME_LEVEL;
 				break;
 			} else if (InputPressed(ACT_BACK)) {
@@ -233,7 +380,7 @@ static void UpdateScreen(ScreenState *screen, GameState *game, float dt, bool *e
 	}
 }
 
-static void RenderScreen(ScreenState screen, GameState *game, float frameDt, int menuSelected) {
+static void RenderScreen(ScreenState screen, World *w, float frameDt, int menuSelected) {
 	switch (screen) {
 	case SCREEN_MENU:
 		RenderMenu(menuSelected);
@@ -248,25 +395,81 @@ static void RenderScreen(ScreenState screen, GameState *game, float frameDt, int
 		RenderSettings();
 		break;
 	case SCREEN_LEVEL_EDITOR:
-		RenderLevelEditor(game);
+		RenderLevelEditor(w);
 		break;
 	case SCREEN_TEST_PLAY:
-		RenderGame(game, &editor, frameDt);
-		break;
 	case SCREEN_GAME_LEVEL:
-		RenderGame(game, &editor, frameDt);
+		RenderGame(w, frameDt);
+		if (gRewinding) DrawText("<< REWIND", 16, WINDOW_HEIGHT - 40, 24, WHITE);
 		break;
 	case SCREEN_DEATH:
-		Render_DrawDust(frameDt);
+		BeginMode2D(w->camera);
+		Render_DrawDust(w, frameDt);
+		EndMode2D();
 		RenderDeath();
 		break;
 	case SCREEN_VICTORY:
-		RenderVictory(game);
+		RenderVictory(&w->game);
 		break;
 	}
 }
 
-int main(void) {
+// Headless determinism check: re-simulate a recorded replay and report the first diverging hash
+static int RunReplayVerify(const char *path) {
+	if (!Replay_Load(&gReplay, path)) {
+		fprintf(stderr, "%s: not a readable replay\n", path);
+		return 2;
+	}
+	ReplayVerifyResult res;
+	Replay_Verify(&gReplay, &gWorld, &res);
+	if (res.levelMissing) {
+		fprintf(stderr, "%s: cannot load level %s\n", path, gReplay.levelPath);
+		return 2;
+	}
+	if (!res.ok) {
+		printf("desync at tick %u in %s (expected %016" PRIx64 ", got %016" PRIx64 "); last match at tick %u\n", (unsigned)res.mismatchTick,
+		       WorldHash_SubsystemName(res.mismatchSubsystem), res.expected, res.actual, (unsigned)res.lastMatchTick);
+		return 1;
+	}
+	printf("replay OK: %u ticks, %u hashes matched\n", (unsigned)res.ticksSimulated, (unsigned)res.hashesMatched);
+	return 0;
+}
+
+// Level pack builder: main --pack out.glpack levels/*.lvl
+static int RunPack(const char *outPath, char *const *inputs, int count) {
+	char err[320];
+	if (!LevelPack_Write(outPath, inputs, count, err, sizeof(err))) {
+		fprintf(stderr, "pack: %s\n", err);
+		return 1;
+	}
+	printf("packed %d levels into %s\n", count, outPath);
+	return 0;
+}
+
+// Level compile step: main --bake [threads] fills the bake cache for every level
+static int RunBake(int threads) {
+	ScanLevels(&gCatalog); // also opens the level pack before the workers start
+	int baked = LevelBake_All(&gCatalog, threads);
+	printf("baked %d of %d levels into %s/\n", baked, gCatalog.count, LEVEL_BAKE_DIR);
+	return baked == gCatalog.count ? 0 : 1;
+}
+
+// Enemy scaling benchmark: main --stress [enemies] [level] prints JSON for 1k, 10k and 100k
+// enemies (or just the count given) in a generated arena, or in the level file given
+static int RunStress(int argc, char **argv) {
+	static const int kDefaultCounts[] = {1000, 10000, 100000};
+	int count = argc >= 3 ? atoi(argv[2]) : 0;
+	const char *level = argc >= 4 ? argv[3] : NULL;
+	if (count > 0) return Stress_Run(level, &count, 1, stdout);
+	return Stress_Run(level, kDefaultCounts, (int)(sizeof(kDefaultCounts) / sizeof(kDefaultCounts[0])), stdout);
+}
+
+int main(int argc, char **argv) {
+	if (argc >= 3 && strcmp(argv[1], "--verify-replay") == 0) return RunReplayVerify(argv[2]);
+	if (argc >= 2 && strcmp(argv[1], "--stress") == 0) return RunStress(argc, argv);
+	if (argc >= 3 && strcmp(argv[1], "--pack") == 0) return RunPack(argv[2], argv + 3, argc - 3);
+	if (argc >= 2 && strcmp(argv[1], "--bake") == 0) return RunBake(argc >= 3 ? atoi(argv[2]) : 0);
+
 	// Request proper scaling on high-DPI displays and enable vsync
 	SetConfigFlags(FLAG_WINDOW_HIGHDPI | FLAG_VSYNC_HINT);
 	InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Glide Runner");
@@ -282,13 +485,16 @@ int main(void) {
 	SetTargetFPS((int)BASE_FPS);
 	FpsMeter_Init();
 
-	GameState game = {0};
-	ResetPlayerDefaults(&game);
+	World *world = &gWorld;
+	World_Init(world);
+	if (argc >= 3 && strcmp(argv[1], "--enemies") == 0 && (atoi(argv[2]) < 1 || !Enemy_SetCapacity(world, atoi(argv[2]))))
+		fprintf(stderr, "--enemies %s: not a usable enemy capacity (1..%d); using %d\n", argv[2], ENEMY_MAX_CAPACITY, ENEMY_DEFAULT_CAPACITY);
+	ResetPlayerDefaults(&world->game);
 
 	ScreenState screen = SCREEN_MENU;
 	ScreenState lastScreen = SCREEN_MENU;
 	int menuSelected = 0;
-	editor.cursor = (Vector2){SQUARE_SIZE, WINDOW_HEIGHT - SQUARE_SIZE * 2};
+	world->level.cursor = (Vector2){SQUARE_SIZE, WINDOW_HEIGHT - SQUARE_SIZE * 2};
 
 	bool editorLoaded = false;
 	bool gameLevelLoaded = false;
@@ -304,37 +510,49 @@ int main(void) {
 			accumulator += frameDt;
 			if (accumulator > 0.25f) accumulator = 0.25f;
 			while (accumulator >= BASE_DT) {
-				UpdateScreen(&screen, &game, BASE_DT, &editorLoaded, &gameLevelLoaded, &menuSelected);
+				UpdateScreen(&screen, world, BASE_DT, &editorLoaded, &gameLevelLoaded, &menuSelected);
 				accumulator -= BASE_DT;
 			}
 		} else {
 			accumulator = 0.0f;
-			UpdateScreen(&screen, &game, frameDt, &editorLoaded, &gameLevelLoaded, &menuSelected);
+			UpdateScreen(&screen, world, frameDt, &editorLoaded, &gameLevelLoaded, &menuSelected);
 		}
 
 		BeginDrawing();
 		ClearBackground(BG_CLOUD);
-		RenderScreen(screen, &game, frameDt, menuSelected);
+		RenderScreen(screen, world, frameDt, menuSelected);
 		FpsMeter_Draw();
 		EndDrawing();
 
 		if (screen == SCREEN_MENU && lastScreen != SCREEN_MENU) {
 			editorLoaded = false;
 			gameLevelLoaded = false;
-			Game_ClearOutcome();
+			LevelWatch_End();
+			Game_ClearOutcome(world);
 			menuSelected = 0;
-			Game_ResetVisuals(&game);
-			ResetPlayerDefaults(&game);
+			Game_ResetVisuals(&world->game);
+			ResetPlayerDefaults(&world->game);
 		}
 
+		LevelSave_Poll(GetTime());
+		LevelThumb_Update();
+
 		bool inMenuScreens = (screen == SCREEN_MENU || screen == SCREEN_SELECT_EDIT || screen == SCREEN_SELECT_PLAY || screen == SCREEN_LEVEL_EDITOR || screen == SCREEN_SETTINGS);
 		Audio_MenuMusicUpdate(inMenuScreens, frameDt);
 		lastScreen = screen;
 	}
 
+	LevelSave_Flush();
+	LevelSave_Poll(GetTime());
 	Audio_Deinit();
 	CloseAudioDevice();
 	Render_Deinit();
+	LevelThumb_Release();
 	CloseWindow();
+	World_Free(world);
+	WorldSnapshot_Free(&gLevelStart);
+	WorldSnapshot_Free(&gEditorState);
+	Rewind_Free(&gRewind);
+	Level_CatalogClose(&gCatalog);
 	return 0;
 }
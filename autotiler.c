@@ -1,13 +1,18 @@
 #include "autotiler.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "raylib.h"
 
 static AutotilerConfig gConfig = {0};
+static Rectangle gTileForMask[256]; // tileset source per neighbor mask, filled by Autotiler_Init
+
+static Rectangle ChooseForMask(uint8_t mask);
 
 bool Autotiler_Init(const AutotilerConfig *config) {
 	if (config != NULL && config->checkBlock != NULL && config->tileSize > 0) {
 		gConfig = *config;
+		for (int m = 0; m < 256; m++) gTileForMask[m] = ChooseForMask((uint8_t)m);
 		return true;
 	}
 	return false;
@@ -95,15 +100,15 @@ static Rectangle ChooseOpenRight(bool upLeft, bool downLeft) {
 	return BlockTileSrc(gConfig.layout.openRight_rightEdge);
 }
 
-Rectangle Autotiler_GetBlockTile(const void *context, int cx, int cy) {
-	bool up = IsBlockAt(context, cx, cy - 1);
-	bool down = IsBlockAt(context, cx, cy + 1);
-	bool left = IsBlockAt(context, cx - 1, cy);
-	bool right = IsBlockAt(context, cx + 1, cy);
-	bool upLeft = IsBlockAt(context, cx - 1, cy - 1);
-	bool upRight = IsBlockAt(context, cx + 1, cy - 1);
-	bool downLeft = IsBlockAt(context, cx - 1, cy + 1);
-	bool downRight = IsBlockAt(context, cx + 1, cy + 1);
+static Rectangle ChooseForMask(uint8_t mask) {
+	bool up = (mask & AUTOTILE_UP) != 0;
+	bool down = (mask & AUTOTILE_DOWN) != 0;
+	bool left = (mask & AUTOTILE_LEFT) != 0;
+	bool right = (mask & AUTOTILE_RIGHT) != 0;
+	bool upLeft = (mask & AUTOTILE_UP_LEFT) != 0;
+	bool upRight = (mask & AUTOTILE_UP_RIGHT) != 0;
+	bool downLeft = (mask & AUTOTILE_DOWN_LEFT) != 0;
+	bool downRight = (mask & AUTOTILE_DOWN_RIGHT) != 0;
 
 	if (!up && !down) {
 		return ChooseRowNoVertical(left, right);
@@ -127,3 +132,24 @@ Rectangle Autotiler_GetBlockTile(const void *context, int cx, int cy) {
 
 	return BlockTileSrc(gConfig.layout.isolated_full);
 }
+
+uint8_t Autotiler_NeighborMask(const void *context, int cx, int cy) {
+	uint8_t mask = 0;
+	if (IsBlockAt(context, cx, cy - 1)) mask |= AUTOTILE_UP;
+	if (IsBlockAt(context, cx, cy + 1)) mask |= AUTOTILE_DOWN;
+	if (IsBlockAt(context, cx - 1, cy)) mask |= AUTOTILE_LEFT;
+	if (IsBlockAt(context, cx + 1, cy)) mask |= AUTOTILE_RIGHT;
+	if (IsBlockAt(context, cx - 1, cy - 1)) mask |= AUTOTILE_UP_LEFT;
+	if (IsBlockAt(context, cx + 1, cy - 1)) mask |= AUTOTILE_UP_RIGHT;
+	if (IsBlockAt(context, cx - 1, cy + 1)) mask |= AUTOTILE_DOWN_LEFT;
+	if (IsBlockAt(context, cx + 1, cy + 1)) mask |= AUTOTILE_DOWN_RIGHT;
+	return mask;
+}
+
+Rectangle Autotiler_TileForMask(uint8_t mask) {
+	return gTileForMask[mask];
+}
+
+Rectangle Autotiler_GetBlockTile(const void *context, int cx, int cy) {
+	return gTileForMask[Autotiler_NeighborMask(context, cx, cy)];
+}
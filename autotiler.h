@@ -1,6 +1,7 @@
 // Autotiler - Automatically selects appropriate tile sprites based on neighboring tiles
 #pragma once
 #include <stdbool.h>
+#include <stdint.h>
 #include "raylib.h"
 
 // Callback function type to check if a block exists at given cell coordinates
@@ -88,6 +89,22 @@ typedef struct {
 // Returns true if initialization was successful, false otherwise
 bool Autotiler_Init(const AutotilerConfig *config);
 
+// Neighbor mask bits: which of the 8 surrounding cells hold a block. The tile choice depends on
+// nothing else, so a mask can be computed once (see levelbake.h) and mapped to a tile per frame.
+enum {
+	AUTOTILE_UP = 1 << 0,
+	AUTOTILE_DOWN = 1 << 1,
+	AUTOTILE_LEFT = 1 << 2,
+	AUTOTILE_RIGHT = 1 << 3,
+	AUTOTILE_UP_LEFT = 1 << 4,
+	AUTOTILE_UP_RIGHT = 1 << 5,
+	AUTOTILE_DOWN_LEFT = 1 << 6,
+	AUTOTILE_DOWN_RIGHT = 1 << 7,
+};
+
+uint8_t Autotiler_NeighborMask(const void *context, int cx, int cy);
+Rectangle Autotiler_TileForMask(uint8_t mask); // table lookup, built by Autotiler_Init
+
 // Get the source rectangle for a block at the given cell coordinates
 // Based on the neighboring blocks, returns the appropriate tile from the tileset
 // context: Context to pass to the checkBlock function
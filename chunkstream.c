@@ -0,0 +1,370 @@
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#define _POSIX_C_SOURCE 200809L
+#define CHUNK_STREAM_THREADED 1
+#endif
+#include "chunkstream.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef CHUNK_STREAM_THREADED
+#include <pthread.h>
+#endif
+
+// Without a loader thread (web, Windows) Update decodes at most this many queued chunks per call
+#define CHUNK_INLINE_DECODES_PER_UPDATE 2
+#define CHUNK_CELLS (LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE)
+#define CHUNK_MASK (LEVEL_CHUNK_SIZE - 1)
+
+typedef struct ChunkSlot {
+	int chunk; // chunk held or being decoded, -1 when free
+	bool loading; // owned by the loader until installed: the main thread must not read tiles/solid
+	bool corrupt; // set by the decoder when the chunk failed its CRC
+	uint32_t lastUsed; // Update stamp of the last time the chunk was inside the prefetch window
+	uint8_t tiles[CHUNK_CELLS];
+	uint32_t solid[LEVEL_CHUNK_SIZE]; // row bitsets: bit x is set when the cell is solid
+} ChunkSlot;
+
+struct ChunkStream {
+	FileMap file;
+	LevelChunkTable table;
+	int chunkCount;
+	int16_t *slotOf; // per chunk: installed slot or -1 (main thread only)
+	int16_t *pendingSlot; // per chunk: slot it is being decoded into or -1 (main thread only)
+	ChunkSlot *slots;
+	int slotCount;
+	uint32_t stamp;
+	int focusX, focusY; // chunk under the focus at the last Update
+	ChunkStreamStats stats;
+	// Loader queue of slot indices (capacity slotCount: a slot is queued at most once)
+	int *jobs;
+	int jobHead, jobCount;
+	int *done; // decoded slots waiting to be installed by the main thread
+	int doneCount;
+	int busySlot; // slot the loader is decoding, -1 when idle
+#ifdef CHUNK_STREAM_THREADED
+	pthread_t thread;
+	pthread_mutex_t lock; // guards jobs/done/busySlot/quit
+	pthread_cond_t wake; // jobs queued or quit requested
+	pthread_cond_t finished; // a decode completed
+	bool quit;
+#endif
+};
+
+static inline void Lock(ChunkStream *cs) {
+#ifdef CHUNK_STREAM_THREADED
+	pthread_mutex_lock(&cs->lock);
+#else
+	(void)cs;
+#endif
+}
+
+static inline void Unlock(ChunkStream *cs) {
+#ifdef CHUNK_STREAM_THREADED
+	pthread_mutex_unlock(&cs->lock);
+#else
+	(void)cs;
+#endif
+}
+
+// Touches only the file image and the slot, so it runs on either thread
+static void DecodeIntoSlot(const LevelChunkTable *table, ChunkSlot *s) {
+	s->corrupt = !Level_DecodeChunk(table, s->chunk, s->tiles);
+	if (s->corrupt) memset(s->tiles, TILE_BLOCK, sizeof(s->tiles)); // an unreadable chunk becomes wall
+	for (int y = 0; y < LEVEL_CHUNK_SIZE; ++y) {
+		uint32_t bits = 0;
+		const uint8_t *row = s->tiles + y * LEVEL_CHUNK_SIZE;
+		for (int x = 0; x < LEVEL_CHUNK_SIZE; ++x)
+			if (IsSolidTile((TileType)row[x])) bits |= 1u << x;
+		s->solid[y] = bits;
+	}
+}
+
+static void Install(ChunkStream *cs, int i) {
+	ChunkSlot *s = &cs->slots[i];
+	s->loading = false;
+	cs->slotOf[s->chunk] = (int16_t)i;
+	cs->pendingSlot[s->chunk] = -1;
+	cs->stats.pending--;
+	cs->stats.resident++;
+	if (s->corrupt) cs->stats.corrupt++;
+}
+
+static void CollectFinished(ChunkStream *cs) {
+	int finished[64];
+	for (;;) {
+		Lock(cs);
+		int n = cs->doneCount < 64 ? cs->doneCount : 64;
+		cs->doneCount -= n;
+		memcpy(finished, cs->done + cs->doneCount, (size_t)n * sizeof(int));
+		Unlock(cs);
+		if (n == 0) return;
+		for (int k = 0; k < n; ++k) {
+			Install(cs, finished[k]);
+			cs->stats.loaded++;
+		}
+	}
+}
+
+static inline bool InPrefetchWindow(const ChunkStream *cs, int chunk) {
+	int dx = chunk % cs->table.chunksX - cs->focusX;
+	int dy = chunk / cs->table.chunksX - cs->focusY;
+	return abs(dx) <= CHUNK_PREFETCH_RADIUS && abs(dy) <= CHUNK_PREFETCH_RADIUS;
+}
+
+// A free slot, else the least recently used installed chunk (outside the prefetch window unless
+// `evictNear`). Slots the loader owns are never taken. -1 when nothing qualifies.
+static int AcquireSlot(ChunkStream *cs, bool evictNear) {
+	int best = -1;
+	for (int i = 0; i < cs->slotCount; ++i) {
+		const ChunkSlot *s = &cs->slots[i];
+		if (s->loading) continue;
+		if (s->chunk < 0) return i;
+		if (!evictNear && InPrefetchWindow(cs, s->chunk)) continue;
+		if (best < 0 || s->lastUsed < cs->slots[best].lastUsed) best = i;
+	}
+	if (best >= 0) {
+		ChunkSlot *s = &cs->slots[best];
+		cs->slotOf[s->chunk] = -1;
+		s->chunk = -1;
+		cs->stats.resident--;
+		cs->stats.evicted++;
+	}
+	return best;
+}
+
+static void Claim(ChunkStream *cs, int i, int chunk) {
+	ChunkSlot *s = &cs->slots[i];
+	s->chunk = chunk;
+	s->loading = true;
+	s->lastUsed = cs->stamp;
+	cs->pendingSlot[chunk] = (int16_t)i;
+	cs->stats.pending++;
+}
+
+static bool Request(ChunkStream *cs, int chunk) {
+	int i = AcquireSlot(cs, false);
+	if (i < 0) return false;
+	Claim(cs, i, chunk);
+	Lock(cs);
+	cs->jobs[(cs->jobHead + cs->jobCount) % cs->slotCount] = i;
+	cs->jobCount++;
+#ifdef CHUNK_STREAM_THREADED
+	pthread_cond_signal(&cs->wake);
+#endif
+	Unlock(cs);
+	return true;
+}
+
+// Pull a queued job back out of the loader's queue; false once the loader has started it
+static bool TakeBackJob(ChunkStream *cs, int slot) {
+	bool found = false;
+	Lock(cs);
+	for (int k = 0; k < cs->jobCount; ++k) {
+		if (cs->jobs[(cs->jobHead + k) % cs->slotCount] != slot) continue;
+		for (int j = k; j + 1 < cs->jobCount; ++j)
+			cs->jobs[(cs->jobHead + j) % cs->slotCount] = cs->jobs[(cs->jobHead + j + 1) % cs->slotCount];
+		cs->jobCount--;
+		found = true;
+		break;
+	}
+	Unlock(cs);
+	return found;
+}
+
+static void DecodeNow(ChunkStream *cs, int i) {
+	DecodeIntoSlot(&cs->table, &cs->slots[i]);
+	Install(cs, i);
+}
+
+// Block until the loader has something to hand over (or, without a thread, decode one job here)
+static void WaitForLoader(ChunkStream *cs) {
+#ifdef CHUNK_STREAM_THREADED
+	pthread_mutex_lock(&cs->lock);
+	while (cs->doneCount == 0 && (cs->jobCount > 0 || cs->busySlot >= 0)) pthread_cond_wait(&cs->finished, &cs->lock);
+	pthread_mutex_unlock(&cs->lock);
+	CollectFinished(cs);
+#else
+	if (cs->jobCount == 0) return;
+	int i = cs->jobs[cs->jobHead];
+	cs->jobHead = (cs->jobHead + 1) % cs->slotCount;
+	cs->jobCount--;
+	DecodeNow(cs, i);
+	cs->stats.loaded++;
+#endif
+}
+
+// A tick touched a chunk the loader has not delivered. Decoding it here keeps the simulation
+// independent of loader timing; the prefetch window is sized so this stays rare.
+static int LoadNow(ChunkStream *cs, int chunk) {
+	cs->stats.syncLoads++;
+	int pending = cs->pendingSlot[chunk];
+	if (pending >= 0) {
+		if (TakeBackJob(cs, pending)) {
+			DecodeNow(cs, pending);
+		} else {
+			while (cs->slotOf[chunk] < 0) WaitForLoader(cs); // mid-decode: one chunk's worth of wait
+		}
+		return cs->slotOf[chunk];
+	}
+	int i = AcquireSlot(cs, false);
+	if (i < 0) i = AcquireSlot(cs, true);
+	while (i < 0) {
+		WaitForLoader(cs);
+		i = AcquireSlot(cs, true);
+	}
+	Claim(cs, i, chunk);
+	DecodeNow(cs, i);
+	return i;
+}
+
+static inline const ChunkSlot *SlotForCell(ChunkStream *cs, int cx, int cy) {
+	int chunk = (cy >> LEVEL_CHUNK_SHIFT) * cs->table.chunksX + (cx >> LEVEL_CHUNK_SHIFT);
+	int i = cs->slotOf[chunk];
+	if (i < 0) i = LoadNow(cs, chunk);
+	return &cs->slots[i];
+}
+
+TileType ChunkStream_Tile(ChunkStream *cs, int cx, int cy) {
+	const ChunkSlot *s = SlotForCell(cs, cx, cy);
+	return (TileType)s->tiles[(cy & CHUNK_MASK) * LEVEL_CHUNK_SIZE + (cx & CHUNK_MASK)];
+}
+
+bool ChunkStream_SolidAt(ChunkStream *cs, int cx, int cy) {
+	const ChunkSlot *s = SlotForCell(cs, cx, cy);
+	return (s->solid[cy & CHUNK_MASK] >> (cx & CHUNK_MASK)) & 1u;
+}
+
+#ifdef CHUNK_STREAM_THREADED
+static void *LoaderMain(void *arg) {
+	ChunkStream *cs = arg;
+	pthread_mutex_lock(&cs->lock);
+	for (;;) {
+		while (!cs->quit && cs->jobCount == 0) pthread_cond_wait(&cs->wake, &cs->lock);
+		if (cs->quit) break;
+		int i = cs->jobs[cs->jobHead];
+		cs->jobHead = (cs->jobHead + 1) % cs->slotCount;
+		cs->jobCount--;
+		cs->busySlot = i;
+		pthread_mutex_unlock(&cs->lock);
+		DecodeIntoSlot(&cs->table, &cs->slots[i]);
+		pthread_mutex_lock(&cs->lock);
+		cs->busySlot = -1;
+		cs->done[cs->doneCount++] = i;
+		pthread_cond_broadcast(&cs->finished);
+	}
+	pthread_mutex_unlock(&cs->lock);
+	return NULL;
+}
+#endif
+
+static void FreeStream(ChunkStream *cs) {
+	free(cs->slotOf);
+	free(cs->pendingSlot);
+	free(cs->slots);
+	free(cs->jobs);
+	free(cs->done);
+	free(cs);
+}
+
+ChunkStream *ChunkStream_Create(FileMap *file, const LevelChunkTable *table) {
+	ChunkStream *cs = calloc(1, sizeof(*cs));
+	if (!cs) return NULL;
+	cs->table = *table;
+	cs->chunkCount = table->chunksX * table->chunksY;
+	const int window = (2 * CHUNK_PREFETCH_RADIUS + 1) * (2 * CHUNK_PREFETCH_RADIUS + 1);
+	cs->slotCount = (int)(CHUNK_CACHE_BYTES / sizeof(ChunkSlot));
+	if (cs->slotCount < 2 * window) cs->slotCount = 2 * window; // the budget never starves the prefetch window
+	if (cs->slotCount > cs->chunkCount) cs->slotCount = cs->chunkCount;
+	if (cs->slotCount > INT16_MAX) cs->slotCount = INT16_MAX;
+	cs->slotOf = malloc((size_t)cs->chunkCount * sizeof(int16_t));
+	cs->pendingSlot = malloc((size_t)cs->chunkCount * sizeof(int16_t));
+	cs->slots = malloc((size_t)cs->slotCount * sizeof(ChunkSlot));
+	cs->jobs = malloc((size_t)cs->slotCount * sizeof(int));
+	cs->done = malloc((size_t)cs->slotCount * sizeof(int));
+	if (!cs->slotOf || !cs->pendingSlot || !cs->slots || !cs->jobs || !cs->done) {
+		FreeStream(cs);
+		return NULL;
+	}
+	for (int i = 0; i < cs->chunkCount; ++i) cs->slotOf[i] = cs->pendingSlot[i] = -1;
+	for (int i = 0; i < cs->slotCount; ++i) {
+		cs->slots[i].chunk = -1;
+		cs->slots[i].loading = false;
+	}
+	cs->busySlot = -1;
+#ifdef CHUNK_STREAM_THREADED
+	pthread_mutex_init(&cs->lock, NULL);
+	pthread_cond_init(&cs->wake, NULL);
+	pthread_cond_init(&cs->finished, NULL);
+	if (pthread_create(&cs->thread, NULL, LoaderMain, cs) != 0) {
+		pthread_cond_destroy(&cs->finished);
+		pthread_cond_destroy(&cs->wake);
+		pthread_mutex_destroy(&cs->lock);
+		FreeStream(cs);
+		return NULL;
+	}
+#endif
+	cs->file = *file;
+	memset(file, 0, sizeof(*file));
+	return cs;
+}
+
+void ChunkStream_Destroy(ChunkStream *cs) {
+	if (!cs) return;
+#ifdef CHUNK_STREAM_THREADED
+	pthread_mutex_lock(&cs->lock);
+	cs->quit = true;
+	pthread_cond_broadcast(&cs->wake);
+	pthread_mutex_unlock(&cs->lock);
+	pthread_join(cs->thread, NULL);
+	pthread_cond_destroy(&cs->finished);
+	pthread_cond_destroy(&cs->wake);
+	pthread_mutex_destroy(&cs->lock);
+#endif
+	FileMap_Close(&cs->file);
+	FreeStream(cs);
+}
+
+void ChunkStream_Update(ChunkStream *cs, Vector2 focus) {
+	cs->stamp++;
+	CollectFinished(cs);
+	int cx = WorldToCellX(focus.x), cy = WorldToCellY(focus.y);
+	if (cx < 0) cx = 0;
+	if (cy < 0) cy = 0;
+	cs->focusX = cx >> LEVEL_CHUNK_SHIFT;
+	cs->focusY = cy >> LEVEL_CHUNK_SHIFT;
+	if (cs->focusX >= cs->table.chunksX) cs->focusX = cs->table.chunksX - 1;
+	if (cs->focusY >= cs->table.chunksY) cs->focusY = cs->table.chunksY - 1;
+	// Rings outward from the focus so the nearest chunks are queued first
+	for (int r = 0; r <= CHUNK_PREFETCH_RADIUS; ++r)
+		for (int dy = -r; dy <= r; ++dy)
+			for (int dx = -r; dx <= r; ++dx) {
+				if (abs(dx) != r && abs(dy) != r) continue;
+				int x = cs->focusX + dx, y = cs->focusY + dy;
+				if (x < 0 || y < 0 || x >= cs->table.chunksX || y >= cs->table.chunksY) continue;
+				int chunk = y * cs->table.chunksX + x;
+				if (cs->slotOf[chunk] >= 0) {
+					cs->slots[cs->slotOf[chunk]].lastUsed = cs->stamp;
+				} else if (cs->pendingSlot[chunk] < 0) {
+					Request(cs, chunk);
+				}
+			}
+#ifndef CHUNK_STREAM_THREADED
+	for (int k = 0; k < CHUNK_INLINE_DECODES_PER_UPDATE && cs->jobCount > 0; ++k) WaitForLoader(cs);
+#endif
+}
+
+void ChunkStream_Prime(ChunkStream *cs, Vector2 focus) {
+	ChunkStream_Update(cs, focus);
+	while (cs->stats.pending > 0) WaitForLoader(cs);
+}
+
+int ChunkStream_SpawnerCount(const ChunkStream *cs) {
+	return cs->table.spawnerCount;
+}
+
+void ChunkStream_SpawnerCell(const ChunkStream *cs, int i, int *cx, int *cy) {
+	Level_ChunkSpawnerCell(&cs->table, i, cx, cy);
+}
+
+void ChunkStream_GetStats(const ChunkStream *cs, ChunkStreamStats *out) {
+	*out = cs->stats;
+}
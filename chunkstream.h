@@ -0,0 +1,37 @@
+// Streamed levels: a bounded LRU cache of decoded chunks, filled by a background loader thread
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "filemap.h"
+#include "level.h"
+#include "raylib.h"
+
+typedef struct ChunkStream ChunkStream;
+
+typedef struct ChunkStreamStats {
+	int resident; // chunks decoded and cached
+	int pending; // chunks queued for or being decoded by the loader
+	uint32_t loaded; // chunks decoded in the background
+	uint32_t syncLoads; // chunks a tick needed before the loader delivered them
+	uint32_t evicted;
+	uint32_t corrupt; // chunks that failed their CRC (treated as solid)
+} ChunkStreamStats;
+
+// Takes ownership of `file` (zeroed on success); `table` must point into it. NULL on failure.
+ChunkStream *ChunkStream_Create(FileMap *file, const LevelChunkTable *table);
+void ChunkStream_Destroy(ChunkStream *cs);
+
+// Main thread, once per tick: install chunks the loader finished and queue those near `focus`
+// (world px) nearest first. Never waits on the loader.
+void ChunkStream_Update(ChunkStream *cs, Vector2 focus);
+// Update, then wait for everything queued (level load only)
+void ChunkStream_Prime(ChunkStream *cs, Vector2 focus);
+
+// Cell queries (in bounds). A chunk that is not resident yet is decoded on the spot, so the
+// simulation always sees the same tiles no matter how far the loader has got.
+TileType ChunkStream_Tile(ChunkStream *cs, int cx, int cy);
+bool ChunkStream_SolidAt(ChunkStream *cs, int cx, int cy);
+
+int ChunkStream_SpawnerCount(const ChunkStream *cs);
+void ChunkStream_SpawnerCell(const ChunkStream *cs, int i, int *cx, int *cy);
+void ChunkStream_GetStats(const ChunkStream *cs, ChunkStreamStats *out);
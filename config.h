@@ -14,14 +14,63 @@
 // Derived window size in pixels
 #define WINDOW_WIDTH (GRID_COLS * SQUARE_SIZE)
 #define WINDOW_HEIGHT (GRID_ROWS * SQUARE_SIZE)
+// Levels are sized at runtime; GRID_COLS x GRID_ROWS is the view and the size of new levels
+#define LEVEL_MIN_COLS 8
+#define LEVEL_MIN_ROWS 6
+#define LEVEL_MAX_COLS 1024
+#define LEVEL_MAX_ROWS 1024
 
 // Feature toggles
 #define ENABLE_FPS_METER 1
 
+// Level files: write the TILE section as palette RLE when it is smaller than raw
+#define LEVEL_COMPRESS_TILES 1
+
+// Streamed levels: levels of LEVEL_CHUNKED_MIN_CELLS or more are saved as square chunks and,
+// in play, decoded on a loader thread as the player approaches
+#define LEVEL_CHUNK_SHIFT 5
+#define LEVEL_CHUNK_SIZE (1 << LEVEL_CHUNK_SHIFT) // tiles per chunk side (at most 32: rows are u32 bitsets)
+#define LEVEL_CHUNKED_MIN_CELLS (128 * 128)
+#define CHUNK_CACHE_BYTES (512 * 1024) // decoded chunk budget; least recently used chunks are evicted
+#define CHUNK_PREFETCH_RADIUS 2 // chunks around the player kept resident and requested ahead
+
+// Level menus: how often to stat the level directories where change notification is unavailable
+#define LEVEL_CATALOG_POLL_SECONDS 1.0
+
+// Hot reload: how often the level being played is stat'ed where change notification is unavailable
+#define LEVEL_WATCH_POLL_SECONDS 0.5
+
+// Editor journal: on the web, how often pending edit records are flushed to IndexedDB
+#define LEVEL_JOURNAL_SYNC_SECONDS 1.0
+
+// Editor undo: bytes of cell deltas (6 each) and strokes kept; the oldest strokes are dropped
+#define EDITOR_UNDO_BYTES (1024 * 1024)
+#define EDITOR_UNDO_STROKES 4096
+
+// Level select thumbnails: at most this many pixels, rendered off the main thread
+#define LEVEL_THUMB_WIDTH 320
+#define LEVEL_THUMB_HEIGHT 240
+#define LEVEL_THUMB_SLOTS 64 // thumbnails kept in memory; must exceed the rows one screen shows
+
+// Editor reachability check: movement states explored per analysis before it reports a partial result
+#define LEVEL_REACH_MAX_STATES (1 << 18)
+
 // Timing
 #define BASE_FPS 120.0f
 #define BASE_DT (1.0f / BASE_FPS)
 
+// Root seed for the deterministic RNG streams (re-applied on every level load)
+#define RNG_DEFAULT_SEED 0x61696C6752756E31ull
+
+// Rewind history (delta-compressed per-tick world states)
+#define REWIND_BUFFER_BYTES (384 * 1024) // compressed byte budget; oldest ticks are evicted first
+#define REWIND_MAX_TICKS 1800 // hard cap on recorded ticks (15 s at BASE_FPS)
+#define REWIND_KEYFRAME_TICKS 120 // full (non-delta) state every N ticks
+
+// Replays and determinism checks
+#define REPLAY_MAX_TICKS 72000 // 10 minutes of input at BASE_FPS
+#define STATE_HASH_INTERVAL 4 // record a per-subsystem state hash every N ticks
+
 // (Other constants below)
 
 // Physics tuning
@@ -62,6 +111,19 @@
 #define ROGUE_ENEMY_MAX_FALL 900.0f
 #define ROGUE_ENEMY_W ((float)SQUARE_SIZE * 0.75f)
 #define ROGUE_ENEMY_H ((float)SQUARE_SIZE * 0.75f)
+#define ROGUE_ENEMY_JUMP_SPEED 640.0f // enemies jump about 3.5 tiles; navigation links are sized from it
+#define ENEMY_NAV_CACHED_TABLES 8 // next-link tables kept per level, one per recent player segment
+#define LEVEL_MAX_WAVES 32 // scripted spawn waves per level (WAVE section records)
+// Enemy level of detail, by distance from the player in tiles (either axis): full rate inside NEAR
+// (the visible area and a margin), every 2nd tick inside MID, every 4th beyond, where enemies that
+// stopped on the ground fall asleep until the player comes back inside MID
+#define ENEMY_LOD_NEAR_TILES 24
+#define ENEMY_LOD_MID_TILES 48
+#define ENEMY_DEFAULT_CAPACITY 128 // enemy slots per world unless --enemies or --stress asks for another
+#define ENEMY_MAX_CAPACITY 1000000
+#define STRESS_TICKS 600 // --stress: fixed steps simulated per enemy count
+#define STRESS_CELLS_PER_ENEMY 4 // --stress without a level: arena size per enemy (open and floor cells)
+#define STRESS_FLOOR_SPACING 5 // --stress arena: rows from one floor to the next
 #define ROGUE_STOMP_BOUNCE_SPEED -520.0f
 #define ROGUE_STOMP_GRACE 10.0f
 #define ROGUE_PLAYER_HEALTH 3
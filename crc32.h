@@ -0,0 +1,7 @@
+// CRC-32 (IEEE 802.3, reflected 0xEDB88320) for file integrity checks
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Pass 0 as `crc` to start; feed the result back in to continue over several buffers
+uint32_t Crc32(uint32_t crc, const void *data, size_t size);
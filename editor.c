@@ -1,121 +1,363 @@
 #include "editor.h"
+#include <stdlib.h>
+#include <string.h>
 #include "input_config.h"
+#include "levelhistory.h"
+#include "levelreach.h"
+#include "levelsave.h"
 #include "raylib.h"
 #include "render.h"
 #include "ui.h"
+#include "world.h"
 
 static double arrowLastTime = 0;
 static double arrowInterval = 0.2; // 200ms
+static bool gShowReach = true; // reachability overlay (R)
 
-void UpdateLevelEditor(ScreenState *screen, GameState *game) {
+// Bulk tools: rectangle, line and flood fill paint with the tile of the last single-cell tile tool;
+// the stamp copies a rectangle (right-drag) and pastes it at the cursor
+static EditorTool gBrushTool = TOOL_ADD_BLOCK;
+static bool gDragging = false; // a rectangle/line/copy drag is in progress
+static int gAnchorX = 0, gAnchorY = 0; // cell where it started
+static uint8_t *gStamp = NULL; // copied cells, row-major
+static int gStampW = 0, gStampH = 0;
+
+static TileType BrushTile(void) {
+	switch (gBrushTool) {
+	case TOOL_REMOVE_BLOCK: return TILE_EMPTY;
+	case TOOL_LASER_TRAP: return TILE_LASER;
+	case TOOL_SPAWNER: return TILE_SPAWNER;
+	default: return TILE_BLOCK;
+	}
+}
+
+// Bulk tools leave the player and exit where they are
+static inline void PaintCell(LevelEditorState *ed, int cx, int cy, TileType v) {
+	if (!InBoundsCell(ed, cx, cy)) return;
+	TileType t = LevelTile(ed, cx, cy);
+	if (t != TILE_PLAYER && t != TILE_EXIT) SetTile(ed, cx, cy, v);
+}
+
+static void FillRect(LevelEditorState *ed, int x0, int y0, int x1, int y1, TileType v) {
+	if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+	if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+	Level_BeginBulk(ed);
+	for (int y = y0; y <= y1; ++y)
+		for (int x = x0; x <= x1; ++x) PaintCell(ed, x, y, v);
+	Level_EndBulk(ed);
+}
+
+static void DrawCellLine(LevelEditorState *ed, int x0, int y0, int x1, int y1, TileType v) {
+	int dx = abs(x1 - x0), dy = -abs(y1 - y0);
+	int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+	int err = dx + dy;
+	Level_BeginBulk(ed);
+	for (;;) {
+		PaintCell(ed, x0, y0, v);
+		if (x0 == x1 && y0 == y1) break;
+		int e2 = 2 * err;
+		if (e2 >= dy) { err += dy; x0 += sx; }
+		if (e2 <= dx) { err += dx; y0 += sy; }
+	}
+	Level_EndBulk(ed);
+}
+
+// The 4-connected region of the clicked cell's tile. Cells change as they are pushed, so each is
+// pushed once and the stack never outgrows the level.
+static void FloodFill(LevelEditorState *ed, int cx, int cy, TileType v) {
+	if (!InBoundsCell(ed, cx, cy)) return;
+	TileType from = LevelTile(ed, cx, cy);
+	if (from == v || from == TILE_PLAYER || from == TILE_EXIT) return;
+	int *stack = malloc((size_t)ed->cols * ed->rows * sizeof(int));
+	if (!stack) return;
+	int n = 0;
+	Level_BeginBulk(ed);
+	SetTile(ed, cx, cy, v);
+	stack[n++] = cy * ed->cols + cx;
+	while (n > 0) {
+		int cell = stack[--n];
+		int x = cell % ed->cols, y = cell / ed->cols;
+		const int nx[4] = {x - 1, x + 1, x, x}, ny[4] = {y, y, y - 1, y + 1};
+		for (int i = 0; i < 4; ++i) {
+			if (!InBoundsCell(ed, nx[i], ny[i]) || LevelTile(ed, nx[i], ny[i]) != from) continue;
+			SetTile(ed, nx[i], ny[i], v);
+			stack[n++] = ny[i] * ed->cols + nx[i];
+		}
+	}
+	Level_EndBulk(ed);
+	free(stack);
+}
+
+static void CopyStamp(const LevelEditorState *ed, int x0, int y0, int x1, int y1) {
+	if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+	if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+	int w = x1 - x0 + 1, h = y1 - y0 + 1;
+	uint8_t *stamp = realloc(gStamp, (size_t)w * h);
+	if (!stamp) return;
+	for (int y = 0; y < h; ++y) memcpy(stamp + (size_t)y * w, ed->tiles + (size_t)(y0 + y) * ed->cols + x0, (size_t)w);
+	gStamp = stamp;
+	gStampW = w;
+	gStampH = h;
+}
+
+// Player and exit cells in the stamp are skipped, so both stay unique
+static void PasteStamp(LevelEditorState *ed, int cx, int cy) {
+	Level_BeginBulk(ed);
+	for (int y = 0; y < gStampH; ++y)
+		for (int x = 0; x < gStampW; ++x) {
+			TileType t = (TileType)gStamp[(size_t)y * gStampW + x];
+			if (t != TILE_PLAYER && t != TILE_EXIT) PaintCell(ed, cx + x, cy + y, t);
+		}
+	Level_EndBulk(ed);
+}
+
+// The cells between two corners, in world space
+static Rectangle CellSpan(int x0, int y0, int x1, int y1) {
+	if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+	if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+	return (Rectangle){CellToWorld(x0), CellToWorld(y0), (float)((x1 - x0 + 1) * SQUARE_SIZE), (float)((y1 - y0 + 1) * SQUARE_SIZE)};
+}
+
+// Undo/redo can move the player and exit tiles; keep the markers drawn from GameState on them
+static void SyncMarkersToTiles(const LevelEditorState *ed, GameState *game) {
+	Vector2 p;
+	if (FindTileWorldPos(ed, TILE_PLAYER, &p)) game->playerPos = (Vector2){p.x + (float)SQUARE_SIZE * 0.5f, p.y + (float)SQUARE_SIZE * 0.5f};
+	if (FindTileWorldPos(ed, TILE_EXIT, &p)) game->exitPos = p;
+}
+
+void UpdateLevelEditor(ScreenState *screen, World *w) {
 	if (InputGate_BeginFrameBlocked()) return;
-	if (IsKeyPressed(KEY_TAB)) { editor.tool = (editor.tool + 1) % TOOL_COUNT; }
-	if (IsKeyPressed(KEY_ONE)) editor.tool = TOOL_PLAYER;
-	if (IsKeyPressed(KEY_TWO)) editor.tool = TOOL_ADD_BLOCK;
-	if (IsKeyPressed(KEY_THREE)) editor.tool = TOOL_REMOVE_BLOCK;
-	if (IsKeyPressed(KEY_FOUR)) editor.tool = TOOL_EXIT;
-	if (IsKeyPressed(KEY_FIVE)) editor.tool = TOOL_LASER_TRAP;
-	if (IsKeyPressed(KEY_SIX)) editor.tool = TOOL_SPAWNER;
+	LevelEditorState *ed = &w->level;
+	GameState *game = &w->game;
+	EditorTool prevTool = ed->tool;
+	if (IsKeyPressed(KEY_TAB)) { ed->tool = (ed->tool + 1) % TOOL_COUNT; }
+	if (IsKeyPressed(KEY_ONE)) ed->tool = TOOL_PLAYER;
+	if (IsKeyPressed(KEY_TWO)) ed->tool = TOOL_ADD_BLOCK;
+	if (IsKeyPressed(KEY_THREE)) ed->tool = TOOL_REMOVE_BLOCK;
+	if (IsKeyPressed(KEY_FOUR)) ed->tool = TOOL_EXIT;
+	if (IsKeyPressed(KEY_FIVE)) ed->tool = TOOL_LASER_TRAP;
+	if (IsKeyPressed(KEY_SIX)) ed->tool = TOOL_SPAWNER;
+	if (IsKeyPressed(KEY_SEVEN)) ed->tool = TOOL_RECT;
+	if (IsKeyPressed(KEY_EIGHT)) ed->tool = TOOL_LINE;
+	if (IsKeyPressed(KEY_NINE)) ed->tool = TOOL_FILL;
+	if (IsKeyPressed(KEY_ZERO)) ed->tool = TOOL_STAMP;
+	if (ed->tool != prevTool) gDragging = false;
+	if (ed->tool == TOOL_ADD_BLOCK || ed->tool == TOOL_REMOVE_BLOCK || ed->tool == TOOL_LASER_TRAP || ed->tool == TOOL_SPAWNER) gBrushTool = ed->tool;
+
+	// Ctrl+Z undoes a stroke; Ctrl+Y or Ctrl+Shift+Z redoes it
+	bool ctrl = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+	bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+	if (ctrl && ((IsKeyPressed(KEY_Z) && !shift && LevelHistory_Undo(ed)) || ((IsKeyPressed(KEY_Y) || (IsKeyPressed(KEY_Z) && shift)) && LevelHistory_Redo(ed))))
+		SyncMarkersToTiles(ed, game);
+	if (IsKeyPressed(KEY_R) && !ctrl) gShowReach = !gShowReach;
 
 	double now = GetTime();
 	bool moved = false;
-	if (now - arrowLastTime >= arrowInterval) {
+	bool resizing = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+	if (resizing && now - arrowLastTime >= arrowInterval) {
+		// Shift+Arrows grow/shrink the level from its right and bottom edges
+		int cols = ed->cols, rows = ed->rows;
+		if (IsKeyDown(KEY_RIGHT)) cols++;
+		if (IsKeyDown(KEY_LEFT)) cols--;
+		if (IsKeyDown(KEY_DOWN)) rows++;
+		if (IsKeyDown(KEY_UP)) rows--;
+		if (cols < LEVEL_MIN_COLS) cols = LEVEL_MIN_COLS;
+		if (rows < LEVEL_MIN_ROWS) rows = LEVEL_MIN_ROWS;
+		if ((cols != ed->cols || rows != ed->rows) && Level_Resize(ed, cols, rows)) arrowLastTime = now;
+	} else if (now - arrowLastTime >= arrowInterval) {
 		if (IsKeyDown(KEY_RIGHT)) {
-			editor.cursor.x += SQUARE_SIZE;
+			ed->cursor.x += SQUARE_SIZE;
 			moved = true;
 		}
 		if (IsKeyDown(KEY_LEFT)) {
-			editor.cursor.x -= SQUARE_SIZE;
+			ed->cursor.x -= SQUARE_SIZE;
 			moved = true;
 		}
 		if (IsKeyDown(KEY_UP)) {
-			editor.cursor.y -= SQUARE_SIZE;
+			ed->cursor.y -= SQUARE_SIZE;
 			moved = true;
 		}
 		if (IsKeyDown(KEY_DOWN)) {
-			editor.cursor.y += SQUARE_SIZE;
+			ed->cursor.y += SQUARE_SIZE;
 			moved = true;
 		}
 		if (moved) arrowLastTime = now;
 	}
 
+	// The view scrolls with the cursor, so the mouse only takes over when it moves or clicks
 	Vector2 mouse = GetMousePosition();
-	if (mouse.x >= 0 && mouse.x < WINDOW_WIDTH && mouse.y >= 0 && mouse.y < WINDOW_HEIGHT) { editor.cursor = SnapToGrid(mouse); }
+	Vector2 mouseDelta = GetMouseDelta();
+	bool mouseActive = mouseDelta.x != 0.0f || mouseDelta.y != 0.0f || IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+	if (mouseActive && mouse.x >= 0 && mouse.x < WINDOW_WIDTH && mouse.y >= 0 && mouse.y < WINDOW_HEIGHT) {
+		ed->cursor = SnapToGrid(ed, GetScreenToWorld2D(mouse, w->camera));
+	}
 
-	if (editor.cursor.x < 0) editor.cursor.x = 0;
-	if (editor.cursor.x > WINDOW_WIDTH - SQUARE_SIZE) editor.cursor.x = WINDOW_WIDTH - SQUARE_SIZE;
-	if (editor.cursor.y < 0) editor.cursor.y = 0;
-	if (editor.cursor.y > WINDOW_HEIGHT - SQUARE_SIZE) editor.cursor.y = WINDOW_HEIGHT - SQUARE_SIZE;
+	float maxX = LevelPixelWidth(ed) - SQUARE_SIZE, maxY = LevelPixelHeight(ed) - SQUARE_SIZE;
+	if (ed->cursor.x < 0) ed->cursor.x = 0;
+	if (ed->cursor.x > maxX) ed->cursor.x = maxX;
+	if (ed->cursor.y < 0) ed->cursor.y = 0;
+	if (ed->cursor.y > maxY) ed->cursor.y = maxY;
+	Render_FollowCamera(w, (Vector2){ed->cursor.x + SQUARE_SIZE * 0.5f, ed->cursor.y + SQUARE_SIZE * 0.5f});
 
-	switch (editor.tool) {
+	// One press of Space or the left button is one undo stroke
+	bool useTool = IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+	bool useToolPressed = IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+	if (!useTool) LevelHistory_EndStroke(ed);
+	int cursorX = WorldToCellX(ed->cursor.x), cursorY = WorldToCellY(ed->cursor.y);
+	switch (ed->tool) {
 	case TOOL_PLAYER:
-		if (IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-			int cx = WorldToCellX(editor.cursor.x), cy = WorldToCellY(editor.cursor.y);
-			SetUniqueTile(&editor, cx, cy, TILE_PLAYER);
+		if (useTool) {
+			int cx = WorldToCellX(ed->cursor.x), cy = WorldToCellY(ed->cursor.y);
+			SetUniqueTile(ed, cx, cy, TILE_PLAYER);
 			float px = CellToWorld(cx) + (float)SQUARE_SIZE * 0.5f;
 			float py = CellToWorld(cy) + (float)SQUARE_SIZE * 0.5f;
 			game->playerPos = (Vector2){px, py};
 		}
 		break;
 	case TOOL_ADD_BLOCK:
-		if (IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-			int cx = WorldToCellX(editor.cursor.x), cy = WorldToCellY(editor.cursor.y);
-			if (GetTile(&editor, cx, cy) != TILE_PLAYER && GetTile(&editor, cx, cy) != TILE_EXIT)
-				SetTile(&editor, cx, cy, TILE_BLOCK);
+		if (useTool) {
+			int cx = WorldToCellX(ed->cursor.x), cy = WorldToCellY(ed->cursor.y);
+			if (GetTile(ed, cx, cy) != TILE_PLAYER && GetTile(ed, cx, cy) != TILE_EXIT)
+				SetTile(ed, cx, cy, TILE_BLOCK);
 		}
 		break;
 	case TOOL_REMOVE_BLOCK:
-		if (IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-			int cx = WorldToCellX(editor.cursor.x), cy = WorldToCellY(editor.cursor.y);
-			TileType t = GetTile(&editor, cx, cy);
-			if (t == TILE_BLOCK || t == TILE_LASER || t == TILE_SPAWNER) SetTile(&editor, cx, cy, TILE_EMPTY);
+		if (useTool) {
+			int cx = WorldToCellX(ed->cursor.x), cy = WorldToCellY(ed->cursor.y);
+			TileType t = GetTile(ed, cx, cy);
+			if (t == TILE_BLOCK || t == TILE_LASER || t == TILE_SPAWNER) SetTile(ed, cx, cy, TILE_EMPTY);
 		}
 		break;
 	case TOOL_EXIT:
-		if (IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-			int cx = WorldToCellX(editor.cursor.x), cy = WorldToCellY(editor.cursor.y);
-			SetUniqueTile(&editor, cx, cy, TILE_EXIT);
+		if (useTool) {
+			int cx = WorldToCellX(ed->cursor.x), cy = WorldToCellY(ed->cursor.y);
+			SetUniqueTile(ed, cx, cy, TILE_EXIT);
 			game->exitPos = (Vector2){CellToWorld(cx), CellToWorld(cy)};
 		}
 		break;
 	case TOOL_LASER_TRAP:
-		if (IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-			int cx = WorldToCellX(editor.cursor.x), cy = WorldToCellY(editor.cursor.y);
-			if (GetTile(&editor, cx, cy) == TILE_EMPTY) SetTile(&editor, cx, cy, TILE_LASER);
+		if (useTool) {
+			int cx = WorldToCellX(ed->cursor.x), cy = WorldToCellY(ed->cursor.y);
+			if (GetTile(ed, cx, cy) == TILE_EMPTY) SetTile(ed, cx, cy, TILE_LASER);
 		}
 		break;
 	case TOOL_SPAWNER:
-		if (IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-			int cx = WorldToCellX(editor.cursor.x), cy = WorldToCellY(editor.cursor.y);
-			if (GetTile(&editor, cx, cy) == TILE_EMPTY) SetTile(&editor, cx, cy, TILE_SPAWNER);
+		if (useTool) {
+			int cx = WorldToCellX(ed->cursor.x), cy = WorldToCellY(ed->cursor.y);
+			if (GetTile(ed, cx, cy) == TILE_EMPTY) SetTile(ed, cx, cy, TILE_SPAWNER);
 		}
 		break;
+	case TOOL_RECT:
+	case TOOL_LINE:
+		// Drag from the anchor; the shape is applied, as one undo step, on release
+		if (useTool && !gDragging) {
+			gDragging = true;
+			gAnchorX = cursorX;
+			gAnchorY = cursorY;
+		} else if (!useTool && gDragging) {
+			gDragging = false;
+			if (ed->tool == TOOL_RECT) FillRect(ed, gAnchorX, gAnchorY, cursorX, cursorY, BrushTile());
+			else DrawCellLine(ed, gAnchorX, gAnchorY, cursorX, cursorY, BrushTile());
+			LevelHistory_EndStroke(ed);
+		}
+		break;
+	case TOOL_FILL:
+		if (useToolPressed) {
+			FloodFill(ed, cursorX, cursorY, BrushTile());
+			LevelHistory_EndStroke(ed);
+		}
+		break;
+	case TOOL_STAMP: {
+		bool copying = IsMouseButtonDown(MOUSE_RIGHT_BUTTON);
+		if (copying && !gDragging) {
+			gDragging = true;
+			gAnchorX = cursorX;
+			gAnchorY = cursorY;
+		} else if (!copying && gDragging) {
+			gDragging = false;
+			CopyStamp(ed, gAnchorX, gAnchorY, cursorX, cursorY);
+		}
+		if (useToolPressed && gStamp && !gDragging) {
+			PasteStamp(ed, cursorX, cursorY);
+			LevelHistory_EndStroke(ed);
+		}
+		break;
+	}
 	default:
 		break;
 	}
 
+	if (gShowReach) LevelReach_Update(ed);
+
 	if (InputPressed(ACT_BACK)) {
-		SaveLevelBinary(game, &editor);
+		LevelSave_Queue(w->levelPath, game, ed);
+		LevelJournal_End(ed);
+		LevelHistory_Detach(ed);
 		InputGate_RequestBlockOnce();
 		*screen = SCREEN_MENU;
 	}
 
+	if ((ctrl && IsKeyPressed(KEY_S)) || LevelJournal_TakeSaveDue()) LevelSave_Queue(w->levelPath, game, ed);
+
+	// Test play runs on this level in memory; the journal keeps the edits safe meanwhile
 	if (InputPressed(ACT_ACTIVATE)) {
-		SaveLevelBinary(game, &editor);
+		LevelHistory_EndStroke(ed);
 		*screen = SCREEN_TEST_PLAY;
 	}
 }
 
-void RenderLevelEditor(const GameState *game) {
-	for (int x = 0; x <= WINDOW_WIDTH; x += SQUARE_SIZE) DrawLine(x, 0, x, WINDOW_HEIGHT, LIGHTGRAY);
-	for (int y = 0; y <= WINDOW_HEIGHT; y += SQUARE_SIZE) DrawLine(0, y, WINDOW_WIDTH, y, LIGHTGRAY);
-	RenderTiles(&editor);
+void RenderLevelEditor(const World *w) {
+	const LevelEditorState *ed = &w->level;
+	const GameState *game = &w->game;
+	Rectangle view = Render_ViewRect(w->camera);
+	int levelW = (int)LevelPixelWidth(ed), levelH = (int)LevelPixelHeight(ed);
+	int x0 = WorldToCellX(view.x), x1 = WorldToCellX(view.x + view.width) + 1;
+	int y0 = WorldToCellY(view.y), y1 = WorldToCellY(view.y + view.height) + 1;
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > ed->cols) x1 = ed->cols;
+	if (y1 > ed->rows) y1 = ed->rows;
+	BeginMode2D(w->camera);
+	for (int x = x0; x <= x1; ++x) DrawLine(x * SQUARE_SIZE, y0 * SQUARE_SIZE, x * SQUARE_SIZE, y1 * SQUARE_SIZE, LIGHTGRAY);
+	for (int y = y0; y <= y1; ++y) DrawLine(x0 * SQUARE_SIZE, y * SQUARE_SIZE, x1 * SQUARE_SIZE, y * SQUARE_SIZE, LIGHTGRAY);
+	DrawRectangleLines(0, 0, levelW, levelH, DARKGRAY);
+	const LevelReachResult *reach = LevelReach_Result();
+	if (gShowReach && reach->cells && reach->cols == ed->cols && reach->rows == ed->rows) {
+		// Cells the player can occupy; greyed while the analysis catches up with an edit
+		Color tint = Fade(reach->revision == ed->revision ? SKYBLUE : LIGHTGRAY, 0.4f);
+		for (int y = y0; y < y1; ++y)
+			for (int x = x0; x < x1; ++x)
+				if (reach->cells[y * ed->cols + x]) DrawRectangle(x * SQUARE_SIZE, y * SQUARE_SIZE, SQUARE_SIZE, SQUARE_SIZE, tint);
+	}
+	RenderTiles(ed, view);
 	// Draw player using actual AABB/sprite so it scales with SQUARE_SIZE changes
-	RenderPlayer(game);
+	RenderPlayer(w);
 	DrawRectangleRec((Rectangle){game->exitPos.x, game->exitPos.y, (float)SQUARE_SIZE, (float)SQUARE_SIZE}, GREEN);
+	int cursorX = WorldToCellX(ed->cursor.x), cursorY = WorldToCellY(ed->cursor.y);
+	if (gDragging && ed->tool == TOOL_LINE) {
+		float half = (float)SQUARE_SIZE * 0.5f;
+		DrawLineEx((Vector2){CellToWorld(gAnchorX) + half, CellToWorld(gAnchorY) + half}, (Vector2){ed->cursor.x + half, ed->cursor.y + half}, 3.0f, ORANGE);
+	} else if (gDragging) {
+		DrawRectangleLinesEx(CellSpan(gAnchorX, gAnchorY, cursorX, cursorY), 2.0f, ed->tool == TOOL_STAMP ? SKYBLUE : ORANGE);
+	} else if (ed->tool == TOOL_STAMP && gStamp) {
+		DrawRectangleLinesEx(CellSpan(cursorX, cursorY, cursorX + gStampW - 1, cursorY + gStampH - 1), 2.0f, SKYBLUE);
+	}
+	DrawRectangleLines((int)ed->cursor.x, (int)ed->cursor.y, SQUARE_SIZE, SQUARE_SIZE, RED);
+	EndMode2D();
 	DrawText("LEVEL EDITOR", 20, 20, 32, DARKGRAY);
-	const char *toolNames[TOOL_COUNT] = {"Player Location", "Add Block", "Remove Block", "Level Exit", "Laser Trap", "Enemy Spawner"};
-	DrawText(TextFormat("Tool: %s (Tab to switch)", toolNames[editor.tool]), 20, 60, 18, BLUE);
-	DrawText("Arrows/Mouse: Move cursor | Space/Left Click: Use tool | 1-6: Tools (5=Laser, 6=Spawner) | ESC: Menu", 20, 85, 18, DARKGRAY);
-	DrawRectangleLines((int)editor.cursor.x, (int)editor.cursor.y, SQUARE_SIZE, SQUARE_SIZE, RED);
+	const char *toolNames[TOOL_COUNT] = {"Player Location", "Add Block", "Remove Block", "Level Exit", "Laser Trap", "Enemy Spawner", "Rectangle", "Line", "Flood Fill", "Stamp (right-drag to copy)"};
+	DrawText(TextFormat("Tool: %s (Tab to switch)", toolNames[ed->tool]), 20, 60, 18, BLUE);
+	DrawText("Arrows/Mouse: Move cursor | Space/Left Click: Use tool | 1-6: Tools (5=Laser, 6=Spawner) | 7-0: Rect/Line/Fill/Stamp | Enter: Test | Ctrl+S: Save | ESC: Save & menu", 20, 85, 18, DARKGRAY);
+	int undo, redo;
+	LevelHistory_Counts(ed, &undo, &redo);
+	DrawText(TextFormat("Size: %dx%d (Shift+Arrows to resize) | Undo: Ctrl+Z (%d) | Redo: Ctrl+Y (%d)", ed->cols, ed->rows, undo, redo), 20, 110, 18, DARKGRAY);
+	if (LevelSave_LastFailed()) DrawText("Save failed! Edits are kept in the journal", 20, 135, 18, RED);
+	else if (LevelSave_Busy()) DrawText("Saving...", 20, 135, 18, GRAY);
+	else if (LevelJournal_Recovered() > 0) DrawText(TextFormat("Recovered %d unsaved edits", LevelJournal_Recovered()), 20, 135, 18, ORANGE);
+	if (!gShowReach) return;
+	if (!reach->cells || reach->revision != ed->revision) DrawText("Reachability: checking... (R to hide)", 20, 160, 18, GRAY);
+	else if (!reach->hasPlayer || !reach->hasExit) DrawText("Reachability: place a player start and an exit (R to hide)", 20, 160, 18, GRAY);
+	else if (reach->exitReachable) DrawText(TextFormat("Exit reachable (%d movement states explored; R to hide)", reach->states), 20, 160, 18, DARKGREEN);
+	else if (reach->partial) DrawText("Exit not reached before the search limit (R to hide)", 20, 160, 18, ORANGE);
+	else DrawText("Exit NOT reachable from the player start (R to hide)", 20, 160, 18, RED);
 }
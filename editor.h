@@ -3,5 +3,7 @@
 #include "level.h"
 #include "screens.h"
 
-void UpdateLevelEditor(ScreenState *screen, GameState *game);
-void RenderLevelEditor(const GameState *game);
+struct World;
+
+void UpdateLevelEditor(ScreenState *screen, struct World *w);
+void RenderLevelEditor(const struct World *w);
@@ -1,201 +1,526 @@
 #include "enemy.h"
+#include "chunkstream.h"
 #include "config.h"
+#include "enemynav.h"
 #include "physics.h"
 #include "level.h"
+#include "levelbake.h"
+#include "player.h"
+#include "render.h"
+#include "stress.h"
+#include "world.h"
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
-static EnemySpawner gSpawners[MAX_SPAWNERS];
-static int gSpawnerCount = 0;
-static Enemy gEnemies[MAX_ENEMIES];
-
-static const float kSpawnInterval = (float)ROGUE_SPAWN_INTERVAL_MS / 1000.0f;
 static const float kEnemyW = ROGUE_ENEMY_W;
 static const float kEnemyH = ROGUE_ENEMY_H;
+static const float kGridCell = (float)SQUARE_SIZE; // no smaller than an enemy, so overlaps are between neighbor cells
+
+// Far enemies catch up in one-tick substeps; a substep at terminal speed must not skip a whole tile
+typedef char EnemyFallFitsTile[((int)ROGUE_ENEMY_MAX_FALL < SQUARE_SIZE * (int)BASE_FPS) ? 1 : -1];
+
+// World.timers event kinds
+enum { TIMER_SPAWNER, TIMER_WAVE };
+
+// Per-tick working memory, sized with the pool: which enemies stepped, and a hashed uniform grid
+// listing the active enemies by cell so overlap tests only look at the 3x3 cells around an enemy
+typedef struct EnemyScratch {
+	bool *stepped;
+	int *cellX, *cellY; // grid cell of each active enemy when the grid was built
+	int *order; // active enemy indices grouped by bucket, ascending within a bucket
+	int *bucketStart; // bucketCount + 1 offsets into order
+	int bucketCount; // power of two
+} EnemyScratch;
+
+static void FreeScratch(EnemyScratch *s) {
+	if (!s) return;
+	free(s->stepped);
+	free(s->cellX);
+	free(s->cellY);
+	free(s->order);
+	free(s->bucketStart);
+	free(s);
+}
+
+static EnemyScratch *NewScratch(int capacity) {
+	EnemyScratch *s = calloc(1, sizeof(EnemyScratch));
+	if (!s) return NULL;
+	s->bucketCount = 64;
+	while (s->bucketCount < capacity * 2) s->bucketCount *= 2;
+	s->stepped = calloc((size_t)capacity, sizeof(bool));
+	s->cellX = malloc((size_t)capacity * sizeof(int));
+	s->cellY = malloc((size_t)capacity * sizeof(int));
+	s->order = malloc((size_t)capacity * sizeof(int));
+	s->bucketStart = malloc((size_t)(s->bucketCount + 1) * sizeof(int));
+	if (!s->stepped || !s->cellX || !s->cellY || !s->order || !s->bucketStart) {
+		FreeScratch(s);
+		return NULL;
+	}
+	return s;
+}
+
+bool Enemy_SetCapacity(World *w, int capacity) {
+	if (capacity < 0 || capacity > ENEMY_MAX_CAPACITY) return false;
+	Enemy *enemies = NULL;
+	EnemyScratch *scratch = NULL;
+	if (capacity > 0) {
+		enemies = calloc((size_t)capacity, sizeof(Enemy));
+		scratch = enemies ? NewScratch(capacity) : NULL;
+		if (!scratch) {
+			free(enemies);
+			return false;
+		}
+	}
+	Enemy_Free(w);
+	w->enemies = enemies;
+	w->enemyScratch = scratch;
+	w->enemyCapacity = capacity;
+	return true;
+}
+
+void Enemy_Free(World *w) {
+	free(w->enemies);
+	FreeScratch(w->enemyScratch);
+	w->enemies = NULL;
+	w->enemyScratch = NULL;
+	w->enemyCapacity = 0;
+	w->enemyFreeHint = 0;
+}
 
-void Enemy_Init(void) {
-	Enemy_Clear();
+void Enemy_Clear(World *w) {
+	w->spawnerCount = 0;
+	w->waveCount = 0;
+	memset(w->spawners, 0, sizeof(w->spawners));
+	memset(w->waves, 0, sizeof(w->waves));
+	if (!w->enemies) Enemy_SetCapacity(w, ENEMY_DEFAULT_CAPACITY); // out of memory: a level without enemies
+	if (w->enemies) memset(w->enemies, 0, (size_t)w->enemyCapacity * sizeof(Enemy));
+	w->enemyFreeHint = 0;
+	TimerWheel_Reset(&w->timers, w->tick);
 }
 
-void Enemy_Clear(void) {
-	gSpawnerCount = 0;
-	memset(gSpawners, 0, sizeof(gSpawners));
-	memset(gEnemies, 0, sizeof(gEnemies));
+static uint32_t MsToTicks(uint32_t ms) { return (uint32_t)(((uint64_t)ms * (uint64_t)BASE_FPS + 500) / 1000); }
+
+// Spawners fire on the first tick and then every interval from the level file
+static void AddSpawner(World *w, int cx, int cy) {
+	if (w->spawnerCount >= MAX_SPAWNERS) return;
+	EnemySpawner *s = &w->spawners[w->spawnerCount++];
+	s->pos = (Vector2){CellToWorld(cx), CellToWorld(cy)};
+	uint32_t ms = Level_SpawnerIntervalMs(&w->level, cx, cy);
+	s->intervalTicks = ms > 0 && MsToTicks(ms) == 0 ? 1 : MsToTicks(ms);
+	s->nextTick = w->tick + 1;
 }
 
-void Enemy_BuildFromLevel(const struct LevelEditorState *level) {
-	Enemy_Clear();
-	if (!level) return;
-	for (int y = 0; y < GRID_ROWS; ++y) {
-		for (int x = 0; x < GRID_COLS; ++x) {
-			if (!IsSpawnerTile(level->tiles[y][x])) continue;
-			if (gSpawnerCount >= MAX_SPAWNERS) return;
-			EnemySpawner *s = &gSpawners[gSpawnerCount++];
-			s->pos = (Vector2){CellToWorld(x), CellToWorld(y)};
-			s->timer = 0.0f;
+static void AddSpawners(World *w) {
+	const LevelEditorState *level = &w->level;
+	if (level->stream) {
+		// Streamed levels list their spawners in the file (same row-major order), so nothing is decoded here
+		for (int i = 0; i < ChunkStream_SpawnerCount(level->stream); ++i) {
+			int cx, cy;
+			ChunkStream_SpawnerCell(level->stream, i, &cx, &cy);
+			AddSpawner(w, cx, cy);
 		}
+		return;
+	}
+	if (level->bake) {
+		for (int i = 0; i < level->bake->spawnerCount; ++i) AddSpawner(w, level->bake->spawners[i] % level->cols, level->bake->spawners[i] / level->cols);
+		return;
+	}
+	const LevelCellList *cells = Level_SpecialCells(level, TILE_SPAWNER);
+	for (int i = 0; i < cells->count; ++i) AddSpawner(w, cells->cells[i] % level->cols, cells->cells[i] / level->cols);
+}
+
+void Enemy_BuildFromLevel(World *w) {
+	Enemy_Clear(w);
+	AddSpawners(w);
+	const LevelSchedule *schedule = &w->level.schedule;
+	for (int i = 0; i < schedule->waveCount && w->waveCount < LEVEL_MAX_WAVES; ++i) {
+		const LevelWave *src = &schedule->waves[i];
+		if (src->count == 0) continue;
+		EnemyWave *wave = &w->waves[w->waveCount++];
+		wave->pos = (Vector2){CellToWorld(src->cx), CellToWorld(src->cy)};
+		wave->startTicks = MsToTicks(src->startMs) > 0 ? MsToTicks(src->startMs) : 1;
+		wave->repeatTicks = src->repeatMs > 0 && MsToTicks(src->repeatMs) == 0 ? 1 : MsToTicks(src->repeatMs);
+		wave->nextTick = w->tick + wave->startTicks;
+		wave->count = src->count;
 	}
+	Enemy_ScheduleTimers(w);
 }
 
-static void SpawnEnemy(Vector2 spawnPos) {
-	if (AABBOverlapsSolid(spawnPos.x, spawnPos.y, kEnemyW, kEnemyH)) return;
-	for (int i = 0; i < MAX_ENEMIES; ++i) {
-		Enemy *e = &gEnemies[i];
+void Enemy_ScheduleTimers(World *w) {
+	TimerWheel_Reset(&w->timers, w->tick);
+	for (int i = 0; i < w->spawnerCount; ++i)
+		if (w->spawners[i].intervalTicks > 0) TimerWheel_Schedule(&w->timers, w->spawners[i].nextTick, TIMER_SPAWNER, (uint16_t)i);
+	for (int i = 0; i < w->waveCount; ++i) {
+		const EnemyWave *wave = &w->waves[i];
+		if (wave->repeatTicks == 0 && wave->nextTick <= w->tick) continue; // one-shot that already fired
+		TimerWheel_Schedule(&w->timers, wave->nextTick, TIMER_WAVE, (uint16_t)i);
+	}
+}
+
+// Standing on the floor of the cell whose top-left is `cell`
+static Vector2 SpawnPosition(Vector2 cell) {
+	return (Vector2){cell.x + ((float)SQUARE_SIZE - kEnemyW) * 0.5f, cell.y + ((float)SQUARE_SIZE - kEnemyH)};
+}
+
+bool Enemy_Spawn(World *w, Vector2 pos) {
+	if (AABBOverlapsSolid(w, pos.x, pos.y, kEnemyW, kEnemyH)) return false;
+	for (int i = w->enemyFreeHint; i < w->enemyCapacity; ++i) {
+		Enemy *e = &w->enemies[i];
 		if (e->active) continue;
+		memset(e, 0, sizeof(*e));
 		e->active = true;
-		e->pos = spawnPos;
-		e->vel = (Vector2){0, 0};
-		return;
+		e->pos = pos;
+		e->renderFrom = pos;
+		e->lastTick = w->tick - 1; // due this tick
+		e->period = 1;
+		w->enemyFreeHint = i + 1;
+		return true;
 	}
+	w->enemyFreeHint = w->enemyCapacity;
+	return false;
+}
+
+static void Despawn(World *w, int i) {
+	w->enemies[i].active = false;
+	if (i < w->enemyFreeHint) w->enemyFreeHint = i;
 }
 
 static Rectangle EnemyAABB(const Enemy *e) {
 	return (Rectangle){e->pos.x, e->pos.y, kEnemyW, kEnemyH};
 }
 
-static void ResolveEnemyEnemyCollisions(void) {
-	for (int i = 0; i < MAX_ENEMIES; ++i) {
-		Enemy *a = &gEnemies[i];
-		if (!a->active) continue;
-		for (int j = i + 1; j < MAX_ENEMIES; ++j) {
-			Enemy *b = &gEnemies[j];
-			if (!b->active) continue;
-			Rectangle ra = EnemyAABB(a);
-			Rectangle rb = EnemyAABB(b);
-			if (!CheckCollisionRecs(ra, rb)) continue;
-
-			float penX = fminf(ra.x + ra.width - rb.x, rb.x + rb.width - ra.x);
-			float penY = fminf(ra.y + ra.height - rb.y, rb.y + rb.height - ra.y);
-			Vector2 pushA = {0, 0};
-			Vector2 pushB = {0, 0};
-			if (penX < penY) {
-				float dir = (ra.x < rb.x) ? -1.0f : 1.0f;
-				float amt = penX * 0.5f;
-				pushA.x = dir * amt;
-				pushB.x = -dir * amt;
-				a->vel.x = 0.0f;
-				b->vel.x = 0.0f;
-			} else {
-				float dir = (ra.y < rb.y) ? -1.0f : 1.0f;
-				float amt = penY * 0.5f;
-				pushA.y = dir * amt;
-				pushB.y = -dir * amt;
-				a->vel.y = 0.0f;
-				b->vel.y = 0.0f;
-			}
+// Horizontal speed that reaches x this tick without overshooting it
+static float SteerTo(float from, float to, float dt) {
+	float v = (to - from) / dt;
+	if (v > ROGUE_ENEMY_SPEED) v = ROGUE_ENEMY_SPEED;
+	if (v < -ROGUE_ENEMY_SPEED) v = -ROGUE_ENEMY_SPEED;
+	return v;
+}
+
+static float CellCenterX(int cx) { return CellToWorld(cx) + (float)SQUARE_SIZE * 0.5f; }
 
-			Enemy movedA = *a;
-			Enemy movedB = *b;
-			movedA.pos.x += pushA.x;
-			movedA.pos.y += pushA.y;
-			movedB.pos.x += pushB.x;
-			movedB.pos.y += pushB.y;
-			bool blockedA = AABBOverlapsSolid(movedA.pos.x, movedA.pos.y, kEnemyW, kEnemyH);
-			bool blockedB = AABBOverlapsSolid(movedB.pos.x, movedB.pos.y, kEnemyW, kEnemyH);
-			if (!blockedA) a->pos = movedA.pos;
-			if (!blockedB) b->pos = movedB.pos;
+// Movement treats pos as the body's center
+static bool EnemyOnGround(const World *w, const Enemy *e) {
+	if (e->vel.y < 0.0f) return false;
+	int cy = WorldToCellY(e->pos.y + kEnemyH * 0.5f + 0.5f);
+	int x0 = WorldToCellX(e->pos.x - kEnemyW * 0.5f + 0.01f);
+	int x1 = WorldToCellX(e->pos.x + kEnemyW * 0.5f - 0.01f);
+	for (int cx = x0; cx <= x1; ++cx)
+		if (Physics_BlockAtCell(w, cx, cy)) return true;
+	return false;
+}
+
+static int EnemySegment(const World *w, const Enemy *e) {
+	return EnemyNav_SegmentBelow(w->nav, WorldToCellX(e->pos.x), WorldToCellY(e->pos.y + kEnemyH * 0.5f - 0.01f));
+}
+
+// The segment the player stands on, or would land on from where it is
+static int PlayerSegment(const World *w) {
+	Rectangle pb = PlayerAABB(w);
+	return EnemyNav_SegmentBelow(w->nav, WorldToCellX(pb.x + pb.width * 0.5f), WorldToCellY(pb.y + pb.height - 0.01f));
+}
+
+// On a link: head for the landing cell, except that a jump first rises clear of the ledge
+static float LinkSteerX(const Enemy *e, const NavLink *l, float dt) {
+	bool belowLanding = e->pos.y + kEnemyH * 0.5f > CellToWorld(l->landRow + 1);
+	if (l->kind == NAV_LINK_JUMP && belowLanding) return 0.0f;
+	return SteerTo(e->pos.x, CellCenterX(l->landX), dt);
+}
+
+static void ChasePlayer(const World *w, Enemy *e) {
+	float playerMidX = w->game.playerPos.x;
+	float enemyMidX = e->pos.x + kEnemyW * 0.5f;
+	float dir = (playerMidX >= enemyMidX) ? 1.0f : -1.0f;
+	e->vel.x = dir * ROGUE_ENEMY_SPEED;
+}
+
+// Set vel.x along the shortest path to the player's segment. Walking is steered toward the next
+// link's takeoff cell; arriving there starts the link (a jump, or walking off the edge), which is
+// followed until the enemy lands again.
+static void FollowNav(World *w, Enemy *e, int playerSeg, float dt) {
+	const bool grounded = EnemyOnGround(w, e);
+	if (e->navLink) {
+		const NavLink *l = EnemyNav_Link(w->nav, e->navLink - 1);
+		if (!grounded) e->navAir = true;
+		if (grounded && (e->navAir || EnemySegment(w, e) != l->from)) {
+			e->navLink = 0; // landed (where planned or not): plan again from here
+		} else {
+			e->vel.x = LinkSteerX(e, l, dt);
+			return;
 		}
 	}
+
+	int seg = EnemySegment(w, e);
+	if (seg < 0 || playerSeg < 0) {
+		ChasePlayer(w, e);
+		return;
+	}
+	if (seg == playerSeg) {
+		e->vel.x = SteerTo(e->pos.x, w->game.playerPos.x, dt);
+		return;
+	}
+	int link = EnemyNav_NextLink(w->nav, seg, playerSeg);
+	if (link < 0) {
+		ChasePlayer(w, e); // no way there: press toward the player anyway
+		return;
+	}
+	const NavLink *l = EnemyNav_Link(w->nav, link);
+	float takeoff = CellCenterX(l->takeoffX);
+	if (!grounded || fabsf(takeoff - e->pos.x) >= 1.0f) {
+		e->vel.x = SteerTo(e->pos.x, takeoff, dt);
+		return;
+	}
+	e->navLink = link + 1;
+	e->navAir = false;
+	if (l->kind == NAV_LINK_JUMP) e->vel.y = -ROGUE_ENEMY_JUMP_SPEED;
+	e->vel.x = LinkSteerX(e, l, dt);
+}
+
+// Shift an enemy out of an overlap, waking it if it slept; its render easing shifts along
+static void PushEnemy(const World *w, Enemy *e, Vector2 to) {
+	e->renderFrom.x += to.x - e->pos.x;
+	e->renderFrom.y += to.y - e->pos.y;
+	e->pos = to;
+	if (e->asleep) {
+		e->asleep = false;
+		e->lastTick = w->tick - 1;
+	}
+}
+
+// Push an overlapping pair (a before b in the pool) apart along the shallower axis
+static void SeparatePair(World *w, Enemy *a, Enemy *b) {
+	Rectangle ra = EnemyAABB(a);
+	Rectangle rb = EnemyAABB(b);
+	if (!CheckCollisionRecs(ra, rb)) return;
+
+	float penX = fminf(ra.x + ra.width - rb.x, rb.x + rb.width - ra.x);
+	float penY = fminf(ra.y + ra.height - rb.y, rb.y + rb.height - ra.y);
+	Vector2 pushA = {0, 0};
+	Vector2 pushB = {0, 0};
+	if (penX < penY) {
+		float dir = (ra.x < rb.x) ? -1.0f : 1.0f;
+		float amt = penX * 0.5f;
+		pushA.x = dir * amt;
+		pushB.x = -dir * amt;
+		a->vel.x = 0.0f;
+		b->vel.x = 0.0f;
+	} else {
+		float dir = (ra.y < rb.y) ? -1.0f : 1.0f;
+		float amt = penY * 0.5f;
+		pushA.y = dir * amt;
+		pushB.y = -dir * amt;
+		a->vel.y = 0.0f;
+		b->vel.y = 0.0f;
+	}
+
+	Enemy movedA = *a;
+	Enemy movedB = *b;
+	movedA.pos.x += pushA.x;
+	movedA.pos.y += pushA.y;
+	movedB.pos.x += pushB.x;
+	movedB.pos.y += pushB.y;
+	bool blockedA = AABBOverlapsSolid(w, movedA.pos.x, movedA.pos.y, kEnemyW, kEnemyH);
+	bool blockedB = AABBOverlapsSolid(w, movedB.pos.x, movedB.pos.y, kEnemyW, kEnemyH);
+	if (!blockedA) PushEnemy(w, a, movedA.pos);
+	if (!blockedB) PushEnemy(w, b, movedB.pos);
+}
+
+static inline int GridBucket(const EnemyScratch *s, int cx, int cy) {
+	return (int)(((uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u) & (uint32_t)(s->bucketCount - 1));
+}
+
+// Counting sort of the active enemies into grid buckets, keeping pool order within each
+static void BuildGrid(const World *w, EnemyScratch *s) {
+	memset(s->bucketStart, 0, (size_t)(s->bucketCount + 1) * sizeof(int));
+	for (int i = 0; i < w->enemyCapacity; ++i) {
+		const Enemy *e = &w->enemies[i];
+		if (!e->active) continue;
+		s->cellX[i] = (int)floorf(e->pos.x / kGridCell);
+		s->cellY[i] = (int)floorf(e->pos.y / kGridCell);
+		s->bucketStart[GridBucket(s, s->cellX[i], s->cellY[i]) + 1]++;
+	}
+	for (int b = 0; b < s->bucketCount; ++b) s->bucketStart[b + 1] += s->bucketStart[b];
+	for (int i = 0; i < w->enemyCapacity; ++i) {
+		if (!w->enemies[i].active) continue;
+		s->order[s->bucketStart[GridBucket(s, s->cellX[i], s->cellY[i])]++] = i;
+	}
+	// The fill advanced every start to the next bucket's: shift them back
+	for (int b = s->bucketCount; b > 0; --b) s->bucketStart[b] = s->bucketStart[b - 1];
+	s->bucketStart[0] = 0;
 }
 
-// Need to access GameState for player pos/vel/health.
-// We can include game.h (already done) but we need to declare the functions we use if they are not in a header.
-// `PlayerAABB` is in game.c static. We should move it to player.h or make it public in game.h.
-// For now, let's assume we'll move `PlayerAABB` to `player.h` or `game.h`.
-// Also `TriggerDeath` and `Render_SpawnLandDust` etc.
-// This is getting tricky. `TriggerDeath` is in `game.c`.
-// Maybe we should keep `HandleEnemyPlayerCollisions` in `game.c` for now, and just expose `gEnemies`?
-// Or better, pass a callback or return events?
-// Let's try to implement `HandleCollision` here but we need `TakeDamage` and `TriggerDeath`.
-// `TakeDamage` was static in `game.c`.
-// Let's declare them as extern for now or move them to `player.h` later.
-
-extern Rectangle PlayerAABB(const GameState *game); // Will be in player.h
-extern void TakeDamage(GameState *game, Vector2 sourcePos); // Will be in player.h
-extern void Render_SpawnLandDust(GameState *game); // In render.h? No, static in render.c? No, `Render_SpawnLandDust` is in `render.h` usually?
-// Check render.h
-// `render.h` has `Render_SpawnLandDust`.
-
-static void HandleEnemyPlayerCollisions(GameState *game) {
-	if (Game_IsDying()) return;
-	Rectangle pb = PlayerAABB(game);
+// Only pairs with an enemy that moved this tick can have started overlapping. Each pair is taken
+// once, from the stepped enemy (the lower index when both stepped), among the enemies binned in
+// the cells around it.
+static void ResolveEnemyEnemyCollisions(World *w) {
+	EnemyScratch *s = w->enemyScratch;
+	if (!s) return;
+	BuildGrid(w, s);
+	for (int i = 0; i < w->enemyCapacity; ++i) {
+		if (!w->enemies[i].active || !s->stepped[i]) continue;
+		for (int cy = s->cellY[i] - 1; cy <= s->cellY[i] + 1; ++cy)
+			for (int cx = s->cellX[i] - 1; cx <= s->cellX[i] + 1; ++cx) {
+				int b = GridBucket(s, cx, cy);
+				for (int k = s->bucketStart[b]; k < s->bucketStart[b + 1]; ++k) {
+					int j = s->order[k];
+					if (j == i || s->cellX[j] != cx || s->cellY[j] != cy) continue; // another cell in the bucket
+					if (s->stepped[j] && j < i) continue; // taken from j
+					if (j < i) SeparatePair(w, &w->enemies[j], &w->enemies[i]);
+					else SeparatePair(w, &w->enemies[i], &w->enemies[j]);
+				}
+			}
+	}
+}
+
+static void HandleEnemyPlayerCollisions(World *w) {
+	if (Game_IsDying(w)) return;
+	GameState *game = &w->game;
+	Rectangle pb = PlayerAABB(w);
 	float playerBottom = pb.y + pb.height;
-	for (int i = 0; i < MAX_ENEMIES; ++i) {
-		Enemy *e = &gEnemies[i];
+	for (int i = 0; i < w->enemyCapacity; ++i) {
+		Enemy *e = &w->enemies[i];
 		if (!e->active) continue;
 		Rectangle eb = EnemyAABB(e);
 		if (!CheckCollisionRecs(pb, eb)) continue;
 		float enemyTop = eb.y;
 		bool stomping = (game->playerVel.y > 0.0f) && (playerBottom <= enemyTop + ROGUE_STOMP_GRACE);
 		if (stomping) {
-			e->active = false;
+			Despawn(w, i);
 			game->playerVel.y = ROGUE_STOMP_BOUNCE_SPEED;
 			game->onGround = false;
 			game->coyoteTimer = 0.0f;
 			game->jumpBufferTimer = 0.0f;
-			Render_SpawnLandDust(game);
+			Render_SpawnLandDust(w);
 		} else {
-			TakeDamage(game, e->pos);
+			TakeDamage(w, e->pos);
 			return;
 		}
 	}
 }
 
-void Enemy_Update(GameState *game, float dt) {
-	// Update Spawners
-	if (kSpawnInterval > 0.0f) {
-		for (int i = 0; i < gSpawnerCount; ++i) {
-			EnemySpawner *s = &gSpawners[i];
-			s->timer -= dt;
-			while (s->timer <= 0.0f) {
-				Vector2 spawnPos = (Vector2){
-				    s->pos.x + ((float)SQUARE_SIZE - kEnemyW) * 0.5f,
-				    s->pos.y + ((float)SQUARE_SIZE - kEnemyH)};
-				SpawnEnemy(spawnPos);
-				s->timer += kSpawnInterval;
-			}
+// Add the time since *t to *phase and restart the clock
+static void Lap(double *phase, double *t) {
+	double now = Stress_Now();
+	*phase += now - *t;
+	*t = now;
+}
+
+void Enemy_Update(World *w, float dt) {
+	EnemyPhaseTimes *profile = w->enemyProfile;
+	double t = profile ? Stress_Now() : 0.0;
+
+	// Fire the spawners and waves due this tick and queue their next firing
+	TimerEvent due[TIMER_WHEEL_MAX_EVENTS];
+	const int dueCount = TimerWheel_Advance(&w->timers, w->tick, due, TIMER_WHEEL_MAX_EVENTS);
+	for (int i = 0; i < dueCount; ++i) {
+		if (due[i].kind == TIMER_SPAWNER) {
+			EnemySpawner *s = &w->spawners[due[i].arg];
+			Enemy_Spawn(w, SpawnPosition(s->pos));
+			s->nextTick = w->tick + s->intervalTicks;
+			TimerWheel_Schedule(&w->timers, s->nextTick, TIMER_SPAWNER, due[i].arg);
+		} else {
+			EnemyWave *wave = &w->waves[due[i].arg];
+			for (int k = 0; k < wave->count; ++k) Enemy_Spawn(w, SpawnPosition(wave->pos));
+			if (wave->repeatTicks == 0) continue;
+			wave->nextTick = w->tick + wave->repeatTicks;
+			TimerWheel_Schedule(&w->timers, wave->nextTick, TIMER_WAVE, due[i].arg);
 		}
 	}
+	if (profile) Lap(&profile->spawn, &t);
 
-	// Update Enemies
-	for (int i = 0; i < MAX_ENEMIES; ++i) {
-		Enemy *e = &gEnemies[i];
+	// Update Enemies: one path table toward the player's segment serves all of them. Far enemies
+	// steer every 2 or 4 ticks and then catch up tick by tick, and stopped ones far away sleep.
+	const int playerSeg = w->nav ? PlayerSegment(w) : -1;
+	const Vector2 playerPos = w->game.playerPos;
+	float levelW = LevelPixelWidth(&w->level);
+	float levelH = LevelPixelHeight(&w->level);
+	bool *stepped = w->enemyScratch ? w->enemyScratch->stepped : NULL;
+	for (int i = 0; i < w->enemyCapacity; ++i) {
+		Enemy *e = &w->enemies[i];
+		stepped[i] = false;
 		if (!e->active) continue;
-		float playerMidX = game->playerPos.x;
-		float enemyMidX = e->pos.x + kEnemyW * 0.5f;
-		float dir = (playerMidX >= enemyMidX) ? 1.0f : -1.0f;
-		e->vel.x = dir * ROGUE_ENEMY_SPEED;
-		e->vel.y += GRAVITY * dt;
-		if (e->vel.y > ROGUE_ENEMY_MAX_FALL) e->vel.y = ROGUE_ENEMY_MAX_FALL;
+		float tiles = fmaxf(fabsf(e->pos.x - playerPos.x), fabsf(e->pos.y - playerPos.y)) / (float)SQUARE_SIZE;
+		if (e->asleep) {
+			if (tiles > (float)ENEMY_LOD_MID_TILES) continue;
+			e->asleep = false;
+			e->lastTick = w->tick - 1;
+		}
+		e->period = tiles <= (float)ENEMY_LOD_NEAR_TILES ? 1 : tiles <= (float)ENEMY_LOD_MID_TILES ? 2 : 4;
+		uint32_t ticks = w->tick - e->lastTick;
+		if (ticks < e->period) continue;
+		if (ticks > 4) ticks = 4;
+		const float stepDt = dt * (float)ticks;
+		e->lastTick = w->tick;
+		e->renderFrom = e->pos;
+		stepped[i] = true;
 
-		MoveEntity(&e->pos, &e->vel, kEnemyW, kEnemyH, dt, NULL, NULL, NULL, NULL);
+		if (w->nav) {
+			FollowNav(w, e, playerSeg, stepDt);
+		} else {
+			ChasePlayer(w, e);
+		}
+		// Steer once per period, but integrate every skipped tick so a long step can't tunnel
+		for (uint32_t k = 0; k < ticks; ++k) {
+			e->vel.y += GRAVITY * dt;
+			if (e->vel.y > ROGUE_ENEMY_MAX_FALL) e->vel.y = ROGUE_ENEMY_MAX_FALL;
+			MoveEntity(w, &e->pos, &e->vel, kEnemyW, kEnemyH, dt, NULL, NULL, NULL, NULL);
+		}
 
 		if (e->pos.x < 0.0f) {
 			e->pos.x = 0.0f;
 			e->vel.x = 0.0f;
 		}
-		if (e->pos.x > WINDOW_WIDTH - kEnemyW) {
-			e->pos.x = WINDOW_WIDTH - kEnemyW;
+		if (e->pos.x > levelW - kEnemyW) {
+			e->pos.x = levelW - kEnemyW;
 			e->vel.x = 0.0f;
 		}
-		if (e->pos.y > WINDOW_HEIGHT - kEnemyH) {
-			e->pos.y = WINDOW_HEIGHT - kEnemyH;
+		if (e->pos.y > levelH - kEnemyH) {
+			e->pos.y = levelH - kEnemyH;
 			e->vel.y = 0.0f;
 		}
 
-		if (e->pos.y > WINDOW_HEIGHT + kEnemyH * 2.0f) {
-			e->active = false;
+		if (e->pos.y > levelH + kEnemyH * 2.0f) {
+			Despawn(w, i);
 		}
+		bool still = fabsf(e->pos.x - e->renderFrom.x) < 0.01f && fabsf(e->pos.y - e->renderFrom.y) < 0.01f;
+		if (e->period == 4 && still && EnemyOnGround(w, e)) e->asleep = true;
 	}
-	ResolveEnemyEnemyCollisions();
-	HandleEnemyPlayerCollisions(game);
+	if (profile) Lap(&profile->integrate, &t);
+	ResolveEnemyEnemyCollisions(w);
+	if (profile) Lap(&profile->resolve, &t);
+	HandleEnemyPlayerCollisions(w);
+	if (profile) Lap(&profile->contacts, &t);
 }
 
-void Enemy_Render(void) {
-	for (int i = 0; i < MAX_ENEMIES; ++i) {
-		const Enemy *e = &gEnemies[i];
-		if (!e->active) continue;
-		Rectangle r = EnemyAABB(e);
+// Where to draw an enemy this frame; false when it is outside `view`
+static bool EnemyDrawRect(const World *w, const Enemy *e, Rectangle view, Rectangle *out) {
+	Rectangle r = EnemyAABB(e);
+	if (e->period > 1) {
+		// Ease across the interval a reduced-rate update covered instead of jumping
+		float t = (float)(w->tick - e->lastTick + 1) / (float)e->period;
+		if (t > 1.0f) t = 1.0f;
+		r.x = e->renderFrom.x + (e->pos.x - e->renderFrom.x) * t;
+		r.y = e->renderFrom.y + (e->pos.y - e->renderFrom.y) * t;
+	}
+	*out = r;
+	return CheckCollisionRecs(r, view);
+}
+
+int Enemy_CountVisible(const World *w, Rectangle view) {
+	int n = 0;
+	Rectangle r;
+	for (int i = 0; i < w->enemyCapacity; ++i)
+		if (w->enemies[i].active && EnemyDrawRect(w, &w->enemies[i], view, &r)) n++;
+	return n;
+}
+
+void Enemy_Render(const World *w) {
+	Rectangle view = Render_ViewRect(w->camera);
+	for (int i = 0; i < w->enemyCapacity; ++i) {
+		const Enemy *e = &w->enemies[i];
+		Rectangle r;
+		if (!e->active || !EnemyDrawRect(w, e, view, &r)) continue;
 		Color body = (Color){40, 40, 70, 255};
 		Color outline = (Color){15, 15, 25, 255};
 		DrawRectangleRounded(r, 0.3f, 6, body);
@@ -1,33 +1,61 @@
 #pragma once
+#include <stdint.h>
 #include "raylib.h"
 #include "game.h"
 
 // Constants
-#define MAX_SPAWNERS 64
-#define MAX_ENEMIES 128
+#define MAX_SPAWNERS 64 // the enemy pool itself is sized at run time (Enemy_SetCapacity)
 
 typedef struct EnemySpawner {
 	Vector2 pos;
-	float timer;
+	uint32_t intervalTicks; // 0: never fires
+	uint32_t nextTick; // World.tick of its next firing (pending in World.timers)
 } EnemySpawner;
 
+// Scripted burst from the level file: `count` enemies at once, once or every repeatTicks
+typedef struct EnemyWave {
+	Vector2 pos;
+	uint32_t startTicks; // first firing, from the start of the run
+	uint32_t repeatTicks; // 0: fires once
+	uint32_t nextTick; // a one-shot wave keeps its firing tick here once it has fired
+	uint16_t count;
+} EnemyWave;
+
 typedef struct Enemy {
 	Vector2 pos;
 	Vector2 vel;
 	bool active;
+	int navLink; // 1 + index of the EnemyNav link being followed (jump or walk-off), 0 when none
+	bool navAir; // has left the ground on navLink; the next landing ends it
+	uint32_t lastTick; // World.tick of its last update; far enemies update every 2 or 4 ticks
+	uint8_t period; // ticks between its updates at the current distance (1, 2 or 4)
+	bool asleep; // resting far from the player: skipped until the player comes within ENEMY_LOD_MID_TILES
+	Vector2 renderFrom; // pos before the last update; rendering eases from it to pos over `period` ticks
 } Enemy;
 
-// Global enemy state (exposed for rendering/collision if needed, or keep hidden and expose functions)
-// For now, let's expose functions to manage them.
-// But game.c needs to iterate them for collision? Or we move collision logic here?
-// Plan said: "Move Rogue_UpdateEnemies, Rogue_RenderEnemies, Rogue_SpawnEnemy".
-// Collision with player is in `Rogue_HandleEnemyPlayerCollisions`. We should move that too or expose enemies.
-// Let's expose the arrays for now to minimize friction, or better, keep them static in enemy.c and provide accessors.
-// Given the time, let's keep them static in enemy.c and provide `Enemy_GetActive` or similar if needed,
-// OR just move the collision logic to `enemy.c` as `Enemy_HandlePlayerCollision(GameState* g)`.
+// Seconds spent in each phase of Enemy_Update, summed over the ticks profiled (--stress)
+typedef struct EnemyPhaseTimes {
+	double spawn; // timer wheel firings
+	double integrate; // steering, gravity and tile collision
+	double resolve; // enemy-enemy overlaps
+	double contacts; // stomps and hits against the player
+} EnemyPhaseTimes;
+
+// Spawner and enemy arrays live in the World; these functions operate on the world passed in.
+struct World;
 
-void Enemy_Init(void);
-void Enemy_Clear(void);
-void Enemy_BuildFromLevel(const struct LevelEditorState *level);
-void Enemy_Update(struct GameState *game, float dt);
-void Enemy_Render(void);
+// Resize the enemy pool (emptying it); false when out of memory, leaving the pool as it was.
+// Capacity 0 releases it. Enemy_Clear allocates ENEMY_DEFAULT_CAPACITY slots if none exist yet.
+bool Enemy_SetCapacity(struct World *w, int capacity);
+void Enemy_Free(struct World *w);
+void Enemy_Clear(struct World *w);
+void Enemy_BuildFromLevel(struct World *w);
+// Put every spawner and wave on World.timers at its nextTick (after those were set or carried over);
+// one-shot waves that already fired stay off
+void Enemy_ScheduleTimers(struct World *w);
+// Place an enemy at `pos` (top-left); false when the pool is full or the spot is inside a wall
+bool Enemy_Spawn(struct World *w, Vector2 pos);
+void Enemy_Update(struct World *w, float dt);
+void Enemy_Render(const struct World *w);
+// The culling and interpolation half of Enemy_Render without drawing: enemies inside `view`
+int Enemy_CountVisible(const struct World *w, Rectangle view);
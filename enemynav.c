@@ -0,0 +1,330 @@
+#include "enemynav.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "physics.h"
+#include "world.h"
+
+// A segment is a maximal run of standing cells in one row: free cells with a solid cell (or the
+// level's bottom edge) under them. The enemy fits in one cell, so any standing cell holds it.
+typedef struct NavSegment {
+	int row, x0, x1;
+} NavSegment;
+
+typedef struct NavTable {
+	int target; // -1: unused slot
+	uint32_t lastUse;
+	int32_t *next; // per segment: link index toward target, -1 at the target or when unreachable
+} NavTable;
+
+struct EnemyNav {
+	int cols, rows;
+	int32_t *below; // per cell: EnemyNav_SegmentBelow
+	NavSegment *segs;
+	int segCount;
+	NavLink *links;
+	int linkCount;
+	int32_t *inStart, *inLinks; // links grouped by destination segment (CSR), for the reverse search
+	NavTable tables[ENEMY_NAV_CACHED_TABLES];
+	uint32_t useClock;
+	float *dist; // search scratch, segCount each
+	int32_t *heap;
+	int32_t *heapPos;
+};
+
+static bool Solid(const World *w, int cx, int cy) { return Physics_BlockAtCell(w, cx, cy); }
+
+static bool Standing(const World *w, int cx, int cy) { return !Solid(w, cx, cy) && Solid(w, cx, cy + 1); }
+
+// Rows the enemy's feet can rise while a jump still has height to spare
+static int JumpRows(void) {
+	float apex = ROGUE_ENEMY_JUMP_SPEED * ROGUE_ENEMY_JUMP_SPEED / (2.0f * GRAVITY);
+	return (int)((apex - 4.0f) / (float)SQUARE_SIZE);
+}
+
+// Cells the enemy can cross after rising `rows`: its time above that height at full speed
+static int JumpReach(int rows) {
+	float apex = ROGUE_ENEMY_JUMP_SPEED * ROGUE_ENEMY_JUMP_SPEED / (2.0f * GRAVITY);
+	float spare = apex - (float)(rows * SQUARE_SIZE);
+	if (spare <= 0.0f) return 0;
+	float airTime = 2.0f * sqrtf(2.0f * spare / GRAVITY);
+	// Reaching dx cells means moving until the body overlaps the landing cell
+	float px = ROGUE_ENEMY_SPEED * airTime + (float)SQUARE_SIZE * 0.5f + ROGUE_ENEMY_W * 0.5f - 2.0f;
+	return (int)(px / (float)SQUARE_SIZE);
+}
+
+static float SegMid(const NavSegment *s) { return 0.5f * (float)(s->x0 + s->x1); }
+
+typedef struct LinkBuilder {
+	NavLink *links;
+	int count, cap;
+	int32_t *best; // per segment: index of the cheapest link from the current segment to it, or -1
+} LinkBuilder;
+
+static bool AddLink(LinkBuilder *lb, const EnemyNav *nav, NavLink l) {
+	const NavSegment *a = &nav->segs[l.from], *b = &nav->segs[l.to];
+	l.cost += fabsf((float)l.takeoffX - SegMid(a)) + fabsf((float)l.landX - SegMid(b)) + 1.0f;
+	int prev = lb->best[l.to];
+	if (prev >= 0) {
+		if (l.cost < lb->links[prev].cost) lb->links[prev] = l;
+		return true;
+	}
+	if (lb->count == lb->cap) {
+		int cap = lb->cap ? lb->cap * 2 : 256;
+		NavLink *grown = realloc(lb->links, (size_t)cap * sizeof(NavLink));
+		if (!grown) return false;
+		lb->links = grown;
+		lb->cap = cap;
+	}
+	lb->best[l.to] = lb->count;
+	lb->links[lb->count++] = l;
+	return true;
+}
+
+// Walk off the end of segment `s` in direction `dir` and fall to the first standing cell
+static bool AddDrop(LinkBuilder *lb, const EnemyNav *nav, const World *w, int s, int dir) {
+	const NavSegment *seg = &nav->segs[s];
+	int edge = dir < 0 ? seg->x0 : seg->x1;
+	int cx = edge + dir;
+	if (cx < 0 || cx >= nav->cols || Solid(w, cx, seg->row)) return true;
+	int to = nav->below[(size_t)seg->row * nav->cols + cx];
+	if (to < 0 || to == s) return true;
+	int landRow = nav->segs[to].row;
+	NavLink l = {s, to, NAV_LINK_DROP, edge, cx, landRow, 0.5f * (float)(landRow - seg->row)};
+	return AddLink(lb, nav, l);
+}
+
+// Jumps from each cell of segment `s`: rise in place, then cross along the landing row to the
+// nearest standing cell of another segment
+static bool AddJumps(LinkBuilder *lb, const EnemyNav *nav, const World *w, int s) {
+	const NavSegment *seg = &nav->segs[s];
+	const int maxRows = JumpRows();
+	for (int x = seg->x0; x <= seg->x1; ++x) {
+		for (int up = 0; up <= maxRows && up <= seg->row; ++up) {
+			int row = seg->row - up;
+			if (up > 0 && Solid(w, x, row)) break; // head room above the takeoff cell runs out
+			int reach = JumpReach(up);
+			for (int dir = -1; dir <= 1; dir += 2) {
+				if (up == 0 && x != (dir < 0 ? seg->x0 : seg->x1)) continue; // level gaps: from the ends only
+				for (int dx = 1; dx <= reach; ++dx) {
+					int cx = x + dir * dx;
+					if (cx < 0 || cx >= nav->cols || Solid(w, cx, row)) break;
+					if (!Standing(w, cx, row)) continue;
+					int to = nav->below[(size_t)row * nav->cols + cx];
+					if (to != s) {
+						NavLink l = {s, to, NAV_LINK_JUMP, x, cx, row, (float)(dx + up)};
+						if (!AddLink(lb, nav, l)) return false;
+					}
+					break;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static bool BuildLinks(EnemyNav *nav, const World *w) {
+	LinkBuilder lb = {NULL, 0, 0, malloc((size_t)nav->segCount * sizeof(int32_t))};
+	if (!lb.best) return false;
+	memset(lb.best, 0xff, (size_t)nav->segCount * sizeof(int32_t));
+	bool ok = true;
+	for (int s = 0; s < nav->segCount && ok; ++s) {
+		int first = lb.count;
+		ok = AddDrop(&lb, nav, w, s, -1) && AddDrop(&lb, nav, w, s, 1) && AddJumps(&lb, nav, w, s);
+		for (int i = first; i < lb.count; ++i) lb.best[lb.links[i].to] = -1;
+	}
+	free(lb.best);
+	nav->links = lb.links;
+	nav->linkCount = lb.count;
+	if (!ok) return false;
+
+	nav->inStart = calloc((size_t)nav->segCount + 1, sizeof(int32_t));
+	nav->inLinks = malloc(((size_t)nav->linkCount + 1) * sizeof(int32_t));
+	if (!nav->inStart || !nav->inLinks) return false;
+	for (int i = 0; i < nav->linkCount; ++i) nav->inStart[nav->links[i].to + 1]++;
+	for (int s = 0; s < nav->segCount; ++s) nav->inStart[s + 1] += nav->inStart[s];
+	int32_t *fill = nav->heap; // search scratch, free until the first table is computed
+	memcpy(fill, nav->inStart, (size_t)nav->segCount * sizeof(int32_t));
+	for (int i = 0; i < nav->linkCount; ++i) nav->inLinks[fill[nav->links[i].to]++] = i;
+	return true;
+}
+
+static void Destroy(EnemyNav *nav) {
+	if (!nav) return;
+	for (int i = 0; i < ENEMY_NAV_CACHED_TABLES; ++i) free(nav->tables[i].next);
+	free(nav->below);
+	free(nav->segs);
+	free(nav->links);
+	free(nav->inStart);
+	free(nav->inLinks);
+	free(nav->dist);
+	free(nav->heap);
+	free(nav->heapPos);
+	free(nav);
+}
+
+static EnemyNav *Build(const World *w) {
+	const LevelEditorState *level = &w->level;
+	if (level->stream || level->cols <= 0 || level->rows <= 0) return NULL;
+	EnemyNav *nav = calloc(1, sizeof(EnemyNav));
+	if (!nav) return NULL;
+	nav->cols = level->cols;
+	nav->rows = level->rows;
+	const size_t cells = (size_t)nav->cols * nav->rows;
+	nav->below = malloc(cells * sizeof(int32_t));
+	int segCap = 64;
+	nav->segs = malloc((size_t)segCap * sizeof(NavSegment));
+	if (!nav->below || !nav->segs) {
+		Destroy(nav);
+		return NULL;
+	}
+
+	// Segments, row-major; `below` first holds each standing cell's own segment
+	for (int y = 0; y < nav->rows; ++y) {
+		for (int x = 0; x < nav->cols; ++x) {
+			int32_t *cell = &nav->below[(size_t)y * nav->cols + x];
+			*cell = -1;
+			if (!Standing(w, x, y)) continue;
+			if (x > 0 && nav->below[(size_t)y * nav->cols + x - 1] >= 0) {
+				*cell = nav->below[(size_t)y * nav->cols + x - 1];
+				nav->segs[*cell].x1 = x;
+				continue;
+			}
+			if (nav->segCount == segCap) {
+				segCap *= 2;
+				NavSegment *grown = realloc(nav->segs, (size_t)segCap * sizeof(NavSegment));
+				if (!grown) {
+					Destroy(nav);
+					return NULL;
+				}
+				nav->segs = grown;
+			}
+			*cell = nav->segCount;
+			nav->segs[nav->segCount++] = (NavSegment){y, x, x};
+		}
+	}
+	// Then free cells inherit the segment they would fall onto
+	for (int y = nav->rows - 2; y >= 0; --y)
+		for (int x = 0; x < nav->cols; ++x) {
+			int32_t *cell = &nav->below[(size_t)y * nav->cols + x];
+			if (*cell < 0 && !Solid(w, x, y)) *cell = nav->below[(size_t)(y + 1) * nav->cols + x];
+		}
+
+	size_t n = nav->segCount > 0 ? (size_t)nav->segCount : 1;
+	nav->dist = malloc(n * sizeof(float));
+	nav->heap = malloc(n * sizeof(int32_t));
+	nav->heapPos = malloc(n * sizeof(int32_t));
+	if (!nav->dist || !nav->heap || !nav->heapPos || !BuildLinks(nav, w)) {
+		Destroy(nav);
+		return NULL;
+	}
+	for (int i = 0; i < ENEMY_NAV_CACHED_TABLES; ++i) nav->tables[i].target = -1;
+	return nav;
+}
+
+void EnemyNav_Rebuild(World *w) {
+	Destroy(w->nav);
+	w->nav = Build(w);
+}
+
+void EnemyNav_Free(World *w) {
+	Destroy(w->nav);
+	w->nav = NULL;
+}
+
+int EnemyNav_SegmentBelow(const EnemyNav *nav, int cx, int cy) {
+	if (!nav || cx < 0 || cy < 0 || cx >= nav->cols || cy >= nav->rows) return -1;
+	return nav->below[(size_t)cy * nav->cols + cx];
+}
+
+const NavLink *EnemyNav_Link(const EnemyNav *nav, int index) { return &nav->links[index]; }
+
+// Binary min-heap of segments keyed by nav->dist (ties broken by index, so results never depend
+// on insertion order)
+static bool HeapLess(const EnemyNav *nav, int a, int b) {
+	return nav->dist[a] < nav->dist[b] || (nav->dist[a] == nav->dist[b] && a < b);
+}
+
+static void HeapSwap(EnemyNav *nav, int i, int j) {
+	int32_t t = nav->heap[i];
+	nav->heap[i] = nav->heap[j];
+	nav->heap[j] = t;
+	nav->heapPos[nav->heap[i]] = i;
+	nav->heapPos[nav->heap[j]] = j;
+}
+
+static void HeapUp(EnemyNav *nav, int i) {
+	while (i > 0 && HeapLess(nav, nav->heap[i], nav->heap[(i - 1) / 2])) {
+		HeapSwap(nav, i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+static void HeapDown(EnemyNav *nav, int i, int size) {
+	for (;;) {
+		int l = 2 * i + 1, r = l + 1, m = i;
+		if (l < size && HeapLess(nav, nav->heap[l], nav->heap[m])) m = l;
+		if (r < size && HeapLess(nav, nav->heap[r], nav->heap[m])) m = r;
+		if (m == i) return;
+		HeapSwap(nav, i, m);
+		i = m;
+	}
+}
+
+// Dijkstra from `target` over the links reversed: next[s] is the first link of a cheapest path
+static void FillTable(EnemyNav *nav, int target, int32_t *next) {
+	const float unreached = INFINITY;
+	for (int s = 0; s < nav->segCount; ++s) {
+		nav->dist[s] = unreached;
+		nav->heapPos[s] = -1;
+		next[s] = -1;
+	}
+	nav->dist[target] = 0.0f;
+	nav->heap[0] = target;
+	nav->heapPos[target] = 0;
+	int size = 1;
+	while (size > 0) {
+		int b = nav->heap[0];
+		HeapSwap(nav, 0, --size);
+		HeapDown(nav, 0, size);
+		nav->heapPos[b] = -2; // settled
+		for (int k = nav->inStart[b]; k < nav->inStart[b + 1]; ++k) {
+			const NavLink *l = &nav->links[nav->inLinks[k]];
+			float d = nav->dist[b] + l->cost;
+			if (nav->heapPos[l->from] == -2 || d >= nav->dist[l->from]) continue;
+			nav->dist[l->from] = d;
+			next[l->from] = nav->inLinks[k];
+			if (nav->heapPos[l->from] < 0) {
+				nav->heap[size] = l->from;
+				nav->heapPos[l->from] = size++;
+			}
+			HeapUp(nav, nav->heapPos[l->from]);
+		}
+	}
+}
+
+static const int32_t *TableToward(EnemyNav *nav, int target) {
+	NavTable *slot = &nav->tables[0];
+	for (int i = 0; i < ENEMY_NAV_CACHED_TABLES; ++i) {
+		NavTable *t = &nav->tables[i];
+		if (t->target == target) {
+			t->lastUse = ++nav->useClock;
+			return t->next;
+		}
+		if (t->target < 0 || t->lastUse < slot->lastUse) slot = t; // empty slots have lastUse 0
+	}
+	if (!slot->next) slot->next = malloc((size_t)(nav->segCount > 0 ? nav->segCount : 1) * sizeof(int32_t));
+	if (!slot->next) return NULL;
+	FillTable(nav, target, slot->next);
+	slot->target = target;
+	slot->lastUse = ++nav->useClock;
+	return slot->next;
+}
+
+int EnemyNav_NextLink(EnemyNav *nav, int from, int target) {
+	if (!nav || from < 0 || target < 0 || from >= nav->segCount || target >= nav->segCount || from == target) return -1;
+	const int32_t *next = TableToward(nav, target);
+	return next ? next[from] : -1;
+}
@@ -0,0 +1,34 @@
+// Enemy navigation: the level's walkable platform segments, joined by walk-off and jump links that
+// fit the enemy's speed and jump, plus shared tables of the next link toward a target segment
+#pragma once
+#include <stdbool.h>
+
+struct World;
+typedef struct EnemyNav EnemyNav;
+
+typedef enum NavLinkKind {
+	NAV_LINK_DROP, // walk off the end of `from` and fall down the next column
+	NAV_LINK_JUMP, // jump straight up from takeoffX, then move across onto `to`
+} NavLinkKind;
+
+typedef struct NavLink {
+	int from, to; // segments
+	NavLinkKind kind;
+	int takeoffX; // cell of `from` to leave from
+	int landX, landRow; // standing cell of `to` the link arrives at
+	float cost; // cells walked and flown, plus a small charge per link
+} NavLink;
+
+// Game_OnLevelLoaded: build w->nav from w->level. Streamed levels get none (their tiles are not all
+// in memory), and enemies there chase the player directly.
+void EnemyNav_Rebuild(struct World *w);
+void EnemyNav_Free(struct World *w);
+
+// Segment whose standing cell is (cx, cy) or the first one below it with nothing solid in between;
+// -1 for solid or out-of-bounds cells
+int EnemyNav_SegmentBelow(const EnemyNav *nav, int cx, int cy);
+// Index of the next link on a shortest path from segment `from` to `target`, or -1 when they are the
+// same segment or `target` cannot be reached. The table toward `target` is computed on first use
+// and cached, so every enemy chasing the same segment shares it.
+int EnemyNav_NextLink(EnemyNav *nav, int from, int target);
+const NavLink *EnemyNav_Link(const EnemyNav *nav, int index);
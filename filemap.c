@@ -0,0 +1,73 @@
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#define _POSIX_C_SOURCE 200809L
+#define FILEMAP_USE_MMAP 1
+#endif
+#include "filemap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef FILEMAP_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool ReadWhole(FileMap *fm, const char *path) {
+	FILE *f = fopen(path, "rb");
+	if (!f) return false;
+	long len = -1;
+	if (fseek(f, 0, SEEK_END) == 0) len = ftell(f);
+	if (len < 0 || fseek(f, 0, SEEK_SET) != 0) {
+		fclose(f);
+		return false;
+	}
+	unsigned char *buf = malloc(len > 0 ? (size_t)len : 1);
+	if (!buf) {
+		fclose(f);
+		return false;
+	}
+	if (fread(buf, 1, (size_t)len, f) != (size_t)len) {
+		free(buf);
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+	fm->data = buf;
+	fm->size = (size_t)len;
+	fm->heap = buf;
+	return true;
+}
+
+bool FileMap_Open(FileMap *fm, const char *path) {
+	memset(fm, 0, sizeof(*fm));
+#ifdef FILEMAP_USE_MMAP
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return false;
+	}
+	if (st.st_size > 0) {
+		void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			close(fd); // the mapping keeps the file alive
+			fm->data = p;
+			fm->size = (size_t)st.st_size;
+			fm->mapped = true;
+			return true;
+		}
+	}
+	close(fd);
+#endif
+	return ReadWhole(fm, path);
+}
+
+void FileMap_Close(FileMap *fm) {
+#ifdef FILEMAP_USE_MMAP
+	if (fm->mapped) munmap((void *)fm->data, fm->size);
+#endif
+	free(fm->heap);
+	memset(fm, 0, sizeof(*fm));
+}
@@ -0,0 +1,14 @@
+// Read-only view of a whole file: mmap on desktop POSIX, a single read elsewhere
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct FileMap {
+	const unsigned char *data;
+	size_t size;
+	void *heap; // owned buffer when the file was read instead of mapped
+	bool mapped;
+} FileMap;
+
+bool FileMap_Open(FileMap *fm, const char *path); // false if missing/unreadable (fm is zeroed)
+void FileMap_Close(FileMap *fm);
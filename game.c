@@ -1,7 +1,9 @@
 #include "game.h"
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 #include "audio.h"
+#include "chunkstream.h"
 #include "input_config.h"
 #include "level.h"
 #include "render.h"
@@ -9,66 +11,67 @@
 #include "physics.h"
 #include "player.h"
 #include "enemy.h"
+#include "enemynav.h"
+#include "rng.h"
+#include "world.h"
 
-static bool victory = false;
-static bool death = false;
-static float deathAnimTimer = 0.0f;
-
-static const struct LevelEditorState *gLevel = NULL;
 static const float kDeathAnimDuration = 0.7f;
 
-void Game_TriggerDeath(GameState *game) {
-	if (death) return;
-	death = true;
-	deathAnimTimer = kDeathAnimDuration;
+void Game_TriggerDeath(World *w) {
+	if (w->death) return;
+	GameState *game = &w->game;
+	w->death = true;
+	w->deathAnimTimer = kDeathAnimDuration;
 	game->spriteRotation = 0.0f;
 	game->hidden = false;
 	game->hurtTimer = 0.0f;
 	game->crouchAnimTime = 0.0f;
 	game->crouchAnimDir = 0;
-	Audio_PlayDeath();
-	Render_SpawnDeathExplosion(game);
+	if (!w->headless) Audio_PlayDeath();
+	Render_SpawnDeathExplosion(w);
 }
 
-void UpdateGame(GameState *game, const struct LevelEditorState *level, float dt) {
-	gLevel = level;
-	Physics_SetLevel(level); // Update physics level reference
+void UpdateGame(World *w, float dt) {
+	GameState *game = &w->game;
+	w->tick++;
 
-	if (death) {
-		if (deathAnimTimer > 0.0f) {
-			deathAnimTimer -= dt;
-			float t = 1.0f - (deathAnimTimer / kDeathAnimDuration);
+	if (w->death) {
+		if (w->deathAnimTimer > 0.0f) {
+			w->deathAnimTimer -= dt;
+			float t = 1.0f - (w->deathAnimTimer / kDeathAnimDuration);
 			if (t < 0.0f) t = 0.0f;
 			if (t > 1.0f) t = 1.0f;
 			game->spriteRotation = 90.0f * t;
 			// Drift with momentum and gravity
 			game->playerVel.y += GRAVITY * GRAVITY_FALL_MULT * dt;
-			if (deathAnimTimer < 0.2f) game->hidden = true;
-			if (deathAnimTimer < 0.0f) deathAnimTimer = 0.0f;
+			if (w->deathAnimTimer < 0.2f) game->hidden = true;
+			if (w->deathAnimTimer < 0.0f) w->deathAnimTimer = 0.0f;
 		}
 		float aabbW = 0.0f, aabbH = 0.0f;
-		Game_CurrentAABBDims(game, &aabbW, &aabbH);
+		Game_CurrentAABBDims(w, &aabbW, &aabbH);
 		Vector2 pPos = game->playerPos;
-		MoveEntity(&pPos, &game->playerVel, aabbW, aabbH, dt, NULL, NULL, NULL, NULL);
-		PushEntityOutOfSolids(&pPos, &game->playerVel, aabbW, aabbH);
+		MoveEntity(w, &pPos, &game->playerVel, aabbW, aabbH, dt, NULL, NULL, NULL, NULL);
+		PushEntityOutOfSolids(w, &pPos, &game->playerVel, aabbW, aabbH);
 		
 		float halfW = aabbW * 0.5f;
 		float halfH = aabbH * 0.5f;
+		float levelW = LevelPixelWidth(&w->level);
+		float levelH = LevelPixelHeight(&w->level);
 		
 		if (pPos.x < halfW) {
 			pPos.x = halfW;
 			game->playerVel.x = 0.0f;
 		}
-		if (pPos.x > WINDOW_WIDTH - halfW) {
-			pPos.x = WINDOW_WIDTH - halfW;
+		if (pPos.x > levelW - halfW) {
+			pPos.x = levelW - halfW;
 			game->playerVel.x = 0.0f;
 		}
 		if (pPos.y < halfH) {
 			pPos.y = halfH;
 			game->playerVel.y = 0.0f;
 		}
-		if (pPos.y > WINDOW_HEIGHT - halfH) {
-			pPos.y = WINDOW_HEIGHT - halfH;
+		if (pPos.y > levelH - halfH) {
+			pPos.y = levelH - halfH;
 			game->playerVel.y = 0.0f;
 			game->onGround = true;
 		}
@@ -76,71 +79,175 @@ void UpdateGame(GameState *game, const struct LevelEditorState *level, float dt)
 		game->playerPos.y = pPos.y;
 		return;
 	}
-	if (victory) return;
-	if (InputGate_BeginFrameBlocked()) return;
+	if (w->victory) return;
 
-	UpdatePlayer(game, dt);
-	Enemy_Update(game, dt);
+	UpdatePlayer(w, dt);
+	Enemy_Update(w, dt);
 
-	if (death) return;
+	if (w->death) return;
 
-	if (CheckCollisionRecs(PlayerAABB(game), ExitAABB(game))) {
-		victory = true;
+	if (CheckCollisionRecs(PlayerAABB(w), ExitAABB(game))) {
+		w->victory = true;
 		game->score = (int)(game->runTime * 1000.0f);
-		Audio_PlayVictory();
+		if (!w->headless) Audio_PlayVictory();
 	}
-	
-	// Hazard check
-	// We need to access IsHazardTile.
-	// PlayerTouchesHazard was static.
-	// Let's implement it here or move to player.c?
-	// It depends on `gLevel`.
-	// Let's implement it here using `gLevel`.
-	Rectangle pb = PlayerAABB(game);
-	for (int y = 0; y < GRID_ROWS; ++y)
-		for (int x = 0; x < GRID_COLS; ++x) {
-			TileType t = gLevel->tiles[y][x];
-			if (!IsHazardTile(t)) continue;
+
+	// Hazard check: a laser never leaves its cell, so only the cells under the player matter
+	Rectangle pb = PlayerAABB(w);
+	int x0 = WorldToCellX(pb.x), x1 = WorldToCellX(pb.x + pb.width);
+	int y0 = WorldToCellY(pb.y), y1 = WorldToCellY(pb.y + pb.height);
+	for (int y = y0; y <= y1; ++y)
+		for (int x = x0; x <= x1; ++x) {
+			if (!InBoundsCell(&w->level, x, y)) continue;
+			if (!IsHazardTile(LevelTile(&w->level, x, y))) continue;
 			Vector2 lp = (Vector2){CellToWorld(x), CellToWorld(y)};
-			Rectangle lr = LaserCollisionRect(lp);
-			if (CheckCollisionRecs(pb, lr)) {
-				Game_TriggerDeath(game);
+			if (CheckCollisionRecs(pb, LaserCollisionRect(lp))) {
+				Game_TriggerDeath(w);
+				return;
+			}
+		}
+}
+
+void Game_OnLevelLoaded(World *w) {
+	// Reseed so every attempt at a level replays the same random sequence
+	Rng_SeedAll(&w->rng, RNG_DEFAULT_SEED);
+	w->tick = 0;
+	Enemy_BuildFromLevel(w);
+	EnemyNav_Rebuild(w);
+}
+
+bool Game_ReplaceLevel(World *w, LevelEditorState *fresh, const GameState *file) {
+	EnemySpawner oldSpawners[MAX_SPAWNERS];
+	EnemyWave oldWaves[LEVEL_MAX_WAVES];
+	const int oldSpawnerCount = w->spawnerCount, oldWaveCount = w->waveCount;
+	memcpy(oldSpawners, w->spawners, sizeof(oldSpawners));
+	memcpy(oldWaves, w->waves, sizeof(oldWaves));
+	// Out of memory: the enemies are dropped instead of kept
+	const size_t enemyBytes = (size_t)w->enemyCapacity * sizeof(Enemy);
+	Enemy *oldEnemies = enemyBytes > 0 ? malloc(enemyBytes) : NULL;
+	if (oldEnemies) memcpy(oldEnemies, w->enemies, enemyBytes);
+
+	LevelEditorState *level = &w->level;
+	fresh->cursor = level->cursor;
+	fresh->tool = level->tool;
+	fresh->journal = level->journal;
+	fresh->history = level->history;
+	fresh->revision = level->revision + 1;
+	level->journal = NULL;
+	level->history = NULL;
+	Level_Free(level);
+	*level = *fresh;
+	memset(fresh, 0, sizeof(*fresh));
+
+	GameState *game = &w->game;
+	game->exitPos = file->exitPos;
+	if (level->stream) ChunkStream_Update(level->stream, game->playerPos);
+	Rectangle pb = PlayerAABB(w);
+	const bool keptPlayer = !AABBOverlapsSolid(w, pb.x, pb.y, pb.width, pb.height);
+	if (!keptPlayer) {
+		// Walled in by the edit: back to the file's start, standing still
+		game->playerPos = file->playerPos;
+		game->playerVel = (Vector2){0, 0};
+		game->onGround = false;
+		game->crouching = false;
+		game->edgeHang = false;
+		game->edgeHangDir = 0;
+		game->wallSliding = false;
+		Game_ResetVisuals(game);
+		if (level->stream) ChunkStream_Update(level->stream, game->playerPos);
+	}
+
+	// Spawners and waves that did not change keep their next firing (a spent one-shot wave stays
+	// spent), and enemies stay unless now inside a wall and plan again on the new navigation graph
+	Enemy_BuildFromLevel(w);
+	EnemyNav_Rebuild(w);
+	for (int i = 0; i < w->spawnerCount; ++i)
+		for (int j = 0; j < oldSpawnerCount; ++j)
+			if (oldSpawners[j].pos.x == w->spawners[i].pos.x && oldSpawners[j].pos.y == w->spawners[i].pos.y) {
+				w->spawners[i].nextTick = oldSpawners[j].nextTick;
 				break;
 			}
+	bool waveTaken[LEVEL_MAX_WAVES] = {false};
+	for (int i = 0; i < w->waveCount; ++i) {
+		EnemyWave *wave = &w->waves[i];
+		for (int j = 0; j < oldWaveCount; ++j) {
+			const EnemyWave *old = &oldWaves[j];
+			if (waveTaken[j] || old->pos.x != wave->pos.x || old->pos.y != wave->pos.y || old->startTicks != wave->startTicks ||
+			    old->repeatTicks != wave->repeatTicks)
+				continue;
+			wave->nextTick = old->nextTick;
+			waveTaken[j] = true;
+			break;
 		}
+	}
+	Enemy_ScheduleTimers(w);
+	for (int i = 0; oldEnemies && i < w->enemyCapacity; ++i) {
+		const Enemy *e = &oldEnemies[i];
+		if (!e->active || AABBOverlapsSolid(w, e->pos.x, e->pos.y, ROGUE_ENEMY_W, ROGUE_ENEMY_H)) continue;
+		w->enemies[i] = *e;
+		w->enemies[i].navLink = 0;
+		w->enemies[i].navAir = false;
+		w->enemies[i].asleep = false;
+	}
+	free(oldEnemies);
+	return keptPlayer;
+}
+
+// Every simulation field of the player except the spawn and exit, which come from the level. A
+// run must not inherit movement state from the previous one, or replays could not reproduce it.
+static void ResetPlayerState(GameState *game) {
+	game->score = 0;
+	game->runTime = 0.0f;
+	game->playerVel = (Vector2){0, 0};
+	game->onGround = false;
+	game->coyoteTimer = 0.0f;
+	game->jumpBufferTimer = 0.0f;
+	game->crouching = false;
+	game->groundStickTimer = 0.0f;
+	game->facingRight = true;
+	game->jumpPrevDown = false;
+	game->wallCoyoteTimer = 0.0f;
+	game->wallCoyoteDir = 0;
+	game->wallSliding = false;
+	Game_ResetVisuals(game);
 }
 
-void Game_OnLevelLoaded(GameState *game, const struct LevelEditorState *level) {
-	Enemy_BuildFromLevel(level);
+void Game_StartRun(World *w) {
+	ResetPlayerState(&w->game);
+	Game_ClearOutcome(w);
+	Game_OnLevelLoaded(w);
 }
 
-void RenderGame(const GameState *game, const struct LevelEditorState *level, float dt) {
-	gLevel = level;
-	RenderTilesGameplay(level, game);
-	Enemy_Render();
-	Render_DrawDust(dt);
-	RenderPlayer(game);
+void RenderGame(World *w, float dt) {
+	const GameState *game = &w->game;
+	Render_FollowCamera(w, game->playerPos);
+	BeginMode2D(w->camera);
+	RenderTilesGameplay(w);
+	Enemy_Render(w);
+	Render_DrawDust(w, dt);
+	RenderPlayer(w);
 	DrawRectangleRec(ExitAABB(game), GREEN);
+	EndMode2D();
 #if DEBUG_DRAW_BOUNDS
 	DrawStats(game);
 #endif
 }
 
-bool Game_Victory(void) { return victory; }
-bool Game_Death(void) { return death && deathAnimTimer <= 0.0f; }
-bool Game_IsDying(void) { return death; }
-float Game_DeathProgress(void) {
-	if (!death || kDeathAnimDuration <= 0.0f) return 0.0f;
-	float t = 1.0f - (deathAnimTimer / kDeathAnimDuration);
+bool Game_Victory(const World *w) { return w->victory; }
+bool Game_Death(const World *w) { return w->death && w->deathAnimTimer <= 0.0f; }
+bool Game_IsDying(const World *w) { return w->death; }
+float Game_DeathProgress(const World *w) {
+	if (!w->death || kDeathAnimDuration <= 0.0f) return 0.0f;
+	float t = 1.0f - (w->deathAnimTimer / kDeathAnimDuration);
 	if (t < 0.0f) t = 0.0f;
 	if (t > 1.0f) t = 1.0f;
 	return t;
 }
-void Game_ClearOutcome(void) {
-	victory = false;
-	death = false;
-	deathAnimTimer = 0.0f;
-	Enemy_Clear();
+void Game_ClearOutcome(World *w) {
+	w->victory = false;
+	w->death = false;
+	w->deathAnimTimer = 0.0f;
+	Enemy_Clear(w);
 }
 
 // Reset transient render flags on respawn
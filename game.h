@@ -39,17 +39,24 @@ typedef struct GameState {
 	float invincibilityTimer;
 } GameState;
 
+struct World;
 struct LevelEditorState;
 
-void UpdateGame(GameState *game, const struct LevelEditorState *level, float dt);
-void RenderGame(const GameState *game, const struct LevelEditorState *level, float dt);
-void Game_OnLevelLoaded(GameState *game, const struct LevelEditorState *level);
+void UpdateGame(struct World *w, float dt);
+void RenderGame(struct World *w, float dt);
+void Game_OnLevelLoaded(struct World *w);
+void Game_StartRun(struct World *w); // fresh run on the loaded level: player state, clock, outcome, enemies, RNG, tick
+void Game_TriggerDeath(struct World *w);
+// Swap in a reloaded copy of the level mid-run (ownership of *fresh moves to the world). The player
+// and enemies stay where they are unless the new tiles overlap them; the player then goes back to
+// file->playerPos. Returns true when the player kept its position.
+bool Game_ReplaceLevel(struct World *w, struct LevelEditorState *fresh, const GameState *file);
 
 // Outcome flags
-bool Game_Victory(void);
-bool Game_Death(void);
-bool Game_IsDying(void);
-float Game_DeathProgress(void); // 0..1 over death animation duration
-void Game_CurrentAABBDims(const GameState *g, float *outW, float *outH);
-void Game_ClearOutcome(void);
+bool Game_Victory(const struct World *w);
+bool Game_Death(const struct World *w);
+bool Game_IsDying(const struct World *w);
+float Game_DeathProgress(const struct World *w); // 0..1 over death animation duration
+void Game_CurrentAABBDims(const struct World *w, float *outW, float *outH);
+void Game_ClearOutcome(struct World *w);
 void Game_ResetVisuals(GameState *game);
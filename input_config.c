@@ -115,6 +115,7 @@ static void LoadDefaults(void) {
 	AddKey(ACT_JUMP, KEY_SPACE);
 	AddKey(ACT_JUMP, KEY_W);
 	AddKey(ACT_JUMP, KEY_UP);
+	AddKey(ACT_REWIND, KEY_R);
 }
 
 static const char *ActionName(InputAction a) {
@@ -139,6 +140,8 @@ static const char *ActionName(InputAction a) {
 		return "down";
 	case ACT_JUMP:
 		return "jump";
+	case ACT_REWIND:
+		return "rewind";
 	default:
 		return "";
 	}
@@ -336,6 +339,8 @@ const char *InputConfig_ActionLabel(InputAction a) {
 		return "Down";
 	case ACT_JUMP:
 		return "Jump";
+	case ACT_REWIND:
+		return "Rewind";
 	default:
 		return NULL;
 	}
@@ -14,6 +14,7 @@ typedef enum {
 	ACT_RIGHT,
 	ACT_DOWN,
 	ACT_JUMP,
+	ACT_REWIND,
 	ACT__COUNT
 } InputAction;
 
@@ -2,8 +2,14 @@
 #include <errno.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "chunkstream.h"
+#include "crc32.h"
+#include "filemap.h"
 #include "game.h"
+#include "levelbake.h"
+#include "levelpack.h"
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 #endif
@@ -11,51 +17,320 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #else
 #include <direct.h>
 #endif
+#if defined(__linux__) && !defined(PLATFORM_WEB)
+#define LEVEL_CATALOG_INOTIFY 1
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
-LevelEditorState editor = {0};
-char gLevelBinPath[260] = LEVEL_FILE_BIN;
 bool gCreateNewRequested = false;
+static unsigned gLevelSaveSerial = 0; // bumped by SaveLevelBinary so catalogs pick up in-place rewrites
 
 // Format metadata
-static const uint8_t kLevelFormatVersion = 3; // storing player/exit in tile coordinates + spawners
+static const uint8_t kLevelFormatVersion = 4; // sectioned little-endian layout with CRCs (v1-v3 still load)
 static const float kLegacyV1SquareSize = 32.0f; // px size used when v1 saved world positions
 
-Vector2 SnapToGrid(Vector2 p) {
+Vector2 SnapToGrid(const LevelEditorState *ed, Vector2 p) {
 	int gx = ((int)p.x / SQUARE_SIZE) * SQUARE_SIZE;
 	int gy = ((int)p.y / SQUARE_SIZE) * SQUARE_SIZE;
+	int maxX = (ed->cols - 1) * SQUARE_SIZE, maxY = (ed->rows - 1) * SQUARE_SIZE;
+	if (gx > maxX) gx = maxX;
 	if (gx < 0) gx = 0;
-	if (gx > WINDOW_WIDTH - SQUARE_SIZE) gx = WINDOW_WIDTH - SQUARE_SIZE;
+	if (gy > maxY) gy = maxY;
 	if (gy < 0) gy = 0;
-	if (gy > WINDOW_HEIGHT - SQUARE_SIZE) gy = WINDOW_HEIGHT - SQUARE_SIZE;
 	return (Vector2){(float)gx, (float)gy};
 }
 
+// ---- Special tile index ----
+static int CellListLowerBound(const LevelCellList *l, int cell) {
+	int lo = 0, hi = l->count;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (l->cells[mid] < cell) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+// False when the list could not grow (out of memory) and `cell` is missing from it
+static bool CellListInsert(LevelCellList *l, int cell) {
+	int at = CellListLowerBound(l, cell);
+	if (at < l->count && l->cells[at] == cell) return true;
+	if (l->count == l->cap) {
+		int cap = l->cap ? l->cap * 2 : 16;
+		int *grown = realloc(l->cells, (size_t)cap * sizeof(int));
+		if (!grown) return false;
+		l->cells = grown;
+		l->cap = cap;
+	}
+	memmove(l->cells + at + 1, l->cells + at, (size_t)(l->count - at) * sizeof(int));
+	l->cells[at] = cell;
+	l->count++;
+	return true;
+}
+
+static void CellListRemove(LevelCellList *l, int cell) {
+	int at = CellListLowerBound(l, cell);
+	if (at >= l->count || l->cells[at] != cell) return;
+	memmove(l->cells + at, l->cells + at + 1, (size_t)(l->count - at - 1) * sizeof(int));
+	l->count--;
+}
+
+// Re-derive the part of a sorted cell list that lies in cells lo..hi from the tiles; false when
+// it could not grow (out of memory) and was left as it was
+static bool RefreshCellRange(LevelCellList *l, const uint8_t *tiles, int lo, int hi, TileType t) {
+	int a = CellListLowerBound(l, lo), b = CellListLowerBound(l, hi + 1);
+	int n = 0;
+	for (int c = lo; c <= hi; ++c) n += tiles[c] == t;
+	int count = l->count - (b - a) + n;
+	if (count > l->cap) {
+		int cap = l->cap * 2 > count ? l->cap * 2 : count;
+		int *grown = realloc(l->cells, (size_t)cap * sizeof(int));
+		if (!grown) return false;
+		l->cells = grown;
+		l->cap = cap;
+	}
+	if (b < l->count) memmove(l->cells + a + n, l->cells + b, (size_t)(l->count - b) * sizeof(int));
+	for (int c = lo, i = a; c <= hi; ++c)
+		if (tiles[c] == t) l->cells[i++] = c;
+	l->count = count;
+	return true;
+}
+
+static LevelCellList *IndexList(LevelTileIndex *ix, TileType t) {
+	if (IsSpawnerTile(t)) return &ix->spawners;
+	if (IsHazardTile(t)) return &ix->hazards;
+	return NULL;
+}
+
+static int FirstCellOf(const LevelEditorState *ed, TileType v) {
+	const size_t cells = (size_t)ed->cols * ed->rows;
+	for (size_t i = 0; i < cells; ++i)
+		if (ed->tiles[i] == v) return (int)i;
+	return -1;
+}
+
+static void IndexAdd(LevelEditorState *ed, int cell, TileType t) {
+	LevelTileIndex *ix = &ed->index;
+	LevelCellList *l = IndexList(ix, t);
+	if (l) {
+		if (!CellListInsert(l, cell)) ix->stale = true;
+	} else if (t == TILE_PLAYER && ix->playerCount++ == 0) ix->player = cell;
+	else if (t == TILE_EXIT && ix->exitCount++ == 0) ix->exit = cell;
+}
+
+// Called after the cell changed; a duplicate player/exit (old files) is found again by a scan
+static void IndexRemove(LevelEditorState *ed, int cell, TileType t) {
+	LevelTileIndex *ix = &ed->index;
+	LevelCellList *l = IndexList(ix, t);
+	if (l) CellListRemove(l, cell);
+	else if (t == TILE_PLAYER && --ix->playerCount > 0 && ix->player == cell) ix->player = FirstCellOf(ed, TILE_PLAYER);
+	else if (t == TILE_EXIT && --ix->exitCount > 0 && ix->exit == cell) ix->exit = FirstCellOf(ed, TILE_EXIT);
+}
+
+static bool GrowCellList(LevelCellList *l, int count) {
+	if (count <= l->cap) return true;
+	int *grown = realloc(l->cells, (size_t)count * sizeof(int));
+	if (!grown) return false;
+	l->cells = grown;
+	l->cap = count;
+	return true;
+}
+
+// A list lost a cell to a failed allocation: rescan the tiles into lists sized exactly, which
+// needs less memory than the doubling that failed. Stays stale (retried at the next edit) on failure.
+static void RepairCellLists(LevelEditorState *ed) {
+	LevelTileIndex *ix = &ed->index;
+	const size_t cells = (size_t)ed->cols * ed->rows;
+	int spawners = 0, hazards = 0;
+	for (size_t i = 0; i < cells; ++i) {
+		spawners += ed->tiles[i] == TILE_SPAWNER;
+		hazards += ed->tiles[i] == TILE_LASER;
+	}
+	if (!GrowCellList(&ix->spawners, spawners) || !GrowCellList(&ix->hazards, hazards)) return;
+	ix->spawners.count = ix->hazards.count = 0;
+	for (size_t i = 0; i < cells; ++i) {
+		if (ed->tiles[i] == TILE_SPAWNER) ix->spawners.cells[ix->spawners.count++] = (int)i;
+		else if (ed->tiles[i] == TILE_LASER) ix->hazards.cells[ix->hazards.count++] = (int)i;
+	}
+	ix->stale = false;
+}
+
+static void RebuildIndex(LevelEditorState *ed) {
+	LevelTileIndex *ix = &ed->index;
+	ed->revision++;
+	ed->dirtyX0 = ed->dirtyY0 = 0; // a bulk edit in progress has nothing left to refresh
+	ed->dirtyX1 = ed->dirtyY1 = -1;
+	ix->playerCount = ix->exitCount = 0;
+	ix->spawners.count = ix->hazards.count = 0;
+	ix->stale = false;
+	if (!ed->tiles) return;
+	const size_t cells = (size_t)ed->cols * ed->rows;
+	for (size_t i = 0; i < cells; ++i)
+		if (ed->tiles[i] != TILE_EMPTY && ed->tiles[i] != TILE_BLOCK) IndexAdd(ed, (int)i, (TileType)ed->tiles[i]);
+	if (ix->stale) RepairCellLists(ed);
+}
+
+static bool IsIndexedTile(TileType v) {
+	return v == TILE_PLAYER || v == TILE_EXIT || IsSpawnerTile(v) || IsHazardTile(v);
+}
+
+// A cell holding `v`, for indexed types; false when there is none
+static bool IndexedCell(const LevelEditorState *ed, TileType v, int *cell) {
+	const LevelTileIndex *ix = &ed->index;
+	if (v == TILE_PLAYER) {
+		*cell = ix->player;
+		return ix->playerCount > 0;
+	}
+	if (v == TILE_EXIT) {
+		*cell = ix->exit;
+		return ix->exitCount > 0;
+	}
+	const LevelCellList *l = Level_SpecialCells(ed, v);
+	if (!l || l->count == 0) return false;
+	*cell = l->cells[0];
+	return true;
+}
+
+static int IndexedCount(const LevelEditorState *ed, TileType v) {
+	if (v == TILE_PLAYER) return ed->index.playerCount;
+	if (v == TILE_EXIT) return ed->index.exitCount;
+	const LevelCellList *l = Level_SpecialCells(ed, v);
+	return l ? l->count : 0;
+}
+
+const LevelCellList *Level_SpecialCells(const LevelEditorState *ed, TileType v) {
+	if (IsSpawnerTile(v)) return &ed->index.spawners;
+	if (IsHazardTile(v)) return &ed->index.hazards;
+	return NULL;
+}
+
+static void DropBake(LevelEditorState *ed) {
+	LevelBake_Destroy(ed->bake);
+	ed->bake = NULL;
+}
+
+static void RefreshBake(LevelEditorState *ed, int x0, int y0, int x1, int y1) {
+	if (!LevelBake_UpdateRegion(ed->bake, ed, x0, y0, x1, y1)) DropBake(ed);
+}
+
+static void MarkDirty(LevelEditorState *ed, int cx, int cy) {
+	if (ed->dirtyX1 < ed->dirtyX0) {
+		ed->dirtyX0 = ed->dirtyX1 = cx;
+		ed->dirtyY0 = ed->dirtyY1 = cy;
+		return;
+	}
+	if (cx < ed->dirtyX0) ed->dirtyX0 = cx;
+	if (cx > ed->dirtyX1) ed->dirtyX1 = cx;
+	if (cy < ed->dirtyY0) ed->dirtyY0 = cy;
+	if (cy > ed->dirtyY1) ed->dirtyY1 = cy;
+}
+
+void Level_BeginBulk(LevelEditorState *ed) {
+	if (ed->bulk++ > 0) return;
+	ed->dirtyX0 = ed->dirtyY0 = 0;
+	ed->dirtyX1 = ed->dirtyY1 = -1;
+}
+
+void Level_EndBulk(LevelEditorState *ed) {
+	if (ed->bulk == 0 || --ed->bulk > 0) return;
+	if (!ed->tiles || ed->dirtyX1 < ed->dirtyX0) return;
+	// Row by row over the rectangle's columns: a tall, thin edit must not rescan whole rows
+	for (int y = ed->dirtyY0; y <= ed->dirtyY1 && !ed->index.stale; ++y) {
+		int lo = y * ed->cols + ed->dirtyX0, hi = y * ed->cols + ed->dirtyX1;
+		if (!RefreshCellRange(&ed->index.spawners, ed->tiles, lo, hi, TILE_SPAWNER)) ed->index.stale = true;
+		if (!RefreshCellRange(&ed->index.hazards, ed->tiles, lo, hi, TILE_LASER)) ed->index.stale = true;
+	}
+	if (ed->index.stale) RepairCellLists(ed);
+	if (ed->bake) RefreshBake(ed, ed->dirtyX0, ed->dirtyY0, ed->dirtyX1, ed->dirtyY1);
+}
+
+bool Level_Resize(LevelEditorState *ed, int cols, int rows) {
+	if (ed->stream) return false; // streamed levels are play-only
+	if (cols < 1 || rows < 1 || cols > LEVEL_MAX_COLS || rows > LEVEL_MAX_ROWS) return false;
+	if (cols == ed->cols && rows == ed->rows && ed->tiles) return true;
+	uint8_t *tiles = calloc((size_t)cols * (size_t)rows, 1); // TILE_EMPTY == 0
+	if (!tiles) return false; // nothing recorded: the journal and undo history only hold resizes that happened
+	if (ed->journal) LevelJournal_RecordResize(ed->journal, cols, rows);
+	if (ed->history) LevelHistory_RecordResize(ed->history, ed, cols, rows); // reads the old tiles
+	DropBake(ed);
+	int keepCols = cols < ed->cols ? cols : ed->cols;
+	int keepRows = rows < ed->rows ? rows : ed->rows;
+	for (int y = 0; ed->tiles && y < keepRows; ++y)
+		memcpy(tiles + (size_t)y * cols, ed->tiles + (size_t)y * ed->cols, (size_t)keepCols);
+	free(ed->tiles);
+	ed->tiles = tiles;
+	ed->cols = cols;
+	ed->rows = rows;
+	RebuildIndex(ed); // cell numbers depend on the width
+	return true;
+}
+
+void Level_Free(LevelEditorState *ed) {
+	if (ed->stream) ChunkStream_Destroy(ed->stream);
+	ed->stream = NULL;
+	DropBake(ed);
+	free(ed->tiles);
+	ed->tiles = NULL;
+	ed->cols = ed->rows = 0;
+	free(ed->index.spawners.cells);
+	free(ed->index.hazards.cells);
+	memset(&ed->index, 0, sizeof(ed->index));
+	free(ed->schedule.intervals);
+	free(ed->schedule.waves);
+	memset(&ed->schedule, 0, sizeof(ed->schedule));
+}
+
 TileType GetTile(const LevelEditorState *ed, int cx, int cy) {
-	if (!InBoundsCell(cx, cy)) return TILE_BLOCK; // out of bounds is solid
-	return ed->tiles[cy][cx];
+	if (!InBoundsCell(ed, cx, cy)) return TILE_BLOCK; // out of bounds is solid
+	return LevelTile(ed, cx, cy);
 }
 void SetTile(LevelEditorState *ed, int cx, int cy, TileType v) {
-	if (!InBoundsCell(cx, cy)) return;
-	ed->tiles[cy][cx] = v;
+	if (!ed->tiles || !InBoundsCell(ed, cx, cy)) return;
+	const int cell = cy * ed->cols + cx;
+	const TileType old = (TileType)ed->tiles[cell];
+	if (old == v) return;
+	if (ed->journal) LevelJournal_RecordSet(ed->journal, cx, cy, v);
+	if (ed->history) LevelHistory_RecordSet(ed->history, cx, cy, old, v);
+	ed->tiles[cell] = (uint8_t)v;
+	ed->revision++;
+	if (ed->bulk) {
+		// Lists and bake wait for Level_EndBulk; player/exit counts stay exact
+		if (!IndexList(&ed->index, old)) IndexRemove(ed, cell, old);
+		if (!IndexList(&ed->index, v)) IndexAdd(ed, cell, v);
+		MarkDirty(ed, cx, cy);
+		return;
+	}
+	IndexRemove(ed, cell, old);
+	IndexAdd(ed, cell, v);
+	if (ed->index.stale) RepairCellLists(ed);
+	if (ed->bake) RefreshBake(ed, cx, cy, cx, cy);
 }
 void SetUniqueTile(LevelEditorState *ed, int cx, int cy, TileType v) {
-	for (int y = 0; y < GRID_ROWS; ++y)
-		for (int x = 0; x < GRID_COLS; ++x)
-			if (ed->tiles[y][x] == v)
-				ed->tiles[y][x] = TILE_EMPTY;
+	if (!ed->tiles) return;
+	int cell;
+	// Already the only one: tools call this every frame while held, and a clear + set would journal,
+	// record undo steps and restart the reachability check each time
+	if (IsIndexedTile(v) && InBoundsCell(ed, cx, cy) && LevelTile(ed, cx, cy) == v && IndexedCount(ed, v) == 1) return;
+	if (IsIndexedTile(v)) {
+		while (IndexedCell(ed, v, &cell)) SetTile(ed, cell % ed->cols, cell / ed->cols, TILE_EMPTY);
+	} else {
+		for (int y = 0; y < ed->rows; ++y)
+			for (int x = 0; x < ed->cols; ++x)
+				if (LevelTile(ed, x, y) == v) SetTile(ed, x, y, TILE_EMPTY);
+	}
 	SetTile(ed, cx, cy, v);
 }
 bool FindTileWorldPos(const LevelEditorState *ed, TileType v, Vector2 *out) {
-	for (int y = 0; y < GRID_ROWS; ++y)
-		for (int x = 0; x < GRID_COLS; ++x)
-			if (ed->tiles[y][x] == v) {
-				*out = (Vector2){CellToWorld(x), CellToWorld(y)};
-				return true;
-			}
-	return false;
+	if (!ed->tiles) return false;
+	int cell;
+	if (IsIndexedTile(v) ? !IndexedCell(ed, v, &cell) : (cell = FirstCellOf(ed, v)) < 0) return false;
+	*out = (Vector2){CellToWorld(cell % ed->cols), CellToWorld(cell / ed->cols)};
+	return true;
 }
 
 void EnsureLevelsDir(void) {
@@ -69,23 +344,29 @@ void EnsureLevelsDir(void) {
 }
 
 void FillPerimeter(LevelEditorState *ed) {
-	for (int x = 0; x < GRID_COLS; ++x) {
+	for (int x = 0; x < ed->cols; ++x) {
 		SetTile(ed, x, 0, TILE_BLOCK);
-		SetTile(ed, x, GRID_ROWS - 1, TILE_BLOCK);
+		SetTile(ed, x, ed->rows - 1, TILE_BLOCK);
 	}
-	for (int y = 1; y < GRID_ROWS - 1; ++y) {
+	for (int y = 1; y < ed->rows - 1; ++y) {
 		SetTile(ed, 0, y, TILE_BLOCK);
-		SetTile(ed, GRID_COLS - 1, y, TILE_BLOCK);
+		SetTile(ed, ed->cols - 1, y, TILE_BLOCK);
 	}
 }
 
 void CreateDefaultLevel(GameState *game, LevelEditorState *ed) {
-	for (int y = 0; y < GRID_ROWS; ++y)
-		for (int x = 0; x < GRID_COLS; ++x)
-			ed->tiles[y][x] = TILE_EMPTY;
+	if (ed->stream) Level_Free(ed);
+	free(ed->schedule.intervals);
+	free(ed->schedule.waves);
+	memset(&ed->schedule, 0, sizeof(ed->schedule));
+	// Out of memory: clear the old tiles at their size instead, or leave no level when there are none
+	if (!Level_Resize(ed, GRID_COLS, GRID_ROWS) && !ed->tiles) return;
+	memset(ed->tiles, TILE_EMPTY, (size_t)ed->cols * ed->rows);
+	DropBake(ed);
+	RebuildIndex(ed);
 	FillPerimeter(ed);
-	Vector2 p = (Vector2){SQUARE_SIZE, WINDOW_HEIGHT - SQUARE_SIZE * 2};
-	Vector2 e = (Vector2){WINDOW_WIDTH - SQUARE_SIZE * 2, WINDOW_HEIGHT - SQUARE_SIZE * 2};
+	Vector2 p = (Vector2){SQUARE_SIZE, LevelPixelHeight(ed) - SQUARE_SIZE * 2};
+	Vector2 e = (Vector2){LevelPixelWidth(ed) - SQUARE_SIZE * 2, LevelPixelHeight(ed) - SQUARE_SIZE * 2};
 	SetUniqueTile(ed, WorldToCellX(p.x), WorldToCellY(p.y), TILE_PLAYER);
 	SetUniqueTile(ed, WorldToCellX(e.x), WorldToCellY(e.y), TILE_EXIT);
 	game->playerPos = (Vector2){p.x + (float)SQUARE_SIZE * 0.5f, p.y + (float)SQUARE_SIZE * 0.5f};
@@ -93,62 +374,369 @@ void CreateDefaultLevel(GameState *game, LevelEditorState *ed) {
 	game->groundStickTimer = 0.0f;
 }
 
-bool SaveLevelBinary(const GameState *game, const LevelEditorState *ed) {
-	EnsureLevelsDir();
-	FILE *f = fopen(gLevelBinPath, "wb");
-	if (!f) return false;
-	const char magic[4] = {'L', 'V', 'L', '1'};
-	uint8_t version = kLevelFormatVersion; // store player/exit as tile coordinates
-	uint16_t cols = (uint16_t)GRID_COLS, rows = (uint16_t)GRID_ROWS;
-	if (fwrite(magic, 1, 4, f) != 4) {
-		fclose(f);
-		return false;
+// LVL1 v1-v3 layout (native-endian, read-only now): "LVL1", u8 version, u16 cols, u16 rows,
+// player/exit (v1: i32 world px x4, v2-v3: u16 cells x4), then cols*rows tile bytes.
+//
+// LVL1 v4 layout (little-endian):
+//   fixed header (56 bytes): "LVL1", u8 version, u8 flags, u16 sectionCount, u16 cols, u16 rows,
+//     u16 playerCx, playerCy, exitCx, exitCy, u16 spawnerCount, u16 reserved, char name[32]
+//   section table: sectionCount x (char tag[4], u32 offset, u32 size, u32 crc32)
+//   u32 crc32 of the fixed header + section table
+//   section payloads:
+//     TILE  u8 encoding, then the tile data:
+//             0 = raw, one byte per cell
+//             1 = row-wise RLE: u8 paletteCount (1..8), palette bytes, then per row tokens
+//                 (paletteIndex << 5) | (runLength - 1); runs never cross a row
+//     SPWN  spawnerCount x (u16 cx, u16 cy, u32 intervalMs)
+//     META  "key=value\n" text
+//     WAVE  optional scripted waves: (u32 startMs, u32 repeatMs, u16 cx, u16 cy, u16 count, u16 0) each
+//     THMB  optional preview image (readers skip it when absent)
+//
+// Chunked v4 (flags & LEVEL_FLAG_CHUNKED, written for levels of LEVEL_CHUNKED_MIN_CELLS or more)
+// replaces TILE with two sections so play can stream the level in pieces:
+//     CIDX  u16 chunkSize, u16 chunksX, u16 chunksY, u16 reserved, then chunksX*chunksY records
+//           (u32 offset into CDAT, u32 size, u32 crc32), row-major by chunk
+//     CDAT  the chunk tile blocks back to back, each encoded like TILE over chunkSize^2 cells
+//           (cells past the level edge are empty). The table CRC of CDAT is 0: chunks are
+//           checked individually against CIDX as they are decoded, so opening never reads them all.
+#define LEVEL_LEGACY_HEADER_BYTES (4 + 1 + 2 * 2 + 4 * 2)
+#define LEVEL_V4_FIXED_BYTES 56
+#define LEVEL_V4_SECTION_BYTES 16
+#define LEVEL_V4_MAX_SECTIONS 8
+#define LEVEL_V4_HEADER_MAX (LEVEL_V4_FIXED_BYTES + LEVEL_V4_MAX_SECTIONS * LEVEL_V4_SECTION_BYTES + 4)
+#define LEVEL_SPAWNER_RECORD_BYTES 8
+#define LEVEL_WAVE_RECORD_BYTES 16
+#define LEVEL_TILE_ENC_RAW 0
+#define LEVEL_TILE_ENC_RLE 1
+#define LEVEL_RLE_PALETTE_MAX 8
+#define LEVEL_RLE_RUN_MAX 32
+#define LEVEL_FLAG_CHUNKED 0x01
+#define LEVEL_CIDX_HEADER_BYTES 8
+#define LEVEL_CIDX_RECORD_BYTES 12
+#define LEVEL_CHUNK_CELLS (LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE)
+
+static inline int ChunksAlong(int cells) { return (cells + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT; }
+
+// Header, raw tiles (or raw chunks plus their index), a spawner record for every cell in the
+// worst case, and the metadata text
+static size_t SaveBufferBound(const LevelEditorState *ed) {
+	const size_t chunks = (size_t)ChunksAlong(ed->cols) * ChunksAlong(ed->rows);
+	return LEVEL_V4_HEADER_MAX + 1 + (size_t)ed->cols * ed->rows * (1 + LEVEL_SPAWNER_RECORD_BYTES) +
+	       LEVEL_CIDX_HEADER_BYTES + chunks * (LEVEL_CIDX_RECORD_BYTES + 1 + LEVEL_CHUNK_CELLS) +
+	       (size_t)ed->schedule.waveCount * LEVEL_WAVE_RECORD_BYTES + 64;
+}
+
+typedef struct ByteReader {
+	const uint8_t *p;
+	const uint8_t *end;
+} ByteReader;
+
+static bool Rd_Bytes(ByteReader *r, void *out, size_t n) {
+	if ((size_t)(r->end - r->p) < n) return false;
+	memcpy(out, r->p, n);
+	r->p += n;
+	return true;
+}
+
+typedef struct LevelSection {
+	char tag[4];
+	uint32_t offset;
+	uint32_t size;
+	uint32_t crc;
+} LevelSection;
+
+typedef struct LevelHeaderV4 {
+	uint8_t flags;
+	uint16_t sectionCount;
+	uint16_t cols, rows;
+	uint16_t pcx, pcy, ecx, ecy;
+	uint16_t spawnerCount;
+	char name[LEVEL_NAME_MAX];
+	LevelSection sections[LEVEL_V4_MAX_SECTIONS];
+	size_t headerBytes; // fixed header + section table (the header CRC follows)
+} LevelHeaderV4;
+
+static inline uint16_t Get16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t Get32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static inline void Put16(uint8_t *p, uint16_t v) {
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+static inline void Put32(uint8_t *p, uint32_t v) {
+	for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// Validates the header CRC and table shape; section bounds are checked by the full loader
+static bool ParseHeaderV4(const uint8_t *data, size_t size, LevelHeaderV4 *h) {
+	if (size < LEVEL_V4_FIXED_BYTES + 4) return false;
+	if (memcmp(data, "LVL1", 4) != 0 || data[4] != 4) return false;
+	h->flags = data[5];
+	h->sectionCount = Get16(data + 6);
+	if (h->sectionCount > LEVEL_V4_MAX_SECTIONS) return false;
+	h->headerBytes = LEVEL_V4_FIXED_BYTES + (size_t)h->sectionCount * LEVEL_V4_SECTION_BYTES;
+	if (size < h->headerBytes + 4) return false;
+	if (Crc32(0, data, h->headerBytes) != Get32(data + h->headerBytes)) return false;
+	h->cols = Get16(data + 8);
+	h->rows = Get16(data + 10);
+	h->pcx = Get16(data + 12);
+	h->pcy = Get16(data + 14);
+	h->ecx = Get16(data + 16);
+	h->ecy = Get16(data + 18);
+	h->spawnerCount = Get16(data + 20);
+	memcpy(h->name, data + 24, LEVEL_NAME_MAX);
+	h->name[LEVEL_NAME_MAX - 1] = '\0';
+	for (int i = 0; i < h->sectionCount; i++) {
+		const uint8_t *s = data + LEVEL_V4_FIXED_BYTES + (size_t)i * LEVEL_V4_SECTION_BYTES;
+		LevelSection *sec = &h->sections[i];
+		memcpy(sec->tag, s, 4);
+		sec->offset = Get32(s + 4);
+		sec->size = Get32(s + 8);
+		sec->crc = Get32(s + 12);
 	}
-	if (fwrite(&version, 1, 1, f) != 1) {
-		fclose(f);
-		return false;
+	return true;
+}
+
+static const LevelSection *FindSection(const LevelHeaderV4 *h, const char tag[4]) {
+	for (int i = 0; i < h->sectionCount; i++)
+		if (memcmp(h->sections[i].tag, tag, 4) == 0) return &h->sections[i];
+	return NULL;
+}
+
+// Encode a cols*rows byte grid as palette RLE into out (encoding byte included).
+// Returns 0 when the grid needs more than LEVEL_RLE_PALETTE_MAX values or would not shrink.
+static size_t EncodeTilesRle(const uint8_t *raw, int cols, int rows, uint8_t *out, size_t cap) {
+	uint8_t palette[LEVEL_RLE_PALETTE_MAX];
+	int paletteCount = 0;
+	uint8_t indexOf[256];
+	memset(indexOf, 0xFF, sizeof(indexOf));
+	const size_t cells = (size_t)cols * rows;
+	for (size_t i = 0; i < cells; i++) {
+		if (indexOf[raw[i]] != 0xFF) continue;
+		if (paletteCount == LEVEL_RLE_PALETTE_MAX) return 0;
+		indexOf[raw[i]] = (uint8_t)paletteCount;
+		palette[paletteCount++] = raw[i];
 	}
-	if (fwrite(&cols, sizeof(cols), 1, f) != 1) {
-		fclose(f);
-		return false;
+	size_t o = 0;
+	if (cap < 2 + (size_t)paletteCount) return 0;
+	out[o++] = LEVEL_TILE_ENC_RLE;
+	out[o++] = (uint8_t)paletteCount;
+	for (int i = 0; i < paletteCount; i++) out[o++] = palette[i];
+	for (int y = 0; y < rows; y++) {
+		const uint8_t *row = raw + (size_t)y * cols;
+		for (int x = 0; x < cols;) {
+			int run = 1;
+			while (x + run < cols && run < LEVEL_RLE_RUN_MAX && row[x + run] == row[x]) run++;
+			if (o >= cap) return 0;
+			out[o++] = (uint8_t)((indexOf[row[x]] << 5) | (run - 1));
+			x += run;
+		}
 	}
-	if (fwrite(&rows, sizeof(rows), 1, f) != 1) {
-		fclose(f);
-		return false;
+	return o < 1 + cells ? o : 0;
+}
+
+static bool DecodeTilesRle(const uint8_t *src, size_t n, uint8_t *dst, int cols, int rows) {
+	if (n < 2) return false;
+	int paletteCount = src[1];
+	if (paletteCount < 1 || paletteCount > LEVEL_RLE_PALETTE_MAX || n < 2 + (size_t)paletteCount) return false;
+	const uint8_t *palette = src + 2;
+	size_t i = 2 + (size_t)paletteCount;
+	for (int y = 0; y < rows; y++) {
+		uint8_t *row = dst + (size_t)y * cols;
+		for (int x = 0; x < cols;) {
+			if (i >= n) return false;
+			uint8_t t = src[i++];
+			int idx = t >> 5, run = (t & (LEVEL_RLE_RUN_MAX - 1)) + 1;
+			if (idx >= paletteCount || x + run > cols) return false;
+			memset(row + x, palette[idx], (size_t)run);
+			x += run;
+		}
 	}
-	Vector2 p = game->playerPos, e = game->exitPos;
-	FindTileWorldPos(ed, TILE_PLAYER, &p);
-	FindTileWorldPos(ed, TILE_EXIT, &e);
-	Vector2 pTopLeft = (Vector2){p.x - (float)SQUARE_SIZE * 0.5f, p.y - (float)SQUARE_SIZE * 0.5f};
-	uint16_t pcx = (uint16_t)WorldToCellX(pTopLeft.x);
-	uint16_t pcy = (uint16_t)WorldToCellY(pTopLeft.y);
-	uint16_t ecx = (uint16_t)WorldToCellX(e.x);
-	uint16_t ecy = (uint16_t)WorldToCellY(e.y);
-	if (fwrite(&pcx, sizeof(pcx), 1, f) != 1) {
-		fclose(f);
-		return false;
+	return i == n;
+}
+
+// TILE-style block (encoding byte + data) for a cols*rows grid: RLE when enabled and smaller,
+// raw otherwise. `out` must hold 1 + cols*rows bytes.
+static size_t EncodeTileBlock(const uint8_t *raw, int cols, int rows, uint8_t *out) {
+	const size_t cells = (size_t)cols * rows;
+	size_t n = LEVEL_COMPRESS_TILES ? EncodeTilesRle(raw, cols, rows, out, 1 + cells) : 0;
+	if (n > 0) return n;
+	out[0] = LEVEL_TILE_ENC_RAW;
+	memcpy(out + 1, raw, cells);
+	return 1 + cells;
+}
+
+static bool DecodeTileBlock(const uint8_t *src, size_t n, uint8_t *dst, int cols, int rows) {
+	if (n < 1) return false;
+	const size_t cells = (size_t)cols * rows;
+	if (src[0] == LEVEL_TILE_ENC_RAW) {
+		if (n - 1 != cells) return false;
+		memcpy(dst, src + 1, cells);
+		return true;
 	}
-	if (fwrite(&pcy, sizeof(pcy), 1, f) != 1) {
-		fclose(f);
-		return false;
+	if (src[0] == LEVEL_TILE_ENC_RLE) return DecodeTilesRle(src, n, dst, cols, rows);
+	return false;
+}
+
+// Write the CIDX payload into `cidx` and the chunk blocks into `cdat`; returns the CDAT size
+static size_t EncodeChunks(const LevelEditorState *ed, uint8_t *cidx, uint8_t *cdat) {
+	const int chunksX = ChunksAlong(ed->cols), chunksY = ChunksAlong(ed->rows);
+	uint8_t block[LEVEL_CHUNK_CELLS];
+	Put16(cidx, LEVEL_CHUNK_SIZE);
+	Put16(cidx + 2, (uint16_t)chunksX);
+	Put16(cidx + 4, (uint16_t)chunksY);
+	Put16(cidx + 6, 0);
+	uint8_t *rec = cidx + LEVEL_CIDX_HEADER_BYTES;
+	size_t at = 0;
+	for (int chy = 0; chy < chunksY; ++chy)
+		for (int chx = 0; chx < chunksX; ++chx) {
+			int x0 = chx * LEVEL_CHUNK_SIZE, y0 = chy * LEVEL_CHUNK_SIZE;
+			int w = ed->cols - x0 < LEVEL_CHUNK_SIZE ? ed->cols - x0 : LEVEL_CHUNK_SIZE;
+			int h = ed->rows - y0 < LEVEL_CHUNK_SIZE ? ed->rows - y0 : LEVEL_CHUNK_SIZE;
+			memset(block, TILE_EMPTY, sizeof(block));
+			for (int y = 0; y < h; ++y) memcpy(block + y * LEVEL_CHUNK_SIZE, ed->tiles + (size_t)(y0 + y) * ed->cols + x0, (size_t)w);
+			size_t n = EncodeTileBlock(block, LEVEL_CHUNK_SIZE, LEVEL_CHUNK_SIZE, cdat + at);
+			Put32(rec, (uint32_t)at);
+			Put32(rec + 4, (uint32_t)n);
+			Put32(rec + 8, Crc32(0, cdat + at, n));
+			rec += LEVEL_CIDX_RECORD_BYTES;
+			at += n;
+		}
+	return at;
+}
+
+static void PutSectionEntry(uint8_t *file, int index, const char tag[4], size_t offset, size_t size, uint32_t crc) {
+	uint8_t *s = file + LEVEL_V4_FIXED_BYTES + (size_t)index * LEVEL_V4_SECTION_BYTES;
+	memcpy(s, tag, 4);
+	Put32(s + 4, (uint32_t)offset);
+	Put32(s + 8, (uint32_t)size);
+	Put32(s + 12, crc);
+}
+
+// Fill in a section table slot for a payload already written at `offset`
+static void PutSection(uint8_t *file, int index, const char tag[4], size_t offset, size_t size) {
+	PutSectionEntry(file, index, tag, offset, size, Crc32(0, file + offset, size));
+}
+
+static void LevelNameFromPath(const char *path, char *out, size_t outSz) {
+	const char *base = path;
+	for (const char *p = path; *p; p++)
+		if (*p == '/' || *p == '\\') base = p + 1;
+	const char *dot = strrchr(base, '.');
+	int len = dot ? (int)(dot - base) : (int)strlen(base);
+	snprintf(out, outSz, "%.*s", len, base);
+}
+
+size_t Level_SaveToMemory(const GameState *game, const LevelEditorState *ed, const char *name, void *out, size_t cap) {
+	if (!ed->tiles) return 0; // streamed levels are play-only
+	const size_t cells = (size_t)ed->cols * ed->rows;
+	if (cells == 0) return 0;
+	const LevelCellList *spawnerCells = &ed->index.spawners;
+	const int spawners = spawnerCells->count;
+	char meta[LEVEL_NAME_MAX + 8];
+	int metaLen = snprintf(meta, sizeof(meta), "name=%.*s\n", LEVEL_NAME_MAX - 1, name ? name : "");
+	const bool chunked = cells >= LEVEL_CHUNKED_MIN_CELLS;
+	const int waves = ed->schedule.waveCount;
+	const int sectionCount = (chunked ? 4 : 3) + (waves > 0);
+	const size_t headerBytes = LEVEL_V4_FIXED_BYTES + (size_t)sectionCount * LEVEL_V4_SECTION_BYTES;
+	// Tile payload: one TILE block, or the chunk index followed by the chunk blocks
+	const size_t chunks = (size_t)ChunksAlong(ed->cols) * ChunksAlong(ed->rows);
+	const size_t cidxBytes = chunked ? LEVEL_CIDX_HEADER_BYTES + chunks * LEVEL_CIDX_RECORD_BYTES : 0;
+	uint8_t *tilePayload = malloc(chunked ? cidxBytes + chunks * (1 + LEVEL_CHUNK_CELLS) : 1 + cells);
+	if (!tilePayload) return 0;
+	size_t tileBytes = chunked ? cidxBytes + EncodeChunks(ed, tilePayload, tilePayload + cidxBytes)
+	                           : EncodeTileBlock(ed->tiles, ed->cols, ed->rows, tilePayload);
+	const size_t spwnBytes = (size_t)spawners * LEVEL_SPAWNER_RECORD_BYTES;
+	const size_t waveBytes = (size_t)waves * LEVEL_WAVE_RECORD_BYTES;
+	const size_t total = headerBytes + 4 + tileBytes + spwnBytes + (size_t)metaLen + waveBytes;
+	if (cap < total) {
+		free(tilePayload);
+		return 0;
 	}
-	if (fwrite(&ecx, sizeof(ecx), 1, f) != 1) {
-		fclose(f);
-		return false;
+
+	uint8_t *o = out;
+	memset(o, 0, headerBytes + 4);
+	Vector2 e = game->exitPos;
+	Vector2 pTopLeft = (Vector2){game->playerPos.x - (float)SQUARE_SIZE * 0.5f, game->playerPos.y - (float)SQUARE_SIZE * 0.5f};
+	FindTileWorldPos(ed, TILE_PLAYER, &pTopLeft); // the tile's cell, not half a cell up-left of it
+	FindTileWorldPos(ed, TILE_EXIT, &e);
+	memcpy(o, "LVL1", 4);
+	o[4] = kLevelFormatVersion;
+	o[5] = chunked ? LEVEL_FLAG_CHUNKED : 0;
+	Put16(o + 6, (uint16_t)sectionCount);
+	Put16(o + 8, (uint16_t)ed->cols);
+	Put16(o + 10, (uint16_t)ed->rows);
+	Put16(o + 12, (uint16_t)WorldToCellX(pTopLeft.x));
+	Put16(o + 14, (uint16_t)WorldToCellY(pTopLeft.y));
+	Put16(o + 16, (uint16_t)WorldToCellX(e.x));
+	Put16(o + 18, (uint16_t)WorldToCellY(e.y));
+	Put16(o + 20, (uint16_t)spawners);
+	if (name) snprintf((char *)o + 24, LEVEL_NAME_MAX, "%s", name);
+
+	size_t at = headerBytes + 4;
+	int section = 0;
+	memcpy(o + at, tilePayload, tileBytes);
+	free(tilePayload);
+	if (chunked) {
+		PutSection(o, section++, "CIDX", at, cidxBytes);
+		PutSectionEntry(o, section++, "CDAT", at + cidxBytes, tileBytes - cidxBytes, 0);
+	} else {
+		PutSection(o, section++, "TILE", at, tileBytes);
 	}
-	if (fwrite(&ecy, sizeof(ecy), 1, f) != 1) {
-		fclose(f);
-		return false;
+	at += tileBytes;
+
+	uint8_t *s = o + at;
+	for (int i = 0; i < spawners; ++i) { // row-major, like the chunked SPWN readers expect
+		int cx = spawnerCells->cells[i] % ed->cols, cy = spawnerCells->cells[i] / ed->cols;
+		Put16(s, (uint16_t)cx);
+		Put16(s + 2, (uint16_t)cy);
+		Put32(s + 4, Level_SpawnerIntervalMs(ed, cx, cy));
+		s += LEVEL_SPAWNER_RECORD_BYTES;
 	}
-	for (int y = 0; y < GRID_ROWS; ++y)
-		for (int x = 0; x < GRID_COLS; ++x) {
-			uint8_t t = (uint8_t)ed->tiles[y][x];
-			if (fwrite(&t, 1, 1, f) != 1) {
-				fclose(f);
-				return false;
-			}
+	PutSection(o, section++, "SPWN", at, spwnBytes);
+	at += spwnBytes;
+
+	memcpy(o + at, meta, (size_t)metaLen);
+	PutSection(o, section++, "META", at, (size_t)metaLen);
+	at += (size_t)metaLen;
+
+	if (waves > 0) {
+		uint8_t *r = o + at;
+		memset(r, 0, waveBytes);
+		for (int i = 0; i < waves; ++i, r += LEVEL_WAVE_RECORD_BYTES) {
+			const LevelWave *wv = &ed->schedule.waves[i];
+			Put32(r, wv->startMs);
+			Put32(r + 4, wv->repeatMs);
+			Put16(r + 8, wv->cx);
+			Put16(r + 10, wv->cy);
+			Put16(r + 12, wv->count);
 		}
-	fclose(f);
+		PutSection(o, section++, "WAVE", at, waveBytes);
+		at += waveBytes;
+	}
+
+	Put32(o + headerBytes, Crc32(0, o, headerBytes));
+	return at;
+}
+
+bool Level_WriteImage(const char *path, const void *data, size_t size) {
+	char tmp[300];
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	EnsureLevelsDir();
+	FILE *f = fopen(tmp, "wb");
+	if (!f) return false;
+	bool ok = fwrite(data, 1, size, f) == size;
+	if (fclose(f) != 0) ok = false;
+#ifdef _WIN32
+	if (ok) remove(path); // rename does not replace on Windows
+#endif
+	if (ok) ok = rename(tmp, path) == 0;
+	if (!ok) remove(tmp);
+	return ok;
+}
+
+void Level_SyncStorage(void) {
 #ifdef __EMSCRIPTEN__
 	EM_ASM({
 		if (typeof FS != 'undefined' && Module && FS.filesystems.IDBFS) {
@@ -156,120 +744,340 @@ bool SaveLevelBinary(const GameState *game, const LevelEditorState *ed) {
 		}
 	});
 #endif
-	return true;
 }
 
-bool LoadLevelBinary(GameState *game, LevelEditorState *ed) {
-	FILE *f = fopen(gLevelBinPath, "rb");
-	if (!f) return false;
-	char magic[4];
-	uint8_t version = 0;
-	uint16_t cols = 0, rows = 0;
-	if (fread(magic, 1, 4, f) != 4) {
-		fclose(f);
-		return false;
+void Level_NoteSaved(void) {
+	gLevelSaveSerial++;
+	Level_SyncStorage();
+}
+
+void *Level_SaveImage(const char *path, const GameState *game, const LevelEditorState *ed, size_t *size) {
+	size_t cap = SaveBufferBound(ed);
+	uint8_t *buf = malloc(cap);
+	if (!buf) return NULL;
+	char name[LEVEL_NAME_MAX];
+	LevelNameFromPath(path, name, sizeof(name));
+	*size = Level_SaveToMemory(game, ed, name, buf, cap);
+	if (*size == 0) {
+		free(buf);
+		return NULL;
 	}
-	if (memcmp(magic, "LVL1", 4) != 0) {
-		fclose(f);
-		return false;
+	return buf;
+}
+
+bool SaveLevelBinary(const char *path, const GameState *game, const LevelEditorState *ed) {
+	size_t len = 0;
+	void *buf = Level_SaveImage(path, game, ed, &len);
+	bool ok = buf && Level_WriteImage(path, buf, len);
+	free(buf);
+	if (!ok) return false;
+	Level_NoteSaved();
+	return true;
+}
+
+static bool ValidLevelSize(int cols, int rows) {
+	return cols >= 1 && rows >= 1 && cols <= LEVEL_MAX_COLS && rows <= LEVEL_MAX_ROWS;
+}
+
+// Shared tail of every format: install the decoded tile block (ownership moves to `ed`) and clamp positions
+static void ApplyLoadedLevel(GameState *game, LevelEditorState *ed, int cols, int rows, int pcx, int pcy, int ecx, int ecy, uint8_t *tiles) {
+	Level_Free(ed);
+	ed->tiles = tiles;
+	ed->cols = cols;
+	ed->rows = rows;
+	RebuildIndex(ed);
+	// Clamp to grid and convert to world using current SQUARE_SIZE so placement scales with tile size
+	if (pcx < 0) pcx = 0;
+	if (pcx >= cols) pcx = cols - 1;
+	if (pcy < 0) pcy = 0;
+	if (pcy >= rows) pcy = rows - 1;
+	if (ecx < 0) ecx = 0;
+	if (ecx >= cols) ecx = cols - 1;
+	if (ecy < 0) ecy = 0;
+	if (ecy >= rows) ecy = rows - 1;
+	game->playerPos = (Vector2){CellToWorld(pcx) + (float)SQUARE_SIZE * 0.5f, CellToWorld(pcy) + (float)SQUARE_SIZE * 0.5f};
+	game->exitPos = (Vector2){CellToWorld(ecx), CellToWorld(ecy)};
+}
+
+// Every section must be in bounds and intact before anything is applied (CDAT is checked per chunk)
+static bool CheckSections(const uint8_t *data, size_t size, const LevelHeaderV4 *h) {
+	for (int i = 0; i < h->sectionCount; i++) {
+		const LevelSection *s = &h->sections[i];
+		if (s->offset > size || s->size > size - s->offset) return false;
+		if ((h->flags & LEVEL_FLAG_CHUNKED) && memcmp(s->tag, "CDAT", 4) == 0) continue;
+		if (Crc32(0, data + s->offset, s->size) != s->crc) return false;
 	}
-	if (fread(&version, 1, 1, f) != 1) {
-		fclose(f);
-		return false;
+	return true;
+}
+
+static int CompareIntervals(const void *a, const void *b) {
+	const LevelSpawnerInterval *x = a, *y = b;
+	if (x->cy != y->cy) return x->cy < y->cy ? -1 : 1;
+	return x->cx < y->cx ? -1 : x->cx > y->cx;
+}
+
+// Keep the timing the file gives its spawners and waves (after ApplyLoadedLevel). Running out of
+// memory here only loses the timing: the level still plays with the default interval.
+static void ApplySchedule(LevelEditorState *ed, const uint8_t *spwn, int spawnerCount, const uint8_t *wave, int waveCount) {
+	LevelSchedule *s = &ed->schedule;
+	for (int i = 0; i < spawnerCount; ++i)
+		if (Get32(spwn + (size_t)i * LEVEL_SPAWNER_RECORD_BYTES + 4) != ROGUE_SPAWN_INTERVAL_MS) s->intervalCount++;
+	if (s->intervalCount > 0) {
+		s->intervals = malloc((size_t)s->intervalCount * sizeof(LevelSpawnerInterval));
+		int n = 0;
+		for (int i = 0; s->intervals && i < spawnerCount; ++i) {
+			const uint8_t *rec = spwn + (size_t)i * LEVEL_SPAWNER_RECORD_BYTES;
+			if (Get32(rec + 4) == ROGUE_SPAWN_INTERVAL_MS) continue;
+			s->intervals[n++] = (LevelSpawnerInterval){Get16(rec), Get16(rec + 2), Get32(rec + 4)};
+		}
+		if (!s->intervals) s->intervalCount = 0;
+		else qsort(s->intervals, (size_t)n, sizeof(LevelSpawnerInterval), CompareIntervals);
 	}
-	if (version != 1 && version != 2 && version != 3) {
-		fclose(f);
-		return false;
+	if (waveCount > LEVEL_MAX_WAVES) waveCount = LEVEL_MAX_WAVES;
+	if (waveCount > 0 && (s->waves = malloc((size_t)waveCount * sizeof(LevelWave)))) {
+		for (int i = 0; i < waveCount; ++i) {
+			const uint8_t *rec = wave + (size_t)i * LEVEL_WAVE_RECORD_BYTES;
+			s->waves[i] = (LevelWave){Get32(rec), Get32(rec + 4), Get16(rec + 8), Get16(rec + 10), Get16(rec + 12)};
+		}
+		s->waveCount = waveCount;
 	}
-	if (fread(&cols, sizeof(cols), 1, f) != 1) {
-		fclose(f);
-		return false;
+}
+
+uint32_t Level_SpawnerIntervalMs(const LevelEditorState *ed, int cx, int cy) {
+	const LevelSchedule *s = &ed->schedule;
+	int lo = 0, hi = s->intervalCount;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		const LevelSpawnerInterval *m = &s->intervals[mid];
+		if (m->cy < cy || (m->cy == cy && m->cx < cx)) lo = mid + 1;
+		else hi = mid;
 	}
-	if (fread(&rows, sizeof(rows), 1, f) != 1) {
-		fclose(f);
-		return false;
+	if (lo < s->intervalCount && s->intervals[lo].cx == cx && s->intervals[lo].cy == cy) return s->intervals[lo].ms;
+	return ROGUE_SPAWN_INTERVAL_MS;
+}
+
+static bool ParseChunked(const uint8_t *data, size_t size, const LevelHeaderV4 *h, LevelChunkTable *t) {
+	if (!(h->flags & LEVEL_FLAG_CHUNKED) || !ValidLevelSize(h->cols, h->rows)) return false;
+	if (!CheckSections(data, size, h)) return false;
+	const LevelSection *cidx = FindSection(h, "CIDX");
+	const LevelSection *cdat = FindSection(h, "CDAT");
+	if (!cidx || !cdat || cidx->size < LEVEL_CIDX_HEADER_BYTES) return false;
+	const uint8_t *idx = data + cidx->offset;
+	t->chunksX = Get16(idx + 2);
+	t->chunksY = Get16(idx + 4);
+	if (Get16(idx) != LEVEL_CHUNK_SIZE || t->chunksX != ChunksAlong(h->cols) || t->chunksY != ChunksAlong(h->rows)) return false;
+	const size_t chunks = (size_t)t->chunksX * t->chunksY;
+	if (cidx->size != LEVEL_CIDX_HEADER_BYTES + chunks * LEVEL_CIDX_RECORD_BYTES) return false;
+	t->index = idx + LEVEL_CIDX_HEADER_BYTES;
+	t->data = data + cdat->offset;
+	t->dataSize = cdat->size;
+	for (size_t i = 0; i < chunks; i++) {
+		const uint8_t *rec = t->index + i * LEVEL_CIDX_RECORD_BYTES;
+		uint32_t off = Get32(rec), n = Get32(rec + 4);
+		if (off > t->dataSize || n > t->dataSize - off) return false;
 	}
-	if (cols != GRID_COLS || rows != GRID_ROWS) {
-		fclose(f);
+	const LevelSection *spwn = FindSection(h, "SPWN");
+	t->spawners = spwn ? data + spwn->offset : NULL;
+	t->spawnerCount = spwn ? (int)(spwn->size / LEVEL_SPAWNER_RECORD_BYTES) : 0;
+	const LevelSection *wave = FindSection(h, "WAVE");
+	t->waves = wave ? data + wave->offset : NULL;
+	t->waveCount = wave ? (int)(wave->size / LEVEL_WAVE_RECORD_BYTES) : 0;
+	t->cols = h->cols;
+	t->rows = h->rows;
+	t->pcx = h->pcx;
+	t->pcy = h->pcy;
+	t->ecx = h->ecx;
+	t->ecy = h->ecy;
+	return true;
+}
+
+bool Level_ChunkTableFromMemory(const void *data, size_t size, LevelChunkTable *out) {
+	LevelHeaderV4 h;
+	if (!ParseHeaderV4(data, size, &h)) return false;
+	return ParseChunked(data, size, &h, out);
+}
+
+bool Level_DecodeChunk(const LevelChunkTable *t, int chunk, uint8_t *dst) {
+	if (chunk < 0 || chunk >= t->chunksX * t->chunksY) return false;
+	const uint8_t *rec = t->index + (size_t)chunk * LEVEL_CIDX_RECORD_BYTES;
+	const uint8_t *payload = t->data + Get32(rec);
+	const uint32_t n = Get32(rec + 4);
+	if (Crc32(0, payload, n) != Get32(rec + 8)) return false;
+	return DecodeTileBlock(payload, n, dst, LEVEL_CHUNK_SIZE, LEVEL_CHUNK_SIZE);
+}
+
+void Level_ChunkSpawnerCell(const LevelChunkTable *t, int i, int *cx, int *cy) {
+	const uint8_t *rec = t->spawners + (size_t)i * LEVEL_SPAWNER_RECORD_BYTES;
+	*cx = Get16(rec);
+	*cy = Get16(rec + 2);
+}
+
+// A chunked file loaded whole (editor, replay verification): decode every chunk into one grid
+static bool LoadChunkedFlat(const uint8_t *data, size_t size, const LevelHeaderV4 *h, GameState *game, LevelEditorState *ed) {
+	LevelChunkTable t;
+	if (!ParseChunked(data, size, h, &t)) return false;
+	uint8_t *tiles = malloc((size_t)t.cols * t.rows);
+	if (!tiles) return false;
+	uint8_t block[LEVEL_CHUNK_CELLS];
+	for (int chy = 0; chy < t.chunksY; ++chy)
+		for (int chx = 0; chx < t.chunksX; ++chx) {
+			if (!Level_DecodeChunk(&t, chy * t.chunksX + chx, block)) {
+				free(tiles);
+				return false;
+			}
+			int x0 = chx * LEVEL_CHUNK_SIZE, y0 = chy * LEVEL_CHUNK_SIZE;
+			int w = t.cols - x0 < LEVEL_CHUNK_SIZE ? t.cols - x0 : LEVEL_CHUNK_SIZE;
+			int hgt = t.rows - y0 < LEVEL_CHUNK_SIZE ? t.rows - y0 : LEVEL_CHUNK_SIZE;
+			for (int y = 0; y < hgt; ++y) memcpy(tiles + (size_t)(y0 + y) * t.cols + x0, block + y * LEVEL_CHUNK_SIZE, (size_t)w);
+		}
+	ApplyLoadedLevel(game, ed, t.cols, t.rows, t.pcx, t.pcy, t.ecx, t.ecy, tiles);
+	ApplySchedule(ed, t.spawners, t.spawnerCount, t.waves, t.waveCount);
+	return true;
+}
+
+static bool LoadV4(const uint8_t *data, size_t size, GameState *game, LevelEditorState *ed) {
+	LevelHeaderV4 h;
+	if (!ParseHeaderV4(data, size, &h)) return false;
+	if (!ValidLevelSize(h.cols, h.rows)) return false;
+	if (h.flags & LEVEL_FLAG_CHUNKED) return LoadChunkedFlat(data, size, &h, game, ed);
+	if (!CheckSections(data, size, &h)) return false;
+	const LevelSection *tiles = FindSection(&h, "TILE");
+	if (!tiles) return false;
+	uint8_t *decoded = malloc((size_t)h.cols * h.rows);
+	if (!decoded) return false;
+	if (!DecodeTileBlock(data + tiles->offset, tiles->size, decoded, h.cols, h.rows)) {
+		free(decoded);
 		return false;
 	}
-	int32_t px = 0, py = 0, ex = 0, ey = 0;
+	ApplyLoadedLevel(game, ed, h.cols, h.rows, h.pcx, h.pcy, h.ecx, h.ecy, decoded);
+	const LevelSection *spwn = FindSection(&h, "SPWN"), *wave = FindSection(&h, "WAVE");
+	ApplySchedule(ed, spwn ? data + spwn->offset : NULL, spwn ? (int)(spwn->size / LEVEL_SPAWNER_RECORD_BYTES) : 0,
+	              wave ? data + wave->offset : NULL, wave ? (int)(wave->size / LEVEL_WAVE_RECORD_BYTES) : 0);
+	return true;
+}
+
+static bool LoadLegacy(const uint8_t *data, size_t size, GameState *game, LevelEditorState *ed) {
+	ByteReader r = {data, data + size};
+	char magic[4];
+	uint8_t version = 0;
+	uint16_t cols = 0, rows = 0;
+	if (!Rd_Bytes(&r, magic, 4) || memcmp(magic, "LVL1", 4) != 0) return false;
+	if (!Rd_Bytes(&r, &version, 1)) return false;
+	if (version != 1 && version != 2 && version != 3) return false;
+	if (!Rd_Bytes(&r, &cols, sizeof(cols)) || !Rd_Bytes(&r, &rows, sizeof(rows))) return false;
+	if (!ValidLevelSize(cols, rows)) return false;
 	int pcx = 0, pcy = 0, ecx = 0, ecy = 0;
 	if (version == 1) {
-		if (fread(&px, sizeof(px), 1, f) != 1) {
-			fclose(f);
-			return false;
-		}
-		if (fread(&py, sizeof(py), 1, f) != 1) {
-			fclose(f);
-			return false;
-		}
-		if (fread(&ex, sizeof(ex), 1, f) != 1) {
-			fclose(f);
-			return false;
-		}
-		if (fread(&ey, sizeof(ey), 1, f) != 1) {
-			fclose(f);
-			return false;
-		}
+		int32_t pos[4];
+		if (!Rd_Bytes(&r, pos, sizeof(pos))) return false;
 		// Convert legacy world-pixel positions (baked with kLegacyV1SquareSize) to tile coords
-		pcx = (int)(px / kLegacyV1SquareSize);
-		pcy = (int)(py / kLegacyV1SquareSize);
-		ecx = (int)(ex / kLegacyV1SquareSize);
-		ecy = (int)(ey / kLegacyV1SquareSize);
+		pcx = (int)(pos[0] / kLegacyV1SquareSize);
+		pcy = (int)(pos[1] / kLegacyV1SquareSize);
+		ecx = (int)(pos[2] / kLegacyV1SquareSize);
+		ecy = (int)(pos[3] / kLegacyV1SquareSize);
 	} else {
-		uint16_t pcx16 = 0, pcy16 = 0, ecx16 = 0, ecy16 = 0;
-		if (fread(&pcx16, sizeof(pcx16), 1, f) != 1) {
-			fclose(f);
-			return false;
-		}
-		if (fread(&pcy16, sizeof(pcy16), 1, f) != 1) {
-			fclose(f);
-			return false;
-		}
-		if (fread(&ecx16, sizeof(ecx16), 1, f) != 1) {
-			fclose(f);
-			return false;
-		}
-		if (fread(&ecy16, sizeof(ecy16), 1, f) != 1) {
-			fclose(f);
-			return false;
-		}
-		pcx = (int)pcx16;
-		pcy = (int)pcy16;
-		ecx = (int)ecx16;
-		ecy = (int)ecy16;
+		uint16_t cells[4];
+		if (!Rd_Bytes(&r, cells, sizeof(cells))) return false;
+		pcx = (int)cells[0];
+		pcy = (int)cells[1];
+		ecx = (int)cells[2];
+		ecy = (int)cells[3];
 	}
-	// Clamp to grid and convert to world using current SQUARE_SIZE so placement scales with tile size
-	if (pcx < 0) pcx = 0;
-	if (pcx >= GRID_COLS) pcx = GRID_COLS - 1;
-	if (pcy < 0) pcy = 0;
-	if (pcy >= GRID_ROWS) pcy = GRID_ROWS - 1;
-	if (ecx < 0) ecx = 0;
-	if (ecx >= GRID_COLS) ecx = GRID_COLS - 1;
-	if (ecy < 0) ecy = 0;
-	if (ecy >= GRID_ROWS) ecy = GRID_ROWS - 1;
-	px = (int32_t)CellToWorld(pcx);
-	py = (int32_t)CellToWorld(pcy);
-	ex = (int32_t)CellToWorld(ecx);
-	ey = (int32_t)CellToWorld(ecy);
-	for (int y = 0; y < GRID_ROWS; ++y)
-		for (int x = 0; x < GRID_COLS; ++x) ed->tiles[y][x] = TILE_EMPTY;
-	for (int y = 0; y < GRID_ROWS; ++y)
-		for (int x = 0; x < GRID_COLS; ++x) {
-			uint8_t t;
-			if (fread(&t, 1, 1, f) != 1) {
-				fclose(f);
-				return false;
-			}
-			ed->tiles[y][x] = (TileType)t;
-		}
-	fclose(f);
-	game->playerPos = (Vector2){(float)px + (float)SQUARE_SIZE * 0.5f, (float)py + (float)SQUARE_SIZE * 0.5f};
-	game->exitPos = (Vector2){(float)ex, (float)ey};
+	// Validate the whole tile block up front so a truncated file leaves `ed` untouched
+	const size_t cells = (size_t)cols * rows;
+	if ((size_t)(r.end - r.p) < cells) return false;
+	uint8_t *tiles = malloc(cells);
+	if (!tiles) return false;
+	memcpy(tiles, r.p, cells);
+	ApplyLoadedLevel(game, ed, cols, rows, pcx, pcy, ecx, ecy, tiles);
+	return true;
+}
+
+bool Level_LoadFromMemory(const void *data, size_t size, GameState *game, LevelEditorState *ed) {
+	const uint8_t *p = data;
+	if (size < 5 || memcmp(p, "LVL1", 4) != 0) return false;
+	if (p[4] == 4) return LoadV4(p, size, game, ed);
+	return LoadLegacy(p, size, game, ed);
+}
+
+bool LoadLevelBinary(const char *path, GameState *game, LevelEditorState *ed) {
+	const unsigned char *packed;
+	size_t packedSize;
+	if (LevelPack_Lookup(path, &packed, &packedSize)) return Level_LoadFromMemory(packed, packedSize, game, ed);
+	FileMap fm;
+	if (!FileMap_Open(&fm, path)) return false;
+	bool ok = Level_LoadFromMemory(fm.data, fm.size, game, ed);
+	FileMap_Close(&fm);
+	return ok;
+}
+
+bool Level_LoadStreamed(const char *path, GameState *game, LevelEditorState *ed) {
+	FileMap fm = {0};
+	const unsigned char *packed;
+	size_t packedSize;
+	if (LevelPack_Lookup(path, &packed, &packedSize)) {
+		// Borrowed view of the pack mapping (no heap, not mapped), so closing it is a no-op
+		fm.data = packed;
+		fm.size = packedSize;
+	} else if (!FileMap_Open(&fm, path)) {
+		return false;
+	}
+	LevelChunkTable t;
+	if (!Level_ChunkTableFromMemory(fm.data, fm.size, &t)) {
+		bool ok = Level_LoadFromMemory(fm.data, fm.size, game, ed);
+		FileMap_Close(&fm);
+		return ok;
+	}
+	ChunkStream *cs = ChunkStream_Create(&fm, &t); // the stream keeps the mapping open
+	if (!cs) { // no memory or thread for streaming: load the whole level instead
+		bool ok = Level_LoadFromMemory(fm.data, fm.size, game, ed);
+		FileMap_Close(&fm);
+		return ok;
+	}
+	ApplyLoadedLevel(game, ed, t.cols, t.rows, t.pcx, t.pcy, t.ecx, t.ecy, NULL);
+	ApplySchedule(ed, t.spawners, t.spawnerCount, t.waves, t.waveCount);
+	ed->stream = cs;
+	ChunkStream_Prime(cs, game->playerPos);
+	return true;
+}
+
+bool Level_InfoFromMemory(const void *data, size_t size, LevelInfo *out) {
+	const uint8_t *p = data;
+	memset(out, 0, sizeof(*out));
+	if (size < 5 || memcmp(p, "LVL1", 4) != 0) return false;
+	if (p[4] == 4) {
+		LevelHeaderV4 h;
+		if (!ParseHeaderV4(p, size, &h)) return false;
+		out->version = 4;
+		out->cols = h.cols;
+		out->rows = h.rows;
+		out->spawnerCount = h.spawnerCount;
+		memcpy(out->name, h.name, LEVEL_NAME_MAX);
+		return true;
+	}
+	if (p[4] < 1 || p[4] > 3 || size < 9) return false;
+	uint16_t cols, rows;
+	memcpy(&cols, p + 5, sizeof(cols));
+	memcpy(&rows, p + 7, sizeof(rows));
+	out->version = p[4];
+	out->cols = cols;
+	out->rows = rows;
+	out->spawnerCount = -1;
 	return true;
 }
 
+bool Level_ReadInfo(const char *path, LevelInfo *out) {
+	const unsigned char *packed;
+	size_t packedSize;
+	if (LevelPack_Lookup(path, &packed, &packedSize)) return Level_InfoFromMemory(packed, packedSize, out);
+	FILE *f = fopen(path, "rb");
+	if (!f) return false;
+	uint8_t buf[LEVEL_V4_HEADER_MAX];
+	size_t n = fread(buf, 1, sizeof(buf), f);
+	fclose(f);
+	return Level_InfoFromMemory(buf, n, out);
+}
+
 // ---- Level catalog ----
 static int ParseLevelNumber(const char *baseName) {
 	if (!baseName) return -1;
@@ -289,10 +1097,10 @@ static int ParseLevelNumber(const char *baseName) {
 static void CatalogSortByNumber(LevelCatalog *cat) {
 	for (int i = 1; i < cat->count; ++i) {
 		LevelEntry key = cat->items[i];
-		int kn = ParseLevelNumber(key.baseName);
+		int kn = key.number;
 		int j = i - 1;
 		while (j >= 0) {
-			int jn = ParseLevelNumber(cat->items[j].baseName);
+			int jn = cat->items[j].number;
 			if (jn <= kn && !(jn == -1 && kn != -1)) break;
 			cat->items[j + 1] = cat->items[j];
 			--j;
@@ -301,55 +1109,161 @@ static void CatalogSortByNumber(LevelCatalog *cat) {
 	}
 }
 
-void ScanLevels(LevelCatalog *cat) {
-	cat->count = 0;
-
 #ifndef _WIN32
-	// Scan read-only bundled levels
-	{
-		DIR *d = opendir(LEVELS_DIR_READ);
-		if (d) {
-			struct dirent *ent;
-			while ((ent = readdir(d)) != NULL) {
-				const char *name = ent->d_name;
-				if (!name || name[0] == '.') continue;
-				size_t len = strlen(name);
-				if (len > 4 && strcmp(name + len - 4, ".lvl") == 0) {
-					LevelEntry *e = &cat->items[cat->count++];
-					snprintf(e->binPath, sizeof(e->binPath), "%s/%s", LEVELS_DIR_READ, name);
-					snprintf(e->baseName, sizeof(e->baseName), "%.*s", (int)(len - 4), name);
-					e->textPath[0] = '\0';
-					if (cat->count >= 256) break;
-				}
-			}
-			closedir(d);
+static int FindByBaseName(const LevelCatalog *cat, const char *baseName) {
+	for (int i = 0; i < cat->count; ++i)
+		if (strcmp(cat->items[i].baseName, baseName) == 0) return i;
+	return -1;
+}
+
+static long long DirStamp(const char *dir) {
+	struct stat st;
+	return stat(dir, &st) == 0 ? (long long)st.st_mtime : -1;
+}
+
+static const LevelEntry *FindPrevEntry(const LevelEntry *prev, int prevCount, const char *path) {
+	for (int i = 0; i < prevCount; ++i)
+		if (strcmp(prev[i].binPath, path) == 0) return &prev[i];
+	return NULL;
+}
+
+// Append the .lvl files of `dir`; headers are re-read only for files whose stamp changed
+static void ScanDir(LevelCatalog *cat, const char *dir, const LevelEntry *prev, int prevCount) {
+	DIR *d = opendir(dir);
+	if (!d) return;
+	struct dirent *ent;
+	while (cat->count < 256 && (ent = readdir(d)) != NULL) {
+		const char *name = ent->d_name;
+		if (!name || name[0] == '.') continue;
+		size_t len = strlen(name);
+		if (len <= 4 || strcmp(name + len - 4, ".lvl") != 0) continue;
+		LevelEntry *e = &cat->items[cat->count];
+		snprintf(e->binPath, sizeof(e->binPath), "%s/%s", dir, name);
+		snprintf(e->baseName, sizeof(e->baseName), "%.*s", (int)(len - 4), name);
+		e->textPath[0] = '\0';
+		e->number = ParseLevelNumber(e->baseName);
+		struct stat st;
+		if (stat(e->binPath, &st) != 0) continue;
+		e->mtime = (long long)st.st_mtime;
+		e->fileSize = (long long)st.st_size;
+		const LevelEntry *old = FindPrevEntry(prev, prevCount, e->binPath);
+		if (old && old->mtime == e->mtime && old->fileSize == e->fileSize) {
+			e->info = old->info;
+		} else if (!Level_ReadInfo(e->binPath, &e->info)) {
+			continue; // skip files with a bad or corrupt header
 		}
+		int same = FindByBaseName(cat, e->baseName);
+		if (same >= 0) cat->items[same] = *e; // user levels override pack/bundled ones of the same name
+		else cat->count++;
 	}
+	closedir(d);
+}
+#endif
 
-	// Scan writable user levels (may be same as read dir on desktop)
-	if (strcmp(LEVELS_DIR_WRITE, LEVELS_DIR_READ) != 0) {
-		DIR *d = opendir(LEVELS_DIR_WRITE);
-		if (d) {
-			struct dirent *ent;
-			while ((ent = readdir(d)) != NULL) {
-				const char *name = ent->d_name;
-				if (!name || name[0] == '.') continue;
-				size_t len = strlen(name);
-				if (len > 4 && strcmp(name + len - 4, ".lvl") == 0) {
-					LevelEntry *e = &cat->items[cat->count++];
-					snprintf(e->binPath, sizeof(e->binPath), "%s/%s", LEVELS_DIR_WRITE, name);
-					snprintf(e->baseName, sizeof(e->baseName), "%.*s", (int)(len - 4), name);
-					e->textPath[0] = '\0';
-					if (cat->count >= 256) break;
-				}
-			}
-			closedir(d);
-		}
+static void AddPackEntries(LevelCatalog *cat) {
+	int n = LevelPack_Count();
+	for (int i = 0; i < n && cat->count < 256; ++i) {
+		const char *name;
+		const unsigned char *data;
+		size_t size;
+		LevelEntry *e = &cat->items[cat->count];
+		if (!LevelPack_EntryAt(i, &name, &data, &size)) continue;
+		if (!Level_InfoFromMemory(data, size, &e->info)) continue;
+		snprintf(e->binPath, sizeof(e->binPath), "%s/%s.lvl", LEVEL_PACK_FILE, name);
+		snprintf(e->baseName, sizeof(e->baseName), "%s", name);
+		e->textPath[0] = '\0';
+		e->number = ParseLevelNumber(e->baseName);
+		e->mtime = 0;
+		e->fileSize = (long long)size;
+		cat->count++;
 	}
-	CatalogSortByNumber(cat);
+}
+
+static void ScanInto(LevelCatalog *cat, const LevelEntry *prev, int prevCount) {
+	cat->count = 0;
+	// Bundled levels come from the pack when there is one, else from LEVELS_DIR_READ; writable
+	// user levels go on top (LEVELS_DIR_READ may be the same directory on desktop)
+	bool packed = LevelPack_Count() > 0;
+	if (packed) AddPackEntries(cat);
+#ifndef _WIN32
+	if (!packed) ScanDir(cat, LEVELS_DIR_READ, prev, prevCount);
+	if (packed || strcmp(LEVELS_DIR_WRITE, LEVELS_DIR_READ) != 0) ScanDir(cat, LEVELS_DIR_WRITE, prev, prevCount);
 #else
-	(void)cat;
+	(void)prev;
+	(void)prevCount;
+#endif
+	CatalogSortByNumber(cat);
+}
+
+void ScanLevels(LevelCatalog *cat) {
+	ScanInto(cat, NULL, 0);
+}
+
+#ifdef LEVEL_CATALOG_INOTIFY
+static void StartWatching(LevelCatalog *cat) {
+	const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB;
+	cat->watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (cat->watchFd < 0) return;
+	bool ok = inotify_add_watch(cat->watchFd, LEVELS_DIR_READ, mask) >= 0;
+	if (ok && strcmp(LEVELS_DIR_WRITE, LEVELS_DIR_READ) != 0) ok = inotify_add_watch(cat->watchFd, LEVELS_DIR_WRITE, mask) >= 0;
+	if (!ok) {
+		close(cat->watchFd);
+		return;
+	}
+	cat->watching = true;
+}
+
+// Non-blocking: true when any event arrived since the last call
+static bool DrainWatch(LevelCatalog *cat) {
+	char buf[4096];
+	bool any = false;
+	while (read(cat->watchFd, buf, sizeof(buf)) > 0) any = true;
+	return any;
+}
 #endif
+
+bool Level_CatalogRefresh(LevelCatalog *cat, double now) {
+	bool dirty = !cat->scanned || cat->saveSerial != gLevelSaveSerial;
+#ifdef LEVEL_CATALOG_INOTIFY
+	if (!cat->scanned) StartWatching(cat);
+	if (cat->watching && DrainWatch(cat)) dirty = true;
+#endif
+	if (!cat->watching && now >= cat->nextPoll) {
+		cat->nextPoll = now + LEVEL_CATALOG_POLL_SECONDS;
+#ifndef _WIN32
+		if (cat->recheck || DirStamp(LEVELS_DIR_READ) != cat->dirStamp[0] || DirStamp(LEVELS_DIR_WRITE) != cat->dirStamp[1]) dirty = true;
+#endif
+	}
+	if (!dirty) return false;
+
+	LevelEntry *prev = NULL;
+	int prevCount = 0;
+	if (cat->count > 0 && (prev = malloc((size_t)cat->count * sizeof(LevelEntry))) != NULL) {
+		memcpy(prev, cat->items, (size_t)cat->count * sizeof(LevelEntry));
+		prevCount = cat->count;
+	}
+	ScanInto(cat, prev, prevCount);
+	free(prev);
+	cat->scanned = true;
+	cat->saveSerial = gLevelSaveSerial;
+#ifndef _WIN32
+	if (!cat->watching) {
+		// A change later in the same clock second leaves the mtime as is, so look once more
+		long long scanSecond = (long long)time(NULL);
+		cat->dirStamp[0] = DirStamp(LEVELS_DIR_READ);
+		cat->dirStamp[1] = DirStamp(LEVELS_DIR_WRITE);
+		cat->recheck = cat->dirStamp[0] >= scanSecond || cat->dirStamp[1] >= scanSecond;
+	}
+#endif
+	return true;
+}
+
+void Level_CatalogClose(LevelCatalog *cat) {
+#ifdef LEVEL_CATALOG_INOTIFY
+	if (cat->watching) close(cat->watchFd);
+#endif
+	cat->watching = false;
+	cat->scanned = false;
 }
 
 int FindNextLevelIndex(void) {
@@ -363,6 +1277,17 @@ int FindNextLevelIndex(void) {
 	return maxSeen + 1;
 }
 
+void Level_EditPath(const char *path, char *out, size_t outSz) {
+	if (!LevelPack_IsPackPath(path)) {
+		if (out != path) snprintf(out, outSz, "%s", path);
+		return;
+	}
+	const char *base = path + strlen(LEVEL_PACK_FILE "/");
+	char tmp[260];
+	snprintf(tmp, sizeof(tmp), "%s/%s", LEVELS_DIR_WRITE, base);
+	snprintf(out, outSz, "%s", tmp);
+}
+
 void MakeLevelPathFromIndex(int index0, char *out, size_t outSz) {
 	snprintf(out, outSz, "%s/level%d.lvl", LEVELS_DIR_WRITE, index0 + 1);
 }
@@ -3,6 +3,7 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "config.h"
 #include "raylib.h"
 
@@ -16,6 +17,7 @@
 #endif
 
 #define LEVEL_FILE_BIN LEVELS_DIR_WRITE "/level1.lvl"
+#define LEVEL_PACK_FILE "levels.glpack" // bundled levels (see levelpack.h); LEVELS_DIR_WRITE files overlay it
 
 // Tiles/tools
 typedef enum {
@@ -34,23 +36,83 @@ typedef enum {
 	TOOL_EXIT,
 	TOOL_LASER_TRAP,
 	TOOL_SPAWNER,
+	TOOL_RECT, // bulk tools paint with the last single-cell tile tool's tile
+	TOOL_LINE,
+	TOOL_FILL,
+	TOOL_STAMP,
 	TOOL_COUNT
 } EditorTool;
 
+struct ChunkStream;
+struct LevelJournal;
+struct LevelBake;
+
+// Cells of special tiles (cy * cols + cx), kept current by SetTile and by every bulk change
+// (load, resize, default level), so lookups never scan the grid. Empty for streamed levels.
+typedef struct LevelCellList {
+	int *cells; // ascending, i.e. row-major order
+	int count, cap;
+} LevelCellList;
+
+typedef struct LevelTileIndex {
+	int playerCount, exitCount;
+	int player, exit; // one TILE_PLAYER / TILE_EXIT cell, valid while the count is non-zero
+	LevelCellList spawners, hazards;
+	bool stale; // a list is missing cells (out of memory); rebuilt from the tiles at the next edit
+} LevelTileIndex;
+
+// Timed spawning from the level file: SPWN intervals that differ from ROGUE_SPAWN_INTERVAL_MS, and
+// WAVE records. Intervals are keyed by cell so they survive resizes; entries whose cell is no longer
+// a spawner are ignored, and the next save drops them.
+typedef struct LevelSpawnerInterval {
+	uint16_t cx, cy;
+	uint32_t ms; // 0: the spawner never fires on its own (waves can still use its cell)
+} LevelSpawnerInterval;
+
+typedef struct LevelWave {
+	uint32_t startMs; // first firing, counted from the start of the run
+	uint32_t repeatMs; // 0: fires once
+	uint16_t cx, cy; // cell the enemies appear in
+	uint16_t count; // enemies per firing
+} LevelWave;
+
+typedef struct LevelSchedule {
+	LevelSpawnerInterval *intervals; // sorted by (cy, cx)
+	int intervalCount;
+	LevelWave *waves; // at most LEVEL_MAX_WAVES, in file order
+	int waveCount;
+} LevelSchedule;
+
 typedef struct LevelEditorState {
 	Vector2 cursor;
-	TileType tiles[GRID_ROWS][GRID_COLS];
+	int cols, rows; // level size in tiles (GRID_COLS x GRID_ROWS for new levels)
+	uint8_t *tiles; // cols * rows TileType values, row-major, heap-owned (NULL when streamed)
+	struct ChunkStream *stream; // set for chunked levels opened for play; cells come from its cache
+	struct LevelJournal *journal; // edit log attached by the editor (levelsave.h); survives reloads
+	struct LevelHistory *history; // undo history attached by the editor (levelhistory.h); survives reloads
+	LevelTileIndex index;
+	struct LevelBake *bake; // derived data for play (levelbake.h); edits update it in place
+	int bulk; // Level_BeginBulk nesting depth
+	int dirtyX0, dirtyY0, dirtyX1, dirtyY1; // cells changed inside the bulk edit (x1 < x0: none)
+	unsigned revision; // bumped whenever the tiles change (edits, resize, load); never reset
+	LevelSchedule schedule; // read with the file and written back by saves; edits leave it alone
 	EditorTool tool;
 } LevelEditorState;
 
-extern LevelEditorState editor;
-extern char gLevelBinPath[260];
 extern bool gCreateNewRequested;
 
 // Tile helpers
-static inline bool InBoundsCell(int cx, int cy) {
-	return cx >= 0 && cy >= 0 && cx < GRID_COLS && cy < GRID_ROWS;
+static inline bool InBoundsCell(const LevelEditorState *ed, int cx, int cy) {
+	return cx >= 0 && cy >= 0 && cx < ed->cols && cy < ed->rows;
+}
+TileType ChunkStream_Tile(struct ChunkStream *cs, int cx, int cy); // chunkstream.c
+// Unchecked; callers must have tested InBoundsCell
+static inline TileType LevelTile(const LevelEditorState *ed, int cx, int cy) {
+	if (ed->stream) return ChunkStream_Tile(ed->stream, cx, cy);
+	return (TileType)ed->tiles[(size_t)cy * (size_t)ed->cols + (size_t)cx];
 }
+static inline float LevelPixelWidth(const LevelEditorState *ed) { return (float)(ed->cols * SQUARE_SIZE); }
+static inline float LevelPixelHeight(const LevelEditorState *ed) { return (float)(ed->rows * SQUARE_SIZE); }
 static inline int WorldToCellX(float x) { return (int)floorf(x / (float)SQUARE_SIZE); }
 static inline int WorldToCellY(float y) { return (int)floorf(y / (float)SQUARE_SIZE); }
 static inline float CellToWorld(int c) { return (float)(c * SQUARE_SIZE); }
@@ -71,15 +133,79 @@ static inline Rectangle TileSolidCollisionRect(int cx, int cy, TileType t) {
 	}
 }
 
+void LevelJournal_RecordSet(struct LevelJournal *j, int cx, int cy, TileType v); // levelsave.c
+void LevelJournal_RecordResize(struct LevelJournal *j, int cols, int rows);
+void LevelHistory_RecordSet(struct LevelHistory *h, int cx, int cy, TileType old, TileType v); // levelhistory.c
+void LevelHistory_RecordResize(struct LevelHistory *h, const LevelEditorState *ed, int cols, int rows); // before cells are dropped
+
+// Reallocate to cols x rows, keeping the overlapping top-left block; new cells are empty.
+// Fails (leaving the level untouched) outside 1..LEVEL_MAX_COLS/ROWS or when out of memory.
+bool Level_Resize(LevelEditorState *ed, int cols, int rows);
+void Level_Free(LevelEditorState *ed);
+// Bulk edits: inside Begin/End, SetTile still journals and records undo but defers the spawner/hazard
+// lists and the bake, which End then refreshes over the changed rectangle (plus a one-cell border for
+// autotiles) only. Nests.
+void Level_BeginBulk(LevelEditorState *ed);
+void Level_EndBulk(LevelEditorState *ed);
+
 void SetTile(LevelEditorState *ed, int cx, int cy, TileType v);
 TileType GetTile(const LevelEditorState *ed, int cx, int cy);
 void SetUniqueTile(LevelEditorState *ed, int cx, int cy, TileType v);
-bool FindTileWorldPos(const LevelEditorState *ed, TileType v, Vector2 *out);
+bool FindTileWorldPos(const LevelEditorState *ed, TileType v, Vector2 *out); // O(1) for indexed tiles
+const LevelCellList *Level_SpecialCells(const LevelEditorState *ed, TileType v); // spawners, hazards; NULL otherwise
+uint32_t Level_SpawnerIntervalMs(const LevelEditorState *ed, int cx, int cy); // ROGUE_SPAWN_INTERVAL_MS unless the file set one
 
 // Level IO
 struct GameState; // forward decl to avoid include cycle
-bool SaveLevelBinary(const struct GameState *game, const LevelEditorState *ed);
-bool LoadLevelBinary(struct GameState *game, LevelEditorState *ed);
+bool SaveLevelBinary(const char *path, const struct GameState *game, const LevelEditorState *ed);
+bool LoadLevelBinary(const char *path, struct GameState *game, LevelEditorState *ed);
+// The file image SaveLevelBinary would write (malloc'd, *size bytes); NULL on failure
+void *Level_SaveImage(const char *path, const struct GameState *game, const LevelEditorState *ed, size_t *size);
+// Replace `path` with `size` bytes atomically (temp file + rename), so readers and crashes never
+// see a partial file. Safe on any thread; pair with Level_NoteSaved on the main thread.
+bool Level_WriteImage(const char *path, const void *data, size_t size);
+void Level_NoteSaved(void); // main thread: catalogs rescan, web storage syncs
+void Level_SyncStorage(void); // web: persist IDBFS now (no-op elsewhere)
+// Parse/serialize a level image held in memory (file mapping, pack entry, test fixture, web FS read).
+// Loading validates the header, section CRCs and tile block before touching `ed` (v1-v4);
+// saving writes v4 and returns bytes written, 0 if cap is too small. `name` may be NULL.
+bool Level_LoadFromMemory(const void *data, size_t size, struct GameState *game, LevelEditorState *ed);
+size_t Level_SaveToMemory(const struct GameState *game, const LevelEditorState *ed, const char *name, void *out, size_t cap);
+
+// Open a level for play: chunked files stay mapped and are streamed in around the player
+// (see chunkstream.h); anything else loads whole like LoadLevelBinary.
+bool Level_LoadStreamed(const char *path, struct GameState *game, LevelEditorState *ed);
+
+// Chunked v4 levels: the validated chunk index of a file image. Chunks decode straight from that
+// image, so Level_DecodeChunk is safe to call from a loader thread while the image stays mapped.
+typedef struct LevelChunkTable {
+	int cols, rows;
+	int chunksX, chunksY;
+	int pcx, pcy, ecx, ecy;
+	const uint8_t *index; // chunksX * chunksY records
+	const uint8_t *data; // CDAT payload
+	size_t dataSize;
+	const uint8_t *spawners; // SPWN records, in row-major cell order
+	int spawnerCount;
+	const uint8_t *waves; // WAVE records (NULL when the file has none)
+	int waveCount;
+} LevelChunkTable;
+
+bool Level_ChunkTableFromMemory(const void *data, size_t size, LevelChunkTable *out); // false unless a valid chunked level
+bool Level_DecodeChunk(const LevelChunkTable *t, int chunk, uint8_t *dst); // dst: LEVEL_CHUNK_SIZE^2 cells; false on a bad CRC
+void Level_ChunkSpawnerCell(const LevelChunkTable *t, int i, int *cx, int *cy);
+
+// Header-only summary, for catalogs; never reads the tile payload
+#define LEVEL_NAME_MAX 32
+typedef struct LevelInfo {
+	int version;
+	int cols, rows;
+	int spawnerCount; // -1 when the format does not record it (v1-v3)
+	char name[LEVEL_NAME_MAX]; // empty before v4
+} LevelInfo;
+
+bool Level_InfoFromMemory(const void *data, size_t size, LevelInfo *out); // false on a bad magic/version or corrupt v4 header
+bool Level_ReadInfo(const char *path, LevelInfo *out); // reads just the header bytes
 void EnsureLevelsDir(void);
 void FillPerimeter(LevelEditorState *ed);
 void CreateDefaultLevel(struct GameState *game, LevelEditorState *ed);
@@ -89,16 +215,34 @@ typedef struct {
 	char baseName[128];
 	char binPath[260];
 	char textPath[260];
+	LevelInfo info;
+	int number; // 0-based index parsed from "levelN", -1 for other names
+	long long mtime, fileSize; // file stamp the cached info was read at
 } LevelEntry;
 
 typedef struct {
 	LevelEntry items[256];
 	int count;
+	// Change tracking for Level_CatalogRefresh (zero-initialized catalogs are fine)
+	bool scanned;
+	bool watching; // inotify is watching the level directories (Linux)
+	int watchFd;
+	long long dirStamp[2]; // read/write directory mtimes at the last scan (polling fallback)
+	bool recheck; // a directory changed within the scan's clock second; mtime cannot tell yet
+	double nextPoll;
+	unsigned saveSerial; // in-process saves seen at the last scan
 } LevelCatalog;
 
-void ScanLevels(LevelCatalog *cat);
+void ScanLevels(LevelCatalog *cat); // full rescan: pack entries, then level files overriding them by name
+// Rescan only when something changed: inotify on Linux, directory mtime polling every
+// LEVEL_CATALOG_POLL_SECONDS elsewhere, plus saves made by this process. Unchanged files keep
+// their cached header info. Returns true when the catalog was rebuilt. `now` is in seconds.
+bool Level_CatalogRefresh(LevelCatalog *cat, double now);
+void Level_CatalogClose(LevelCatalog *cat);
 int FindNextLevelIndex(void); // 0-based next index
+// Where edits to the level at `path` are saved: pack entries become files in LEVELS_DIR_WRITE
+void Level_EditPath(const char *path, char *out, size_t outSz);
 void MakeLevelPathFromIndex(int index0, char *out, size_t outSz);
 
 // Utils
-Vector2 SnapToGrid(Vector2 p);
+Vector2 SnapToGrid(const LevelEditorState *ed, Vector2 p); // cell top-left, clamped to the level
@@ -0,0 +1,329 @@
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#define _POSIX_C_SOURCE 200809L
+#define LEVEL_BAKE_THREADED 1
+#endif
+#include "levelbake.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "autotiler.h"
+#include "crc32.h"
+#include "game.h"
+#ifdef LEVEL_BAKE_THREADED
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <direct.h>
+#endif
+
+// Cached file = the in-memory block, host byte order (a foreign byte order fails the BOM and is rebuilt):
+//   "GRBK", u16 version, u16 0xFEFF, u32 key, u16 cols, u16 rows, u32 spawnerCount, u32 crc32 of the payload,
+//   u64 tile hash (a second, independent hash of the tiles: a key collision alone never loads a wrong bake)
+//   payload: solid words (rows * rowWords u32), autotile masks (cols * rows bytes, padded to 4),
+//            spawner cells (spawnerCount i32)
+static const char BAKE_MAGIC[4] = {'G', 'R', 'B', 'K'};
+#define BAKE_VERSION 2 // bump when the derived data changes meaning
+#define BAKE_BOM 0xFEFF
+#define BAKE_HEADER_BYTES 32
+
+typedef struct BakeLayout {
+	size_t solid, autotile, spawners, total; // byte offsets in the block, and its size
+} BakeLayout;
+
+static BakeLayout LayoutFor(int cols, int rows, int spawnerCount) {
+	BakeLayout l;
+	size_t rowWords = ((size_t)cols + 31) / 32;
+	size_t cells = (size_t)cols * rows;
+	l.solid = BAKE_HEADER_BYTES;
+	l.autotile = l.solid + (size_t)rows * rowWords * sizeof(uint32_t);
+	l.spawners = l.autotile + ((cells + 3) & ~(size_t)3);
+	l.total = l.spawners + (size_t)spawnerCount * sizeof(int32_t);
+	return l;
+}
+
+static uint32_t ContentKey(const LevelEditorState *ed) {
+	uint8_t dims[4] = {(uint8_t)ed->cols, (uint8_t)(ed->cols >> 8), (uint8_t)ed->rows, (uint8_t)(ed->rows >> 8)};
+	return Crc32(Crc32(0, dims, sizeof(dims)), ed->tiles, (size_t)ed->cols * ed->rows);
+}
+
+// FNV-1a over the tiles, stored inside the cached file and checked on load
+static uint64_t TileHash(const LevelEditorState *ed) {
+	uint64_t h = 0xCBF29CE484222325ull;
+	const uint8_t *t = ed->tiles;
+	for (size_t i = 0, n = (size_t)ed->cols * ed->rows; i < n; ++i) h = (h ^ t[i]) * 0x100000001B3ull;
+	return h;
+}
+
+// Point the fields at the arrays inside `block`
+static LevelBake *Wrap(void *block, size_t size, uint32_t key, int cols, int rows, int spawnerCount) {
+	LevelBake *b = malloc(sizeof(LevelBake));
+	if (!b) {
+		free(block);
+		return NULL;
+	}
+	BakeLayout l = LayoutFor(cols, rows, spawnerCount);
+	uint8_t *p = block;
+	b->key = key;
+	b->cols = cols;
+	b->rows = rows;
+	b->rowWords = (cols + 31) / 32;
+	b->solid = (const uint32_t *)(p + l.solid);
+	b->autotile = p + l.autotile;
+	b->spawners = (const int32_t *)(p + l.spawners);
+	b->spawnerCount = spawnerCount;
+	b->block = block;
+	b->size = size;
+	return b;
+}
+
+static inline bool SolidCell(const LevelEditorState *ed, int cx, int cy) {
+	return InBoundsCell(ed, cx, cy) && IsSolidTile(LevelTile(ed, cx, cy));
+}
+
+static uint8_t NeighborMask(const LevelEditorState *ed, int x, int y) {
+	uint8_t m = 0;
+	if (SolidCell(ed, x, y - 1)) m |= AUTOTILE_UP;
+	if (SolidCell(ed, x, y + 1)) m |= AUTOTILE_DOWN;
+	if (SolidCell(ed, x - 1, y)) m |= AUTOTILE_LEFT;
+	if (SolidCell(ed, x + 1, y)) m |= AUTOTILE_RIGHT;
+	if (SolidCell(ed, x - 1, y - 1)) m |= AUTOTILE_UP_LEFT;
+	if (SolidCell(ed, x + 1, y - 1)) m |= AUTOTILE_UP_RIGHT;
+	if (SolidCell(ed, x - 1, y + 1)) m |= AUTOTILE_DOWN_LEFT;
+	if (SolidCell(ed, x + 1, y + 1)) m |= AUTOTILE_DOWN_RIGHT;
+	return m;
+}
+
+static LevelBake *BuildWithKey(const LevelEditorState *ed, uint32_t key) {
+	if (!ed->tiles || ed->stream) return NULL;
+	const LevelCellList *spawners = Level_SpecialCells(ed, TILE_SPAWNER);
+	BakeLayout l = LayoutFor(ed->cols, ed->rows, spawners->count);
+	uint8_t *block = calloc(1, l.total);
+	if (!block) return NULL;
+	uint32_t *solid = (uint32_t *)(block + l.solid);
+	uint8_t *autotile = block + l.autotile;
+	const size_t rowWords = ((size_t)ed->cols + 31) / 32;
+	for (int y = 0; y < ed->rows; ++y)
+		for (int x = 0; x < ed->cols; ++x) {
+			if (!IsSolidTile(LevelTile(ed, x, y))) continue;
+			solid[(size_t)y * rowWords + (size_t)(x >> 5)] |= 1u << (x & 31);
+			autotile[(size_t)y * ed->cols + x] = NeighborMask(ed, x, y);
+		}
+	int32_t *cells = (int32_t *)(block + l.spawners);
+	for (int i = 0; i < spawners->count; ++i) cells[i] = spawners->cells[i];
+
+	memcpy(block, BAKE_MAGIC, 4);
+	uint16_t version = BAKE_VERSION, bom = BAKE_BOM, cols = (uint16_t)ed->cols, rows = (uint16_t)ed->rows;
+	uint32_t count = (uint32_t)spawners->count;
+	memcpy(block + 4, &version, 2);
+	memcpy(block + 6, &bom, 2);
+	memcpy(block + 8, &key, 4);
+	memcpy(block + 12, &cols, 2);
+	memcpy(block + 14, &rows, 2);
+	memcpy(block + 16, &count, 4);
+	uint32_t crc = Crc32(0, block + BAKE_HEADER_BYTES, l.total - BAKE_HEADER_BYTES);
+	memcpy(block + 20, &crc, 4);
+	uint64_t tileHash = TileHash(ed);
+	memcpy(block + 24, &tileHash, 8);
+	return Wrap(block, l.total, key, ed->cols, ed->rows, spawners->count);
+}
+
+LevelBake *LevelBake_Build(const LevelEditorState *ed) {
+	if (!ed->tiles || ed->stream) return NULL;
+	return BuildWithKey(ed, ContentKey(ed));
+}
+
+static bool SameSpawners(const LevelBake *b, const LevelCellList *l) {
+	if (b->spawnerCount != l->count) return false;
+	for (int i = 0; i < l->count; ++i)
+		if (b->spawners[i] != l->cells[i]) return false;
+	return true;
+}
+
+bool LevelBake_UpdateRegion(LevelBake *b, const LevelEditorState *ed, int x0, int y0, int x1, int y1) {
+	if (!ed->tiles || ed->stream || b->cols != ed->cols || b->rows != ed->rows) return false;
+	const LevelCellList *spawners = Level_SpecialCells(ed, TILE_SPAWNER);
+	if (!SameSpawners(b, spawners)) {
+		// The table ends the block, so only it moves
+		BakeLayout l = LayoutFor(b->cols, b->rows, spawners->count);
+		uint8_t *block = realloc(b->block, l.total);
+		if (!block) return false;
+		int32_t *cells = (int32_t *)(block + l.spawners);
+		for (int i = 0; i < spawners->count; ++i) cells[i] = spawners->cells[i];
+		uint32_t count = (uint32_t)spawners->count;
+		memcpy(block + 16, &count, 4);
+		b->solid = (const uint32_t *)(block + l.solid);
+		b->autotile = block + l.autotile;
+		b->spawners = cells;
+		b->spawnerCount = spawners->count;
+		b->block = block;
+		b->size = l.total;
+	}
+	// Solidity changed inside the rectangle; masks also change one cell around it
+	if (--x0 < 0) x0 = 0;
+	if (--y0 < 0) y0 = 0;
+	if (++x1 >= b->cols) x1 = b->cols - 1;
+	if (++y1 >= b->rows) y1 = b->rows - 1;
+	uint32_t *solid = (uint32_t *)b->solid;
+	uint8_t *autotile = (uint8_t *)b->autotile;
+	for (int y = y0; y <= y1; ++y)
+		for (int x = x0; x <= x1; ++x) {
+			uint32_t *word = &solid[(size_t)y * b->rowWords + (size_t)(x >> 5)];
+			bool s = IsSolidTile(LevelTile(ed, x, y));
+			if (s) *word |= 1u << (x & 31);
+			else *word &= ~(1u << (x & 31));
+			autotile[(size_t)y * b->cols + x] = s ? NeighborMask(ed, x, y) : 0;
+		}
+	b->key = 0; // edited in memory: no longer the content of any cached file
+	return true;
+}
+
+void LevelBake_Destroy(LevelBake *b) {
+	if (!b) return;
+	free(b->block);
+	free(b);
+}
+
+#ifndef PLATFORM_WEB
+static void BakePath(uint32_t key, int cols, int rows, char *out, size_t outSz) {
+	snprintf(out, outSz, "%s/%08x-%dx%d.bake", LEVEL_BAKE_DIR, (unsigned)key, cols, rows);
+}
+
+static LevelBake *LoadCached(const char *path, uint32_t key, const LevelEditorState *ed) {
+	const int cols = ed->cols, rows = ed->rows;
+	FILE *f = fopen(path, "rb");
+	if (!f) return NULL;
+	uint8_t header[BAKE_HEADER_BYTES];
+	uint16_t version = 0, bom = 0, fileCols = 0, fileRows = 0;
+	uint32_t fileKey = 0, count = 0, crc = 0;
+	uint64_t tileHash = 0;
+	bool ok = fread(header, 1, sizeof(header), f) == sizeof(header) && memcmp(header, BAKE_MAGIC, 4) == 0;
+	if (ok) {
+		memcpy(&version, header + 4, 2);
+		memcpy(&bom, header + 6, 2);
+		memcpy(&fileKey, header + 8, 4);
+		memcpy(&fileCols, header + 12, 2);
+		memcpy(&fileRows, header + 14, 2);
+		memcpy(&count, header + 16, 4);
+		memcpy(&crc, header + 20, 4);
+		memcpy(&tileHash, header + 24, 8);
+		ok = version == BAKE_VERSION && bom == BAKE_BOM && fileKey == key && fileCols == cols && fileRows == rows && count <= (uint32_t)cols * rows;
+		ok = ok && tileHash == TileHash(ed);
+	}
+	BakeLayout l = LayoutFor(cols, rows, (int)count);
+	uint8_t *block = ok ? malloc(l.total) : NULL;
+	ok = block != NULL;
+	if (ok) {
+		memcpy(block, header, sizeof(header));
+		ok = fread(block + BAKE_HEADER_BYTES, 1, l.total - BAKE_HEADER_BYTES, f) == l.total - BAKE_HEADER_BYTES;
+		ok = ok && Crc32(0, block + BAKE_HEADER_BYTES, l.total - BAKE_HEADER_BYTES) == crc;
+	}
+	fclose(f);
+	if (!ok) {
+		free(block);
+		return NULL;
+	}
+	return Wrap(block, l.total, key, cols, rows, (int)count);
+}
+
+static void EnsureBakeDir(void) {
+#ifndef _WIN32
+	mkdir(LEVEL_BAKE_DIR, 0755);
+#else
+	_mkdir(LEVEL_BAKE_DIR);
+#endif
+}
+#endif
+
+LevelBake *LevelBake_Acquire(const LevelEditorState *ed) {
+	if (!ed->tiles || ed->stream) return NULL;
+	uint32_t key = ContentKey(ed);
+#ifndef PLATFORM_WEB
+	char path[128];
+	BakePath(key, ed->cols, ed->rows, path, sizeof(path));
+	LevelBake *b = LoadCached(path, key, ed);
+	if (b) return b;
+	b = BuildWithKey(ed, key);
+	if (b) {
+		EnsureBakeDir();
+		Level_WriteImage(path, b->block, b->size); // a cache: failing to write only costs a rebuild
+	}
+	return b;
+#else
+	return BuildWithKey(ed, key);
+#endif
+}
+
+// ---- Build-time compile ----
+typedef struct BakeJobs {
+	const LevelCatalog *cat;
+	int next; // next catalog entry to claim
+	int baked;
+#ifdef LEVEL_BAKE_THREADED
+	pthread_mutex_t lock;
+#endif
+} BakeJobs;
+
+static bool BakeEntry(const LevelEntry *e) {
+	GameState game;
+	LevelEditorState ed;
+	memset(&game, 0, sizeof(game));
+	memset(&ed, 0, sizeof(ed));
+	bool ok = LoadLevelBinary(e->binPath, &game, &ed);
+	LevelBake *b = ok ? LevelBake_Acquire(&ed) : NULL;
+	ok = b != NULL;
+	LevelBake_Destroy(b);
+	Level_Free(&ed);
+	return ok;
+}
+
+static void *BakeWorker(void *arg) {
+	BakeJobs *jobs = arg;
+	for (;;) {
+#ifdef LEVEL_BAKE_THREADED
+		pthread_mutex_lock(&jobs->lock);
+#endif
+		int i = jobs->next < jobs->cat->count ? jobs->next++ : -1;
+#ifdef LEVEL_BAKE_THREADED
+		pthread_mutex_unlock(&jobs->lock);
+#endif
+		if (i < 0) return NULL;
+		bool ok = BakeEntry(&jobs->cat->items[i]);
+#ifdef LEVEL_BAKE_THREADED
+		pthread_mutex_lock(&jobs->lock);
+#endif
+		if (ok) jobs->baked++;
+#ifdef LEVEL_BAKE_THREADED
+		pthread_mutex_unlock(&jobs->lock);
+#endif
+	}
+}
+
+int LevelBake_All(const LevelCatalog *cat, int threads) {
+	BakeJobs jobs;
+	memset(&jobs, 0, sizeof(jobs));
+	jobs.cat = cat;
+#ifndef PLATFORM_WEB
+	EnsureBakeDir();
+#endif
+#ifdef LEVEL_BAKE_THREADED
+	if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads > cat->count) threads = cat->count;
+	if (threads > 64) threads = 64;
+	pthread_t workers[64];
+	int started = 0;
+	pthread_mutex_init(&jobs.lock, NULL);
+	for (; started < threads; ++started)
+		if (pthread_create(&workers[started], NULL, BakeWorker, &jobs) != 0) break;
+	if (started == 0) BakeWorker(&jobs); // no threads available: bake here
+	for (int i = 0; i < started; ++i) pthread_join(workers[i], NULL);
+	pthread_mutex_destroy(&jobs.lock);
+#else
+	(void)threads;
+	BakeWorker(&jobs);
+#endif
+	return jobs.baked;
+}
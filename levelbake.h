@@ -0,0 +1,37 @@
+// Baked levels: data derived from a level's tiles (solid bitsets, autotile masks, spawner table),
+// compiled once per level content and cached on disk, so play loads skip the derivation
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "level.h"
+
+#define LEVEL_BAKE_DIR "cache" // blobs named by content hash (desktop; the web bakes in memory)
+
+typedef struct LevelBake {
+	uint32_t key; // content hash of the tiles it was baked from (0 once updated in place)
+	int cols, rows;
+	int rowWords; // u32 words per row of `solid`
+	const uint32_t *solid; // bit (x & 31) of word y * rowWords + x / 32 is set when the cell is solid
+	const uint8_t *autotile; // per cell: Autotiler_NeighborMask for solid cells, 0 elsewhere
+	const int32_t *spawners; // spawner cells (cy * cols + cx), row-major
+	int spawnerCount;
+	void *block; // header + the arrays above: exactly the cached file
+	size_t size;
+} LevelBake;
+
+LevelBake *LevelBake_Build(const LevelEditorState *ed); // NULL for streamed levels or out of memory
+// The cached bake for ed's tiles, or a fresh one that is then written to the cache
+LevelBake *LevelBake_Acquire(const LevelEditorState *ed);
+// After cells x0..x1, y0..y1 of ed changed: update that rectangle plus a one-cell border and the
+// spawner table. False when the bake no longer fits ed (resized, out of memory): drop it.
+bool LevelBake_UpdateRegion(LevelBake *b, const LevelEditorState *ed, int x0, int y0, int x1, int y1);
+void LevelBake_Destroy(LevelBake *b);
+
+static inline bool LevelBake_SolidAt(const LevelBake *b, int cx, int cy) {
+	return (b->solid[(size_t)cy * b->rowWords + (size_t)(cx >> 5)] >> (cx & 31)) & 1u;
+}
+
+// Build-time compile: bake every catalog level into LEVEL_BAKE_DIR on `threads` workers
+// (<= 0: one per CPU). Returns the number of levels baked.
+int LevelBake_All(const LevelCatalog *cat, int threads);
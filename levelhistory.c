@@ -0,0 +1,274 @@
+#include "levelhistory.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+// Deltas are 6 bytes in the byte ring: u16 cx, u16 cy, u8 old, u8 new. A stroke's deltas are
+// contiguous (modulo the ring size) and strokes follow each other in order, so dropping the
+// oldest stroke only shrinks `used`.
+#define DELTA_BYTES 6
+
+typedef struct Stroke {
+	uint32_t start; // ring offset of its first delta
+	uint32_t count; // deltas
+	uint16_t fromCols, fromRows, toCols, toRows; // resize steps: the size before and after (0 otherwise)
+} Stroke;
+
+// Cells already in the open stroke, so repainting a cell updates its delta instead of adding one.
+// Entries from older strokes are stale by generation, which makes closing a stroke O(1).
+typedef struct CellSlot {
+	uint32_t gen;
+	uint32_t key; // cy << 16 | cx
+	uint32_t delta; // index in the open stroke
+} CellSlot;
+
+struct LevelHistory {
+	uint8_t ring[EDITOR_UNDO_BYTES];
+	uint32_t head; // ring offset of the next delta
+	uint32_t used; // bytes held by the kept strokes, ending at head
+	Stroke strokes[EDITOR_UNDO_STROKES];
+	int first; // oldest kept stroke in `strokes`
+	int count; // strokes kept: [0, done) are applied and undoable, [done, count) were undone
+	int done;
+	bool open; // stroke done - 1 is still collecting deltas
+	bool overflow; // the open stroke outgrew the ring and was dropped; ignore edits until it ends
+	bool replaying; // undo/redo in progress: its edits are not recorded
+	CellSlot *slots;
+	uint32_t slotCap, slotUsed, gen;
+};
+
+static struct LevelHistory gHistory;
+
+static inline Stroke *StrokeAt(struct LevelHistory *h, int i) {
+	return &h->strokes[(h->first + i) % EDITOR_UNDO_STROKES];
+}
+
+static inline uint32_t RingOffset(uint32_t start, uint32_t delta) {
+	return (uint32_t)(((uint64_t)start + (uint64_t)delta * DELTA_BYTES) % EDITOR_UNDO_BYTES);
+}
+
+static void PutDelta(struct LevelHistory *h, uint32_t at, int cx, int cy, uint8_t old, uint8_t v) {
+	uint8_t d[DELTA_BYTES] = {(uint8_t)cx, (uint8_t)(cx >> 8), (uint8_t)cy, (uint8_t)(cy >> 8), old, v};
+	for (int i = 0; i < DELTA_BYTES; ++i) h->ring[(at + i) % EDITOR_UNDO_BYTES] = d[i];
+}
+
+static void GetDelta(const struct LevelHistory *h, uint32_t at, int *cx, int *cy, uint8_t *old, uint8_t *v) {
+	uint8_t d[DELTA_BYTES];
+	for (int i = 0; i < DELTA_BYTES; ++i) d[i] = h->ring[(at + i) % EDITOR_UNDO_BYTES];
+	*cx = d[0] | (d[1] << 8);
+	*cy = d[2] | (d[3] << 8);
+	*old = d[4];
+	*v = d[5];
+}
+
+// ---- Open-stroke cell table ----
+static void ForgetCells(struct LevelHistory *h) {
+	h->slotUsed = 0;
+	if (++h->gen == 0) { // wrapped: old generations could look current again
+		if (h->slots) memset(h->slots, 0, (size_t)h->slotCap * sizeof(CellSlot));
+		h->gen = 1;
+	}
+}
+
+static CellSlot *FindCell(struct LevelHistory *h, uint32_t key) {
+	if (!h->slots) return NULL;
+	uint32_t mask = h->slotCap - 1;
+	for (uint32_t i = (key * 2654435761u) & mask;; i = (i + 1) & mask) {
+		CellSlot *s = &h->slots[i];
+		if (s->gen != h->gen) return s; // free: where the key would go
+		if (s->key == key) return s;
+	}
+}
+
+static bool GrowCells(struct LevelHistory *h) {
+	uint32_t cap = h->slotCap ? h->slotCap * 2 : 1024;
+	CellSlot *old = h->slots;
+	uint32_t oldCap = h->slotCap;
+	h->slots = calloc(cap, sizeof(CellSlot));
+	if (!h->slots) {
+		h->slots = old;
+		return false;
+	}
+	h->slotCap = cap;
+	for (uint32_t i = 0; i < oldCap; ++i) {
+		if (old[i].gen != h->gen) continue;
+		*FindCell(h, old[i].key) = old[i];
+	}
+	free(old);
+	return true;
+}
+
+// ---- Strokes ----
+static void DropOldest(struct LevelHistory *h) {
+	h->used -= StrokeAt(h, 0)->count * DELTA_BYTES;
+	h->first = (h->first + 1) % EDITOR_UNDO_STROKES;
+	h->count--;
+	h->done--;
+}
+
+static void Clear(struct LevelHistory *h) {
+	h->head = h->used = 0;
+	h->first = h->count = h->done = 0;
+	h->open = false;
+	ForgetCells(h);
+}
+
+// A new stroke ends the redo branch
+static Stroke *OpenStroke(struct LevelHistory *h) {
+	for (int i = h->done; i < h->count; ++i) {
+		uint32_t bytes = StrokeAt(h, i)->count * DELTA_BYTES;
+		h->used -= bytes;
+		h->head = (h->head + EDITOR_UNDO_BYTES - bytes) % EDITOR_UNDO_BYTES;
+	}
+	h->count = h->done;
+	if (h->count == EDITOR_UNDO_STROKES) DropOldest(h);
+	Stroke *s = StrokeAt(h, h->count);
+	memset(s, 0, sizeof(*s));
+	s->start = h->head;
+	h->count++;
+	h->done++;
+	h->open = true;
+	ForgetCells(h);
+	return s;
+}
+
+// Room for one more delta, dropping the oldest strokes; false when the open stroke alone fills the ring
+static bool MakeRoom(struct LevelHistory *h) {
+	while (h->used + DELTA_BYTES > EDITOR_UNDO_BYTES) {
+		if (h->done <= 1) return false;
+		DropOldest(h);
+	}
+	return true;
+}
+
+static bool AppendDelta(struct LevelHistory *h, Stroke *s, int cx, int cy, uint8_t old, uint8_t v) {
+	if (!MakeRoom(h)) {
+		Clear(h); // the stroke cannot be undone, and neither can anything before it
+		h->overflow = true;
+		return false;
+	}
+	PutDelta(h, h->head, cx, cy, old, v);
+	h->head = (h->head + DELTA_BYTES) % EDITOR_UNDO_BYTES;
+	h->used += DELTA_BYTES;
+	s->count++;
+	return true;
+}
+
+void LevelHistory_RecordSet(struct LevelHistory *h, int cx, int cy, TileType old, TileType v) {
+	if (h->replaying || h->overflow) return;
+	Stroke *s = h->open ? StrokeAt(h, h->done - 1) : OpenStroke(h);
+	uint32_t key = (uint32_t)cy << 16 | (uint32_t)cx;
+	if (h->slotUsed * 2 >= h->slotCap) GrowCells(h);
+	CellSlot *slot = h->slotUsed * 2 < h->slotCap ? FindCell(h, key) : NULL;
+	if (slot && slot->gen == h->gen) {
+		h->ring[(RingOffset(s->start, slot->delta) + 5) % EDITOR_UNDO_BYTES] = (uint8_t)v; // keep the stroke's first old value
+		return;
+	}
+	uint32_t index = s->count;
+	if (!AppendDelta(h, s, cx, cy, (uint8_t)old, (uint8_t)v)) return;
+	if (slot) {
+		*slot = (CellSlot){h->gen, key, index};
+		h->slotUsed++;
+	}
+}
+
+void LevelHistory_RecordResize(struct LevelHistory *h, const LevelEditorState *ed, int cols, int rows) {
+	if (h->replaying) return;
+	h->open = false;
+	h->overflow = false;
+	Stroke *s = OpenStroke(h);
+	s->fromCols = (uint16_t)ed->cols;
+	s->fromRows = (uint16_t)ed->rows;
+	s->toCols = (uint16_t)cols;
+	s->toRows = (uint16_t)rows;
+	// Keep the non-empty cells the resize drops: right of the new width, then below the new height
+	for (int y = 0; ed->tiles && y < ed->rows; ++y)
+		for (int x = y < rows ? cols : 0; x < ed->cols; ++x) {
+			TileType t = LevelTile(ed, x, y);
+			if (t != TILE_EMPTY && !AppendDelta(h, s, x, y, (uint8_t)t, TILE_EMPTY)) return;
+		}
+	h->open = false;
+}
+
+void LevelHistory_EndStroke(LevelEditorState *ed) {
+	struct LevelHistory *h = ed->history;
+	if (!h) return;
+	h->overflow = false;
+	if (!h->open) return;
+	h->open = false;
+	// Drop a stroke that painted cells back to what they were
+	Stroke *s = StrokeAt(h, h->done - 1);
+	if (s->fromCols) return;
+	for (uint32_t i = 0; i < s->count; ++i) {
+		int cx, cy;
+		uint8_t old, v;
+		GetDelta(h, RingOffset(s->start, i), &cx, &cy, &old, &v);
+		if (old != v) return;
+	}
+	h->used -= s->count * DELTA_BYTES;
+	h->head = s->start;
+	h->count--;
+	h->done--;
+}
+
+bool LevelHistory_Undo(LevelEditorState *ed) {
+	struct LevelHistory *h = ed->history;
+	if (!h) return false;
+	LevelHistory_EndStroke(ed);
+	if (h->done == 0) return false;
+	Stroke *s = StrokeAt(h, h->done - 1);
+	h->replaying = true;
+	Level_BeginBulk(ed);
+	if (s->fromCols) Level_Resize(ed, s->fromCols, s->fromRows);
+	for (uint32_t i = s->count; i-- > 0;) {
+		int cx, cy;
+		uint8_t old, v;
+		GetDelta(h, RingOffset(s->start, i), &cx, &cy, &old, &v);
+		SetTile(ed, cx, cy, (TileType)old);
+	}
+	Level_EndBulk(ed);
+	h->replaying = false;
+	h->done--;
+	return true;
+}
+
+bool LevelHistory_Redo(LevelEditorState *ed) {
+	struct LevelHistory *h = ed->history;
+	if (!h) return false;
+	LevelHistory_EndStroke(ed);
+	if (h->done == h->count) return false;
+	Stroke *s = StrokeAt(h, h->done);
+	h->replaying = true;
+	Level_BeginBulk(ed);
+	for (uint32_t i = 0; i < s->count; ++i) {
+		int cx, cy;
+		uint8_t old, v;
+		GetDelta(h, RingOffset(s->start, i), &cx, &cy, &old, &v);
+		SetTile(ed, cx, cy, (TileType)v);
+	}
+	if (s->fromCols) Level_Resize(ed, s->toCols, s->toRows);
+	Level_EndBulk(ed);
+	h->replaying = false;
+	h->done++;
+	return true;
+}
+
+void LevelHistory_Counts(const LevelEditorState *ed, int *undo, int *redo) {
+	const struct LevelHistory *h = ed->history;
+	*undo = h ? h->done : 0;
+	*redo = h ? h->count - h->done : 0;
+}
+
+void LevelHistory_Attach(LevelEditorState *ed) {
+	Clear(&gHistory);
+	gHistory.overflow = false;
+	gHistory.replaying = false;
+	ed->history = &gHistory;
+}
+
+void LevelHistory_Detach(LevelEditorState *ed) {
+	if (ed->history != &gHistory) return;
+	ed->history = NULL;
+	Clear(&gHistory);
+}
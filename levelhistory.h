@@ -0,0 +1,16 @@
+// Editor undo/redo: every stroke (one press of the paint button, one resize step) is kept as its
+// per-cell deltas in a fixed-size ring, so memory stays bounded and undo touches only those cells
+#pragma once
+#include <stdbool.h>
+#include "level.h"
+
+// Start an empty history recording the edits made to `ed` (SetTile and Level_Resize)
+void LevelHistory_Attach(LevelEditorState *ed);
+void LevelHistory_Detach(LevelEditorState *ed);
+// Close the stroke being recorded; the next edit starts a new one
+void LevelHistory_EndStroke(LevelEditorState *ed);
+// Revert / reapply one stroke through SetTile and Level_Resize (so the journal sees them).
+// False when there is nothing to undo / redo.
+bool LevelHistory_Undo(LevelEditorState *ed);
+bool LevelHistory_Redo(LevelEditorState *ed);
+void LevelHistory_Counts(const LevelEditorState *ed, int *undo, int *redo); // strokes available
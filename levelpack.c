@@ -0,0 +1,226 @@
+#include "levelpack.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc32.h"
+#include "filemap.h"
+#include "level.h"
+
+// File layout (little-endian):
+//   "GLPK" u16 version, u16 reserved, u32 entryCount, u32 crc32 of the index
+//   index: entryCount x (char name[LEVEL_PACK_NAME_MAX] NUL-padded, u32 offset, u32 size, u32 crc32, u32 reserved),
+//          sorted by name (strcmp) for binary search
+//   payloads: the level files, verbatim
+static const char PACK_MAGIC[4] = {'G', 'L', 'P', 'K'};
+#define PACK_VERSION 1
+#define PACK_HEADER_BYTES 16
+#define PACK_ENTRY_BYTES (LEVEL_PACK_NAME_MAX + 16)
+
+static struct {
+	bool tried;
+	bool ok;
+	FileMap file;
+	const uint8_t *index;
+	uint32_t count;
+} gPack;
+
+static inline uint32_t Get32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static inline void Put16(uint8_t *p, uint16_t v) {
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+static inline void Put32(uint8_t *p, uint32_t v) {
+	for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static const uint8_t *EntryRecord(uint32_t i) {
+	return gPack.index + (size_t)i * PACK_ENTRY_BYTES;
+}
+
+// Bounds, NUL-terminated names and strict ordering, so lookups never need to re-check
+static bool ValidateIndex(const uint8_t *data, size_t size) {
+	if (size < PACK_HEADER_BYTES || memcmp(data, PACK_MAGIC, 4) != 0) return false;
+	if ((data[4] | (data[5] << 8)) != PACK_VERSION) return false;
+	uint32_t count = Get32(data + 8);
+	if (count > (size - PACK_HEADER_BYTES) / PACK_ENTRY_BYTES) return false;
+	const uint8_t *index = data + PACK_HEADER_BYTES;
+	if (Crc32(0, index, (size_t)count * PACK_ENTRY_BYTES) != Get32(data + 12)) return false;
+	for (uint32_t i = 0; i < count; i++) {
+		const uint8_t *e = index + (size_t)i * PACK_ENTRY_BYTES;
+		if (e[0] == '\0' || memchr(e, '\0', LEVEL_PACK_NAME_MAX) == NULL) return false;
+		uint32_t off = Get32(e + LEVEL_PACK_NAME_MAX), len = Get32(e + LEVEL_PACK_NAME_MAX + 4);
+		if (off > size || len > size - off) return false;
+		if (i > 0 && strcmp((const char *)(e - PACK_ENTRY_BYTES), (const char *)e) >= 0) return false;
+	}
+	gPack.index = index;
+	gPack.count = count;
+	return true;
+}
+
+static bool PackOpen(void) {
+	if (gPack.tried) return gPack.ok;
+	gPack.tried = true;
+	if (!FileMap_Open(&gPack.file, LEVEL_PACK_FILE)) return false;
+	gPack.ok = ValidateIndex(gPack.file.data, gPack.file.size);
+	if (!gPack.ok) FileMap_Close(&gPack.file);
+	return gPack.ok;
+}
+
+int LevelPack_Count(void) {
+	return PackOpen() ? (int)gPack.count : 0;
+}
+
+bool LevelPack_EntryAt(int i, const char **name, const unsigned char **data, size_t *size) {
+	if (!PackOpen() || i < 0 || (uint32_t)i >= gPack.count) return false;
+	const uint8_t *e = EntryRecord((uint32_t)i);
+	*name = (const char *)e;
+	*data = gPack.file.data + Get32(e + LEVEL_PACK_NAME_MAX);
+	*size = Get32(e + LEVEL_PACK_NAME_MAX + 4);
+	return true;
+}
+
+// "<LEVEL_PACK_FILE>/<name>.lvl" -> name; false for anything else
+static bool PackPathName(const char *path, char *name) {
+	static const char prefix[] = LEVEL_PACK_FILE "/";
+	if (!path || strncmp(path, prefix, sizeof(prefix) - 1) != 0) return false;
+	const char *base = path + sizeof(prefix) - 1;
+	size_t len = strlen(base);
+	if (len <= 4 || strcmp(base + len - 4, ".lvl") != 0 || len - 4 >= LEVEL_PACK_NAME_MAX) return false;
+	memcpy(name, base, len - 4);
+	name[len - 4] = '\0';
+	return true;
+}
+
+bool LevelPack_IsPackPath(const char *path) {
+	char name[LEVEL_PACK_NAME_MAX];
+	return PackPathName(path, name);
+}
+
+bool LevelPack_Lookup(const char *path, const unsigned char **data, size_t *size) {
+	char name[LEVEL_PACK_NAME_MAX];
+	if (!PackPathName(path, name) || !PackOpen()) return false;
+	uint32_t lo = 0, hi = gPack.count;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		const uint8_t *e = EntryRecord(mid);
+		int c = strcmp(name, (const char *)e);
+		if (c == 0) {
+			const uint8_t *p = gPack.file.data + Get32(e + LEVEL_PACK_NAME_MAX);
+			size_t n = Get32(e + LEVEL_PACK_NAME_MAX + 4);
+			if (Crc32(0, p, n) != Get32(e + LEVEL_PACK_NAME_MAX + 8)) return false;
+			*data = p;
+			*size = n;
+			return true;
+		}
+		if (c < 0) hi = mid;
+		else lo = mid + 1;
+	}
+	return false;
+}
+
+// ---- Packer ----
+typedef struct PackInput {
+	char name[LEVEL_PACK_NAME_MAX];
+	FileMap file;
+} PackInput;
+
+static int CompareInputs(const void *a, const void *b) {
+	return strcmp(((const PackInput *)a)->name, ((const PackInput *)b)->name);
+}
+
+static bool InputName(const char *path, char *out) {
+	const char *base = strrchr(path, '/');
+	base = base ? base + 1 : path;
+	size_t len = strlen(base);
+	if (len > 4 && strcmp(base + len - 4, ".lvl") == 0) len -= 4;
+	if (len == 0 || len >= LEVEL_PACK_NAME_MAX) return false;
+	memcpy(out, base, len);
+	out[len] = '\0';
+	return true;
+}
+
+static bool WritePack(FILE *f, PackInput *in, int count) {
+	size_t indexBytes = (size_t)count * PACK_ENTRY_BYTES;
+	uint8_t *head = calloc(1, PACK_HEADER_BYTES + indexBytes);
+	if (!head) return false;
+	uint8_t *index = head + PACK_HEADER_BYTES;
+	size_t offset = PACK_HEADER_BYTES + indexBytes;
+	bool ok = true;
+	for (int i = 0; i < count; i++) {
+		uint8_t *e = index + (size_t)i * PACK_ENTRY_BYTES;
+		memcpy(e, in[i].name, strlen(in[i].name));
+		if (offset + in[i].file.size > UINT32_MAX) ok = false;
+		Put32(e + LEVEL_PACK_NAME_MAX, (uint32_t)offset);
+		Put32(e + LEVEL_PACK_NAME_MAX + 4, (uint32_t)in[i].file.size);
+		Put32(e + LEVEL_PACK_NAME_MAX + 8, Crc32(0, in[i].file.data, in[i].file.size));
+		offset += in[i].file.size;
+	}
+	memcpy(head, PACK_MAGIC, 4);
+	Put16(head + 4, PACK_VERSION);
+	Put32(head + 8, (uint32_t)count);
+	Put32(head + 12, Crc32(0, index, indexBytes));
+	ok = ok && fwrite(head, 1, PACK_HEADER_BYTES + indexBytes, f) == PACK_HEADER_BYTES + indexBytes;
+	for (int i = 0; ok && i < count; i++) ok = fwrite(in[i].file.data, 1, in[i].file.size, f) == in[i].file.size;
+	free(head);
+	return ok;
+}
+
+bool LevelPack_Write(const char *outPath, char *const *inputs, int count, char *err, size_t errSz) {
+	if (count <= 0) {
+		snprintf(err, errSz, "no levels to pack");
+		return false;
+	}
+	PackInput *in = calloc((size_t)count, sizeof(PackInput));
+	if (!in) {
+		snprintf(err, errSz, "out of memory");
+		return false;
+	}
+	bool ok = true;
+	int opened = 0;
+	for (; ok && opened < count; opened++) {
+		PackInput *p = &in[opened];
+		LevelInfo info;
+		if (!InputName(inputs[opened], p->name)) {
+			snprintf(err, errSz, "%s: name must be 1..%d characters", inputs[opened], LEVEL_PACK_NAME_MAX - 1);
+			ok = false;
+		} else if (!FileMap_Open(&p->file, inputs[opened])) {
+			snprintf(err, errSz, "%s: cannot read", inputs[opened]);
+			ok = false;
+		} else if (!Level_InfoFromMemory(p->file.data, p->file.size, &info)) {
+			snprintf(err, errSz, "%s: not a level file", inputs[opened]);
+			ok = false;
+		}
+	}
+	if (ok) {
+		qsort(in, (size_t)count, sizeof(PackInput), CompareInputs);
+		for (int i = 1; ok && i < count; i++) {
+			if (strcmp(in[i - 1].name, in[i].name) == 0) {
+				snprintf(err, errSz, "duplicate level name '%s'", in[i].name);
+				ok = false;
+			}
+		}
+	}
+	if (ok) {
+		// Write beside the target and rename, so a failed pack never replaces a good one
+		char tmp[512];
+		snprintf(tmp, sizeof(tmp), "%s.tmp", outPath);
+		FILE *f = fopen(tmp, "wb");
+		ok = f != NULL;
+		if (ok) {
+			ok = WritePack(f, in, count);
+			if (fclose(f) != 0) ok = false;
+#ifdef _WIN32
+			if (ok) remove(outPath); // rename does not replace on Windows
+#endif
+			if (ok) ok = rename(tmp, outPath) == 0;
+			if (!ok) remove(tmp);
+		}
+		if (!ok) snprintf(err, errSz, "%s: write failed", outPath);
+	}
+	for (int i = 0; i < opened; i++) FileMap_Close(&in[i].file);
+	free(in);
+	return ok;
+}
@@ -0,0 +1,20 @@
+// Level pack (.glpack): bundled levels in one mmapped file, looked up by name with no per-level syscalls
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+// Pack entries are addressed as LEVEL_PACK_FILE "/" name ".lvl", so catalog paths, replays and
+// LoadLevelBinary treat them like files.
+#define LEVEL_PACK_NAME_MAX 48 // including the terminating NUL
+
+// The pack is opened (mapped once, index validated) on first use and stays mapped until exit.
+// All queries return false/0 when LEVEL_PACK_FILE is missing or corrupt.
+int LevelPack_Count(void);
+bool LevelPack_EntryAt(int i, const char **name, const unsigned char **data, size_t *size); // in name order
+// Resolve a pack path to its payload; checks the entry CRC
+bool LevelPack_Lookup(const char *path, const unsigned char **data, size_t *size);
+bool LevelPack_IsPackPath(const char *path);
+
+// Build a pack from level files; entries are named after the file name without ".lvl".
+// On failure writes a message to err and leaves no pack at outPath.
+bool LevelPack_Write(const char *outPath, char *const *inputs, int count, char *err, size_t errSz);
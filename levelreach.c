@@ -0,0 +1,384 @@
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#define _POSIX_C_SOURCE 200809L
+#define LEVEL_REACH_THREADED 1
+#endif
+#include "levelreach.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "game.h"
+#include "player.h"
+#include "render.h"
+#include "worker.h"
+#include "world.h"
+#ifdef LEVEL_REACH_THREADED
+#include <pthread.h>
+#endif
+
+// Search granularity: states in the same half-cell, velocity bucket and ground/crouch/hang state
+// count as one. A step holds one input until the state leaves its bucket (at most
+// REACH_STEP_TICKS fixed ticks), so slow acceleration still gets somewhere. Coarser buckets finish
+// sooner but keep only the first state to reach each bucket, so a few tight paths can be missed.
+#define REACH_STEP_TICKS 60
+#define REACH_POS_QUANT ((float)SQUARE_SIZE / 2.0f)
+#define REACH_VX_QUANT 128.0f
+#define REACH_VY_QUANT 256.0f
+#define REACH_SLICE 256 // expansions between checks for a newer request (per frame without a worker)
+
+// Jump inputs press on the first tick of the step and hold for the rest; a following step without
+// jump releases it, which cuts the jump like a short tap
+static const PlayerInput kActions[] = {
+	{0},
+	{.left = true},
+	{.right = true},
+	{.jumpDown = true},
+	{.left = true, .jumpDown = true},
+	{.right = true, .jumpDown = true},
+	{.down = true},
+};
+#define REACH_ACTIONS ((int)(sizeof(kActions) / sizeof(kActions[0])))
+
+typedef struct Bytes {
+	uint8_t *p;
+	size_t cap;
+} Bytes;
+
+static bool Reserve(Bytes *b, size_t n) {
+	if (n <= b->cap) return true;
+	uint8_t *p = realloc(b->p, n);
+	if (!p) return false;
+	b->p = p;
+	b->cap = n;
+	return true;
+}
+
+typedef struct ResultBuf {
+	LevelReachResult r;
+	Bytes cells; // r.cells points here
+} ResultBuf;
+
+// One analysis, run by the worker (or by LevelReach_Update where there is none)
+typedef struct Search {
+	World *world; // private and headless; its level views `tiles`
+	Bytes tiles; // the request being analyzed
+	int cols, rows;
+	unsigned revision;
+	int player, exit; // cells of the start and exit tiles, -1 when missing
+	Bytes cells; // reach map being built, then the one of prevTiles
+	GameState *states; // BFS queue: [next, count) wait to be expanded
+	int count, cap, next;
+	uint64_t *keys; // quantized states seen, open addressing (0: free)
+	uint32_t keyCap, keyCount;
+	bool partial;
+	bool running; // a fresh search is in progress
+	Bytes prevTiles; // tiles `cells` was finished for
+	int prevCols, prevRows, prevPlayer;
+	bool havePrev;
+} Search;
+
+static Search gSearch;
+static ResultBuf gFront, gReady, gBack; // main thread / handoff / search side
+static bool gReadyFresh = false; // gReady holds a result the main thread has not taken
+
+static Bytes gJob; // newest request: a copy of the editor tiles
+static int gJobCols, gJobRows;
+static unsigned gJobRevision;
+static bool gJobPending = false;
+
+static bool gPosted = false; // main thread: a request was made for gPostedRevision
+static unsigned gPostedRevision;
+
+#ifdef LEVEL_REACH_THREADED
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER; // guards the job and gReady
+static pthread_cond_t gWake = PTHREAD_COND_INITIALIZER; // a job was posted
+static Worker gWorker;
+#endif
+
+static inline void Lock(void) {
+#ifdef LEVEL_REACH_THREADED
+	pthread_mutex_lock(&gLock);
+#endif
+}
+
+static inline void Unlock(void) {
+#ifdef LEVEL_REACH_THREADED
+	pthread_mutex_unlock(&gLock);
+#endif
+}
+
+// ---- State set ----
+static int Bucket(float v, float quant) {
+	int b = (int)floorf(v / quant) + 16;
+	return b < 0 ? 0 : (b > 31 ? 31 : b);
+}
+
+static uint64_t StateKey(const GameState *g) {
+	uint64_t k = (uint64_t)((int)(g->playerPos.x / REACH_POS_QUANT) & 0x3FFF);
+	k = k << 14 | (uint64_t)((int)(g->playerPos.y / REACH_POS_QUANT) & 0x3FFF);
+	k = k << 5 | (uint64_t)Bucket(g->playerVel.x, REACH_VX_QUANT);
+	k = k << 5 | (uint64_t)Bucket(g->playerVel.y, REACH_VY_QUANT);
+	const bool flags[] = {g->onGround, g->crouching, g->edgeHang};
+	for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); ++i) k = k << 1 | (uint64_t)flags[i];
+	return k | 1ull << 63; // never 0, which marks a free slot
+}
+
+static uint64_t *FindKey(Search *s, uint64_t key) {
+	uint32_t mask = s->keyCap - 1;
+	for (uint32_t i = (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;; i = (i + 1) & mask)
+		if (s->keys[i] == 0 || s->keys[i] == key) return &s->keys[i];
+}
+
+static bool GrowKeys(Search *s) {
+	uint32_t oldCap = s->keyCap;
+	uint64_t *old = s->keys;
+	s->keyCap = oldCap ? oldCap * 2 : 4096;
+	s->keys = calloc(s->keyCap, sizeof(uint64_t));
+	if (!s->keys) {
+		s->keys = old;
+		s->keyCap = oldCap;
+		return false;
+	}
+	for (uint32_t i = 0; i < oldCap; ++i)
+		if (old[i]) *FindKey(s, old[i]) = old[i];
+	free(old);
+	return true;
+}
+
+// Queue a state unless an equivalent one was seen
+static void Push(Search *s, const GameState *g) {
+	if ((s->keyCount + 1) * 2 > s->keyCap && !GrowKeys(s)) {
+		s->partial = true;
+		return;
+	}
+	uint64_t *slot = FindKey(s, StateKey(g));
+	if (*slot) return;
+	if (s->count == s->cap) {
+		int cap = s->cap ? s->cap * 2 : 1024;
+		if (cap > LEVEL_REACH_MAX_STATES) cap = LEVEL_REACH_MAX_STATES;
+		GameState *states = s->count < cap ? realloc(s->states, (size_t)cap * sizeof(GameState)) : NULL;
+		if (!states) {
+			s->partial = true;
+			return;
+		}
+		s->states = states;
+		s->cap = cap;
+	}
+	*slot = StateKey(g);
+	s->keyCount++;
+	s->states[s->count++] = *g;
+}
+
+// ---- Search ----
+static int FindCell(const Search *s, TileType t) {
+	for (int i = 0; i < s->cols * s->rows; ++i)
+		if (s->tiles.p[i] == t) return i;
+	return -1;
+}
+
+// Mark the cells under the player's body; false when it touches a laser (the same test as UpdateGame)
+static bool MarkBody(Search *s) {
+	World *w = s->world;
+	Rectangle pb = PlayerAABB(w);
+	int x0 = WorldToCellX(pb.x), x1 = WorldToCellX(pb.x + pb.width);
+	int y0 = WorldToCellY(pb.y), y1 = WorldToCellY(pb.y + pb.height);
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 >= s->cols) x1 = s->cols - 1;
+	if (y1 >= s->rows) y1 = s->rows - 1;
+	for (int y = y0; y <= y1; ++y)
+		for (int x = x0; x <= x1; ++x) {
+			if (!IsHazardTile((TileType)s->tiles.p[y * s->cols + x])) continue;
+			if (CheckCollisionRecs(pb, LaserCollisionRect((Vector2){CellToWorld(x), CellToWorld(y)}))) return false;
+		}
+	for (int y = y0; y <= y1; ++y) memset(s->cells.p + (size_t)y * s->cols + x0, 1, (size_t)(x1 - x0 + 1));
+	return true;
+}
+
+static void Expand(Search *s, int index) {
+	World *w = s->world;
+	const GameState from = s->states[index]; // Push may move the queue
+	const uint64_t fromKey = StateKey(&from);
+	for (int a = 0; a < REACH_ACTIONS; ++a) {
+		w->game = from;
+		bool alive = true;
+		for (int t = 0; t < REACH_STEP_TICKS && alive; ++t) {
+			w->input = kActions[a];
+			w->input.jumpPressed = w->input.jumpDown && t == 0;
+			UpdatePlayer(w, BASE_DT);
+			alive = MarkBody(s);
+			if (StateKey(&w->game) != fromKey) break;
+		}
+		if (alive) Push(s, &w->game);
+	}
+}
+
+static int TileKind(uint8_t t) {
+	return IsSolidTile((TileType)t) ? 1 : (IsHazardTile((TileType)t) ? 2 : 0);
+}
+
+// The previous reach map still holds when the start is unchanged and no cell within one cell of it
+// changed how it collides: the body moves less than a cell per tick and every physics probe
+// reaches at most a cell past it, so the search never looked at anything further out
+static bool PrevStillHolds(const Search *s) {
+	if (!s->havePrev || s->prevCols != s->cols || s->prevRows != s->rows || s->prevPlayer != s->player) return false;
+	for (int i = 0; i < s->cols * s->rows; ++i) {
+		if (TileKind(s->tiles.p[i]) == TileKind(s->prevTiles.p[i])) continue;
+		int cx = i % s->cols, cy = i / s->cols;
+		for (int y = cy - 1; y <= cy + 1; ++y)
+			for (int x = cx - 1; x <= cx + 1; ++x)
+				if (x >= 0 && y >= 0 && x < s->cols && y < s->rows && s->cells.p[y * s->cols + x]) return false;
+	}
+	return true;
+}
+
+// Set up the search for s->tiles; false when there is nothing to step (the result is ready)
+static bool BeginSearch(Search *s) {
+	if (!s->world) {
+		s->world = malloc(sizeof(World));
+		if (!s->world) return false;
+		World_Init(s->world);
+		s->world->headless = true;
+	}
+	LevelEditorState *lv = &s->world->level; // tiles only: physics falls back to them without a bake
+	lv->tiles = s->tiles.p;
+	lv->cols = s->cols;
+	lv->rows = s->rows;
+	s->player = FindCell(s, TILE_PLAYER);
+	s->exit = FindCell(s, TILE_EXIT);
+	if (PrevStillHolds(s)) return false;
+	size_t n = (size_t)s->cols * s->rows;
+	s->havePrev = false;
+	s->count = s->next = 0;
+	s->partial = false;
+	if (s->keys) memset(s->keys, 0, (size_t)s->keyCap * sizeof(uint64_t));
+	s->keyCount = 0;
+	if (!Reserve(&s->cells, n)) return false;
+	memset(s->cells.p, 0, n);
+	if (s->player < 0) return false;
+	GameState start;
+	memset(&start, 0, sizeof(start));
+	Game_ResetVisuals(&start);
+	start.facingRight = true;
+	start.playerPos = (Vector2){CellToWorld(s->player % s->cols) + (float)SQUARE_SIZE * 0.5f, CellToWorld(s->player / s->cols) + (float)SQUARE_SIZE * 0.5f};
+	s->world->game = start;
+	if (MarkBody(s)) Push(s, &start);
+	return s->count > 0;
+}
+
+static bool StepSearch(Search *s, int budget) {
+	while (budget-- > 0 && s->next < s->count) Expand(s, s->next++);
+	return s->next >= s->count;
+}
+
+// Publish the reach map for s->tiles, which becomes the base for the next incremental check
+static void FinishSearch(Search *s) {
+	size_t n = (size_t)s->cols * s->rows;
+	if (s->cells.cap < n || !Reserve(&gBack.cells, n)) return;
+	memcpy(gBack.cells.p, s->cells.p, n);
+	LevelReachResult *r = &gBack.r;
+	r->revision = s->revision;
+	r->cols = s->cols;
+	r->rows = s->rows;
+	r->cells = gBack.cells.p;
+	r->hasPlayer = s->player >= 0;
+	r->hasExit = s->exit >= 0;
+	r->exitReachable = s->exit >= 0 && s->cells.p[s->exit];
+	r->partial = s->partial;
+	r->states = s->count;
+	Bytes t = s->prevTiles;
+	s->prevTiles = s->tiles;
+	s->tiles = t;
+	s->prevCols = s->cols;
+	s->prevRows = s->rows;
+	s->prevPlayer = s->player;
+	s->havePrev = true;
+	Lock();
+	ResultBuf tmp = gReady;
+	gReady = gBack;
+	gBack = tmp;
+	gReadyFresh = true;
+	Unlock();
+}
+
+// Lock held: move the newest request into the search
+static void TakeJob(Search *s) {
+	Bytes t = s->tiles;
+	s->tiles = gJob;
+	gJob = t;
+	s->cols = gJobCols;
+	s->rows = gJobRows;
+	s->revision = gJobRevision;
+	gJobPending = false;
+}
+
+#ifdef LEVEL_REACH_THREADED
+static void *WorkerMain(void *arg) {
+	(void)arg;
+	pthread_mutex_lock(&gLock);
+	for (;;) {
+		while (!gJobPending) pthread_cond_wait(&gWake, &gLock);
+		TakeJob(&gSearch);
+		pthread_mutex_unlock(&gLock);
+		bool done = !BeginSearch(&gSearch);
+		while (!done) {
+			done = StepSearch(&gSearch, REACH_SLICE);
+			pthread_mutex_lock(&gLock);
+			bool newer = gJobPending; // edited again: this result would be stale
+			pthread_mutex_unlock(&gLock);
+			if (newer) break;
+		}
+		if (done) FinishSearch(&gSearch);
+		pthread_mutex_lock(&gLock);
+	}
+	return NULL;
+}
+
+static bool WorkerRunning(void) { return Worker_Running(&gWorker, WorkerMain); }
+#endif
+
+void LevelReach_Update(const LevelEditorState *ed) {
+	bool searchHere = true;
+#ifdef LEVEL_REACH_THREADED
+	searchHere = !WorkerRunning();
+#endif
+	if (ed->tiles && (!gPosted || ed->revision != gPostedRevision)) {
+		size_t n = (size_t)ed->cols * ed->rows;
+		Lock();
+		if (Reserve(&gJob, n)) {
+			memcpy(gJob.p, ed->tiles, n);
+			gJobCols = ed->cols;
+			gJobRows = ed->rows;
+			gJobRevision = ed->revision;
+			gJobPending = true;
+			gPosted = true;
+			gPostedRevision = ed->revision;
+#ifdef LEVEL_REACH_THREADED
+			if (!searchHere) pthread_cond_signal(&gWake);
+#endif
+		}
+		Unlock();
+	}
+	if (searchHere) {
+		if (gJobPending) {
+			TakeJob(&gSearch);
+			gSearch.running = BeginSearch(&gSearch);
+			if (!gSearch.running) FinishSearch(&gSearch);
+		} else if (gSearch.running && StepSearch(&gSearch, REACH_SLICE)) {
+			gSearch.running = false;
+			FinishSearch(&gSearch);
+		}
+	}
+	Lock();
+	if (gReadyFresh) {
+		ResultBuf tmp = gFront;
+		gFront = gReady;
+		gReady = tmp;
+		gReadyFresh = false;
+	}
+	Unlock();
+}
+
+const LevelReachResult *LevelReach_Result(void) {
+	return &gFront.r;
+}
@@ -0,0 +1,23 @@
+// Editor reachability: the cells the player can get to from the TILE_PLAYER start, found by a
+// breadth-first search over quantized movement states that steps the real player physics.
+// Runs on a worker thread and is redone after edits; enemies are not simulated.
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "level.h"
+
+typedef struct LevelReachResult {
+	unsigned revision; // LevelEditorState.revision of the tiles it was computed from
+	int cols, rows;
+	const uint8_t *cells; // cols * rows, non-zero where the player's body can be (NULL: no result yet)
+	bool hasPlayer, hasExit;
+	bool exitReachable;
+	bool partial; // stopped at LEVEL_REACH_MAX_STATES: more cells may be reachable
+	int states; // distinct movement states explored
+} LevelReachResult;
+
+// Editor, once per frame: queue an analysis when ed's tiles changed since the last request and pick
+// up finished results (and, where there is no worker thread, run a slice of the search here)
+void LevelReach_Update(const LevelEditorState *ed);
+// The newest finished result; it describes the current tiles when revision == ed->revision
+const LevelReachResult *LevelReach_Result(void);
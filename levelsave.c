@@ -0,0 +1,402 @@
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#define _POSIX_C_SOURCE 200809L
+#define LEVEL_SAVE_THREADED 1
+#endif
+#include "levelsave.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc32.h"
+#include "filemap.h"
+#include "worker.h"
+#ifdef LEVEL_SAVE_THREADED
+#include <pthread.h>
+#endif
+
+// Journal layout (little-endian): "GRJ1", u32 crc32 and u32 size of the level file the records
+// apply to (both 0 when it did not exist yet), then 8-byte records:
+//   u8 op, u8 tile, u16 a, u16 b, u8 reserved, u8 check (0x5A ^ XOR of the first 7 bytes)
+// A record torn by a crash fails its check and replay stops there.
+static const char JOURNAL_MAGIC[4] = {'G', 'R', 'J', '1'};
+#define JOURNAL_HEADER_BYTES 12
+#define JOURNAL_RECORD_BYTES 8
+enum { JOURNAL_OP_SET = 1, JOURNAL_OP_RESIZE = 2 };
+
+struct LevelJournal {
+	bool active; // between Begin and the next Begin (or End with nothing left to save)
+	bool attached; // recording edits of the editor level
+	char levelPath[260];
+	char path[268];
+	FILE *file; // append handle, opened with the first record
+	uint32_t baseCrc, baseSize; // level file the records apply to
+	uint8_t *records;
+	size_t count, cap;
+	size_t written; // records already appended to `file`
+	uint32_t firstSeq; // sequence number of records[0]; saves remember the sequence they include
+	int recovered;
+	bool failed; // a record was lost to OOM: journaling is off until a save at or after lostSeq lands
+	bool saveDue; // failed since LevelJournal_TakeSaveDue last asked
+	uint32_t lostSeq;
+	bool unsynced; // web: records written since the last storage sync
+	double nextSync;
+};
+
+typedef struct SaveJob {
+	char path[260];
+	uint8_t *image;
+	size_t size;
+	uint32_t crc;
+	bool journaled; // the journal's level: on success drop the records before journalSeq
+	uint32_t journalSeq;
+	bool ok;
+	struct SaveJob *next;
+} SaveJob;
+
+static struct {
+	SaveJob *queue, *queueTail; // waiting for the writer, oldest first
+	SaveJob *busy; // being written
+	SaveJob *done, *doneTail; // written (or failed), waiting to be retired on the main thread
+	bool failed;
+#ifdef LEVEL_SAVE_THREADED
+	Worker writer;
+#endif
+} gSaver;
+static struct LevelJournal gJournal;
+
+#ifdef LEVEL_SAVE_THREADED
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER; // guards the job lists
+static pthread_cond_t gWake = PTHREAD_COND_INITIALIZER; // a job was queued
+static pthread_cond_t gFinished = PTHREAD_COND_INITIALIZER; // a job was written
+#endif
+
+static inline void Lock(void) {
+#ifdef LEVEL_SAVE_THREADED
+	pthread_mutex_lock(&gLock);
+#endif
+}
+
+static inline void Unlock(void) {
+#ifdef LEVEL_SAVE_THREADED
+	pthread_mutex_unlock(&gLock);
+#endif
+}
+
+static inline uint32_t Get32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static inline void Put32(uint8_t *p, uint32_t v) {
+	for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// Caller holds the lock
+static void PushDone(SaveJob *job) {
+	job->next = NULL;
+	if (gSaver.doneTail) gSaver.doneTail->next = job;
+	else gSaver.done = job;
+	gSaver.doneTail = job;
+}
+
+#ifdef LEVEL_SAVE_THREADED
+static void *WriterMain(void *arg) {
+	(void)arg;
+	pthread_mutex_lock(&gLock);
+	for (;;) {
+		while (!gSaver.queue) pthread_cond_wait(&gWake, &gLock);
+		SaveJob *job = gSaver.queue;
+		gSaver.queue = job->next;
+		if (!gSaver.queue) gSaver.queueTail = NULL;
+		gSaver.busy = job;
+		pthread_mutex_unlock(&gLock);
+		job->ok = Level_WriteImage(job->path, job->image, job->size);
+		pthread_mutex_lock(&gLock);
+		gSaver.busy = NULL;
+		PushDone(job);
+		pthread_cond_broadcast(&gFinished);
+	}
+	return NULL;
+}
+
+// Exit after LevelSave_Flush loses nothing
+static bool WriterRunning(void) { return Worker_Running(&gSaver.writer, WriterMain); }
+#endif
+
+// ---- Journal ----
+static uint8_t RecordCheck(const uint8_t *r) {
+	uint8_t c = 0x5A;
+	for (int i = 0; i < JOURNAL_RECORD_BYTES - 1; i++) c ^= r[i];
+	return c;
+}
+
+static bool JournalAppend(struct LevelJournal *j, const uint8_t *record) {
+	if (j->count == j->cap) {
+		size_t cap = j->cap ? j->cap * 2 : 256;
+		uint8_t *grown = realloc(j->records, cap * JOURNAL_RECORD_BYTES);
+		if (!grown) return false;
+		j->records = grown;
+		j->cap = cap;
+	}
+	memcpy(j->records + j->count * JOURNAL_RECORD_BYTES, record, JOURNAL_RECORD_BYTES);
+	j->count++;
+	return true;
+}
+
+// An edit could not be recorded. Records with a gap would replay into a level that never existed,
+// so drop them all (the caller rewrites the file) and ask for a full save past the lost edit.
+static void JournalLose(struct LevelJournal *j) {
+	j->firstSeq += (uint32_t)j->count + 1;
+	j->count = 0;
+	j->lostSeq = j->firstSeq;
+	j->failed = true;
+	j->saveDue = true;
+}
+
+// Replace the file with the header and the records still held (or remove it when there are none)
+static void JournalRewrite(struct LevelJournal *j) {
+	if (j->file) fclose(j->file);
+	j->file = NULL;
+	j->written = 0;
+	if (j->count == 0) {
+		remove(j->path);
+		return;
+	}
+	size_t bytes = JOURNAL_HEADER_BYTES + j->count * JOURNAL_RECORD_BYTES;
+	uint8_t *buf = malloc(bytes);
+	if (!buf) return;
+	memcpy(buf, JOURNAL_MAGIC, 4);
+	Put32(buf + 4, j->baseCrc);
+	Put32(buf + 8, j->baseSize);
+	memcpy(buf + JOURNAL_HEADER_BYTES, j->records, j->count * JOURNAL_RECORD_BYTES);
+	bool ok = Level_WriteImage(j->path, buf, bytes);
+	free(buf);
+	if (!ok || (j->file = fopen(j->path, "ab")) == NULL) return;
+	j->written = j->count;
+	j->unsynced = true;
+}
+
+static void JournalRecord(struct LevelJournal *j, int op, int tile, int a, int b) {
+	if (!j->attached) return;
+	uint8_t r[JOURNAL_RECORD_BYTES] = {(uint8_t)op, (uint8_t)tile, (uint8_t)a, (uint8_t)(a >> 8), (uint8_t)b, (uint8_t)(b >> 8), 0, 0};
+	r[JOURNAL_RECORD_BYTES - 1] = RecordCheck(r);
+	if (j->failed) {
+		JournalLose(j); // still unjournaled: the pending full save has to include this edit too
+	} else if (!JournalAppend(j, r)) {
+		JournalLose(j);
+		JournalRewrite(j);
+	}
+}
+
+void LevelJournal_RecordSet(struct LevelJournal *j, int cx, int cy, TileType v) {
+	JournalRecord(j, JOURNAL_OP_SET, (int)v, cx, cy);
+}
+
+void LevelJournal_RecordResize(struct LevelJournal *j, int cols, int rows) {
+	JournalRecord(j, JOURNAL_OP_RESIZE, 0, cols, rows);
+}
+
+static void JournalReset(struct LevelJournal *j) {
+	if (j->file) fclose(j->file);
+	free(j->records);
+	memset(j, 0, sizeof(*j));
+}
+
+// A save that includes the records before `seq` reached disk: they are no longer needed
+static void JournalRebase(struct LevelJournal *j, uint32_t crc, uint32_t size, uint32_t seq) {
+	if (!j->active) return;
+	size_t drop = seq > j->firstSeq ? seq - j->firstSeq : 0;
+	if (drop > j->count) drop = j->count;
+	memmove(j->records, j->records + drop * JOURNAL_RECORD_BYTES, (j->count - drop) * JOURNAL_RECORD_BYTES);
+	j->count -= drop;
+	j->firstSeq += (uint32_t)drop;
+	j->baseCrc = crc;
+	j->baseSize = size;
+	j->recovered = 0;
+	if (j->failed && seq >= j->lostSeq) j->failed = false; // every lost edit is on disk now
+	JournalRewrite(j);
+	if (!j->attached && j->count == 0) JournalReset(j);
+}
+
+static void JournalSync(struct LevelJournal *j, double now) {
+	if (j->active && j->written < j->count) {
+		if (!j->file) {
+			JournalRewrite(j);
+		} else {
+			size_t n = j->count - j->written;
+			if (fwrite(j->records + j->written * JOURNAL_RECORD_BYTES, JOURNAL_RECORD_BYTES, n, j->file) == n) j->written = j->count;
+			fflush(j->file);
+			j->unsynced = true;
+		}
+	}
+	if (j->unsynced && now >= j->nextSync) {
+		Level_SyncStorage();
+		j->unsynced = false;
+		j->nextSync = now + LEVEL_JOURNAL_SYNC_SECONDS;
+	}
+}
+
+// ---- Saves ----
+static void Retire(SaveJob *job) {
+	while (job) {
+		SaveJob *next = job->next;
+		if (job->ok) {
+			Level_NoteSaved();
+			if (job->journaled) JournalRebase(&gJournal, job->crc, (uint32_t)job->size, job->journalSeq);
+		}
+		gSaver.failed = !job->ok;
+		free(job->image);
+		free(job);
+		job = next;
+	}
+}
+
+static SaveJob *TakeDone(void) {
+	Lock();
+	SaveJob *done = gSaver.done;
+	gSaver.done = gSaver.doneTail = NULL;
+	Unlock();
+	return done;
+}
+
+bool LevelSave_Queue(const char *path, const GameState *game, const LevelEditorState *ed) {
+	size_t size = 0;
+	uint8_t *image = Level_SaveImage(path, game, ed, &size);
+	SaveJob *job = image ? calloc(1, sizeof(SaveJob)) : NULL;
+	if (!job) {
+		free(image);
+		gSaver.failed = true;
+		return false;
+	}
+	snprintf(job->path, sizeof(job->path), "%s", path);
+	job->image = image;
+	job->size = size;
+	job->crc = Crc32(0, image, size);
+	job->journaled = gJournal.active && strcmp(path, gJournal.levelPath) == 0;
+	job->journalSeq = gJournal.firstSeq + (uint32_t)gJournal.count;
+#ifdef LEVEL_SAVE_THREADED
+	if (WriterRunning()) {
+		pthread_mutex_lock(&gLock);
+		for (SaveJob *q = gSaver.queue; q; q = q->next) {
+			if (strcmp(q->path, path) != 0) continue;
+			// Not started yet: write the newer snapshot in its place
+			free(q->image);
+			q->image = job->image;
+			q->size = job->size;
+			q->crc = job->crc;
+			q->journaled = job->journaled;
+			q->journalSeq = job->journalSeq;
+			pthread_mutex_unlock(&gLock);
+			free(job);
+			return true;
+		}
+		if (gSaver.queueTail) gSaver.queueTail->next = job;
+		else gSaver.queue = job;
+		gSaver.queueTail = job;
+		pthread_cond_signal(&gWake);
+		pthread_mutex_unlock(&gLock);
+		return true;
+	}
+#endif
+	job->ok = Level_WriteImage(job->path, job->image, job->size);
+	Lock();
+	PushDone(job);
+	Unlock();
+	return true;
+}
+
+void LevelSave_Poll(double now) {
+	Retire(TakeDone());
+	JournalSync(&gJournal, now);
+}
+
+void LevelSave_Flush(void) {
+#ifdef LEVEL_SAVE_THREADED
+	pthread_mutex_lock(&gLock);
+	while (gSaver.queue || gSaver.busy) pthread_cond_wait(&gFinished, &gLock);
+	pthread_mutex_unlock(&gLock);
+#endif
+	Retire(TakeDone());
+}
+
+bool LevelSave_Busy(void) {
+	Lock();
+	bool busy = gSaver.queue || gSaver.busy || gSaver.done;
+	Unlock();
+	return busy;
+}
+
+bool LevelSave_LastFailed(void) {
+	return gSaver.failed;
+}
+
+// ---- Journal lifecycle ----
+static bool ReplayRecord(const uint8_t *r, LevelEditorState *ed) {
+	if (RecordCheck(r) != r[JOURNAL_RECORD_BYTES - 1]) return false;
+	int a = r[2] | (r[3] << 8), b = r[4] | (r[5] << 8);
+	switch (r[0]) {
+	case JOURNAL_OP_SET:
+		if (r[1] > TILE_SPAWNER || !InBoundsCell(ed, a, b)) return false;
+		SetTile(ed, a, b, (TileType)r[1]);
+		return true;
+	case JOURNAL_OP_RESIZE:
+		return Level_Resize(ed, a, b);
+	default:
+		return false;
+	}
+}
+
+int LevelJournal_Begin(const char *path, GameState *game, LevelEditorState *ed) {
+	LevelSave_Flush();
+	struct LevelJournal *j = &gJournal;
+	JournalReset(j);
+	snprintf(j->levelPath, sizeof(j->levelPath), "%s", path);
+	snprintf(j->path, sizeof(j->path), "%s.jnl", path);
+	FileMap fm;
+	if (FileMap_Open(&fm, path)) {
+		j->baseCrc = Crc32(0, fm.data, fm.size);
+		j->baseSize = (uint32_t)fm.size;
+		FileMap_Close(&fm);
+	}
+	// Replay only onto the exact file the records were made against; a stale journal is dropped
+	int replayed = 0;
+	if (FileMap_Open(&fm, j->path)) {
+		const uint8_t *p = fm.data;
+		if (fm.size >= JOURNAL_HEADER_BYTES && memcmp(p, JOURNAL_MAGIC, 4) == 0 && Get32(p + 4) == j->baseCrc && Get32(p + 8) == j->baseSize) {
+			ed->journal = NULL;
+			for (size_t at = JOURNAL_HEADER_BYTES; at + JOURNAL_RECORD_BYTES <= fm.size; at += JOURNAL_RECORD_BYTES) {
+				if (!ReplayRecord(p + at, ed)) break;
+				replayed++;
+				if (!j->failed && !JournalAppend(j, p + at)) JournalLose(j);
+			}
+			if (j->failed) j->lostSeq = j->firstSeq = (uint32_t)replayed; // the save has to cover all of them
+		}
+		FileMap_Close(&fm);
+	}
+	j->active = true;
+	j->recovered = replayed;
+	JournalRewrite(j); // drops a torn tail or a stale journal
+	if (replayed > 0) {
+		Vector2 pos;
+		if (FindTileWorldPos(ed, TILE_PLAYER, &pos)) game->playerPos = (Vector2){pos.x + (float)SQUARE_SIZE * 0.5f, pos.y + (float)SQUARE_SIZE * 0.5f};
+		if (FindTileWorldPos(ed, TILE_EXIT, &pos)) game->exitPos = pos;
+	}
+	j->attached = true;
+	ed->journal = j;
+	return j->recovered;
+}
+
+void LevelJournal_End(LevelEditorState *ed) {
+	if (ed->journal != &gJournal) return;
+	ed->journal = NULL;
+	gJournal.attached = false;
+	if (gJournal.count == 0 && !LevelSave_Busy()) JournalReset(&gJournal);
+}
+
+int LevelJournal_Recovered(void) {
+	return gJournal.recovered;
+}
+
+bool LevelJournal_TakeSaveDue(void) {
+	bool due = gJournal.saveDue;
+	gJournal.saveDue = false;
+	return due;
+}
@@ -0,0 +1,29 @@
+// Editor persistence: level saves written atomically on a background I/O thread, and an
+// append-only journal of the edits since the last completed save, replayed after a crash
+#pragma once
+#include <stdbool.h>
+#include "game.h"
+#include "level.h"
+
+// Snapshot the level now and write it in the background (temp file + rename). Saves complete in
+// queue order; a save that has not started yet is replaced by a newer one for the same path.
+// Without a thread (web, Windows) the write happens here and is retired by the next Poll.
+bool LevelSave_Queue(const char *path, const GameState *game, const LevelEditorState *ed);
+// Main thread, once per frame: retire finished saves (catalog refresh, journal trim) and append
+// new journal records to disk. `now` is in seconds.
+void LevelSave_Poll(double now);
+// Block until every queued save is on disk and retired (before reading a level back, and at exit)
+void LevelSave_Flush(void);
+bool LevelSave_Busy(void); // saves queued or not yet retired
+bool LevelSave_LastFailed(void); // the most recent retired save failed
+
+// Journal of the level open in the editor, kept beside it as "<path>.jnl". Begin replays the
+// edits a crash left behind onto the freshly loaded level, then attaches to `ed` so every SetTile
+// and Level_Resize is recorded. Returns the number of edits recovered.
+int LevelJournal_Begin(const char *path, GameState *game, LevelEditorState *ed);
+// Detach from `ed`; the journal file is removed once the save queued before it completes
+void LevelJournal_End(LevelEditorState *ed);
+int LevelJournal_Recovered(void); // edits recovered by Begin, until the next completed save
+// True once after an edit could not be journaled (out of memory): the journal is dropped until a
+// full save covers that edit, so the caller should queue one now
+bool LevelJournal_TakeSaveDue(void);
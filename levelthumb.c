@@ -0,0 +1,289 @@
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#define _POSIX_C_SOURCE 200809L
+#define LEVEL_THUMB_THREADED 1
+#endif
+#include "levelthumb.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "crc32.h"
+#include "filemap.h"
+#include "game.h"
+#include "levelpack.h"
+#include "worker.h"
+#ifdef LEVEL_THUMB_THREADED
+#include <pthread.h>
+#endif
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <direct.h>
+#endif
+
+#define THUMB_VERSION 1 // bump when the palette or layout changes; part of the cache file name
+
+typedef enum {
+	THUMB_FREE = 0,
+	THUMB_QUEUED, // waiting for the worker
+	THUMB_RENDERING, // owned by the worker
+	THUMB_READY, // `image` rendered, waiting for upload
+	THUMB_LOADED, // `texture` uploaded
+	THUMB_FAILED // unreadable level; kept so it is not retried every frame
+} ThumbState;
+
+typedef struct ThumbSlot {
+	char path[260];
+	long long mtime, fileSize; // catalog stamp of the file it was rendered from
+	ThumbState state;
+	unsigned lastUsed; // request order: the worker takes the newest request first
+	unsigned frame; // last frame it was asked for
+	unsigned drawFrame; // last frame it was asked for as a texture
+	Image image;
+	Texture2D texture;
+} ThumbSlot;
+
+static ThumbSlot gSlots[LEVEL_THUMB_SLOTS];
+static unsigned gUseCounter = 0;
+static unsigned gFrame = 1;
+
+#ifdef LEVEL_THUMB_THREADED
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER; // guards the slot states
+static pthread_cond_t gWake = PTHREAD_COND_INITIALIZER; // a slot was queued
+static Worker gWorker;
+#endif
+
+static inline void Lock(void) {
+#ifdef LEVEL_THUMB_THREADED
+	pthread_mutex_lock(&gLock);
+#endif
+}
+
+static inline void Unlock(void) {
+#ifdef LEVEL_THUMB_THREADED
+	pthread_mutex_unlock(&gLock);
+#endif
+}
+
+// ---- Rendering (worker side; CPU-only Image calls) ----
+static const Color THUMB_SKY = {196, 225, 255, 255};
+
+static Color TileColor(TileType t) {
+	switch (t) {
+	case TILE_BLOCK: return (Color){86, 125, 70, 255};
+	case TILE_LASER: return (Color){220, 40, 40, 255};
+	case TILE_PLAYER: return (Color){40, 90, 220, 255};
+	case TILE_EXIT: return (Color){240, 190, 40, 255};
+	case TILE_SPAWNER: return (Color){120, 40, 200, 255};
+	default: return BLANK;
+	}
+}
+
+static void DrawMarker(Image *img, const LevelEditorState *ed, int cell, TileType t) {
+	int px = (int)((long long)(cell % ed->cols) * img->width / ed->cols);
+	int py = (int)((long long)(cell / ed->cols) * img->height / ed->rows);
+	ImageDrawRectangle(img, px - 1, py - 1, 3, 3, TileColor(t));
+}
+
+// Whole pixels per cell when the level fits the box; larger levels are point-sampled, with the
+// player, exit and spawners drawn on top so they never fall between samples
+static Image Rasterize(const LevelEditorState *ed) {
+	int cell = LEVEL_THUMB_WIDTH / ed->cols;
+	if (LEVEL_THUMB_HEIGHT / ed->rows < cell) cell = LEVEL_THUMB_HEIGHT / ed->rows;
+	if (cell >= 1) {
+		Image img = GenImageColor(ed->cols * cell, ed->rows * cell, THUMB_SKY);
+		for (int y = 0; y < ed->rows; ++y)
+			for (int x = 0; x < ed->cols; ++x) {
+				Color c = TileColor(LevelTile(ed, x, y));
+				if (c.a) ImageDrawRectangle(&img, x * cell, y * cell, cell, cell, c);
+			}
+		return img;
+	}
+	float sx = (float)LEVEL_THUMB_WIDTH / ed->cols, sy = (float)LEVEL_THUMB_HEIGHT / ed->rows;
+	float s = sx < sy ? sx : sy;
+	int w = (int)(ed->cols * s), h = (int)(ed->rows * s);
+	Image img = GenImageColor(w > 0 ? w : 1, h > 0 ? h : 1, THUMB_SKY);
+	for (int py = 0; py < img.height; ++py) {
+		int cy = (int)((long long)py * ed->rows / img.height);
+		for (int px = 0; px < img.width; ++px) {
+			Color c = TileColor(LevelTile(ed, (int)((long long)px * ed->cols / img.width), cy));
+			if (c.a) ImageDrawPixel(&img, px, py, c);
+		}
+	}
+	const LevelCellList *spawners = Level_SpecialCells(ed, TILE_SPAWNER);
+	for (int i = 0; i < spawners->count; ++i) DrawMarker(&img, ed, spawners->cells[i], TILE_SPAWNER);
+	if (ed->index.exitCount > 0) DrawMarker(&img, ed, ed->index.exit, TILE_EXIT);
+	if (ed->index.playerCount > 0) DrawMarker(&img, ed, ed->index.player, TILE_PLAYER);
+	return img;
+}
+
+// The cached thumbnail of the level file at `path`, else a fresh one that is then cached.
+// The cache key is the CRC of the file bytes, so reading it never decodes the level.
+static Image RenderThumb(const char *path) {
+	Image img = {0};
+	FileMap fm = {0};
+	const unsigned char *data;
+	size_t size;
+	if (LevelPack_Lookup(path, &data, &size)) {
+		// borrowed view of the pack mapping
+	} else if (FileMap_Open(&fm, path)) {
+		data = fm.data;
+		size = fm.size;
+	} else {
+		return img;
+	}
+	char cachePath[128];
+	snprintf(cachePath, sizeof(cachePath), "%s/%08x-%dx%d-t%d.png", LEVEL_THUMB_DIR, (unsigned)Crc32(0, data, size), LEVEL_THUMB_WIDTH, LEVEL_THUMB_HEIGHT, THUMB_VERSION);
+#ifndef PLATFORM_WEB
+	if (FileExists(cachePath)) img = LoadImage(cachePath); // a torn or foreign file fails to decode and is redrawn
+#endif
+	if (!img.data) {
+		GameState *game = calloc(1, sizeof(GameState));
+		LevelEditorState *ed = calloc(1, sizeof(LevelEditorState));
+		if (game && ed && Level_LoadFromMemory(data, size, game, ed)) {
+			img = Rasterize(ed);
+#ifndef PLATFORM_WEB
+#ifndef _WIN32
+			mkdir(LEVEL_THUMB_DIR, 0755);
+#else
+			_mkdir(LEVEL_THUMB_DIR);
+#endif
+			ExportImage(img, cachePath); // a cache: failing to write only costs a redraw
+#endif
+		}
+		if (ed) Level_Free(ed);
+		free(ed);
+		free(game);
+	}
+	FileMap_Close(&fm);
+	return img;
+}
+
+// ---- Slots ----
+static ThumbSlot *NextQueued(void) {
+	ThumbSlot *best = NULL;
+	for (int i = 0; i < LEVEL_THUMB_SLOTS; ++i)
+		if (gSlots[i].state == THUMB_QUEUED && (!best || gSlots[i].lastUsed > best->lastUsed)) best = &gSlots[i];
+	return best;
+}
+
+static void FinishSlot(ThumbSlot *s, Image img) {
+	s->image = img;
+	s->state = img.data ? THUMB_READY : THUMB_FAILED;
+}
+
+#ifdef LEVEL_THUMB_THREADED
+static void *WorkerMain(void *arg) {
+	(void)arg;
+	pthread_mutex_lock(&gLock);
+	for (;;) {
+		ThumbSlot *s;
+		while ((s = NextQueued()) == NULL) pthread_cond_wait(&gWake, &gLock);
+		char path[sizeof(s->path)];
+		memcpy(path, s->path, sizeof(path));
+		s->state = THUMB_RENDERING; // the main thread neither evicts nor reuses it until it finishes
+		pthread_mutex_unlock(&gLock);
+		Image img = RenderThumb(path);
+		pthread_mutex_lock(&gLock);
+		FinishSlot(s, img);
+	}
+	return NULL;
+}
+
+static bool WorkerRunning(void) { return Worker_Running(&gWorker, WorkerMain); }
+#endif
+
+static void ReleaseSlot(ThumbSlot *s) {
+	if (s->state == THUMB_LOADED) UnloadTexture(s->texture);
+	if (s->state == THUMB_READY) UnloadImage(s->image);
+	memset(s, 0, sizeof(*s));
+}
+
+static ThumbSlot *FindSlot(const LevelEntry *e) {
+	for (int i = 0; i < LEVEL_THUMB_SLOTS; ++i) {
+		ThumbSlot *s = &gSlots[i];
+		if (s->state != THUMB_FREE && s->mtime == e->mtime && s->fileSize == e->fileSize && strcmp(s->path, e->binPath) == 0) return s;
+	}
+	return NULL;
+}
+
+// A free slot, else the least recently used one that is off screen and not being rendered
+static ThumbSlot *ClaimSlot(void) {
+	ThumbSlot *best = NULL;
+	for (int i = 0; i < LEVEL_THUMB_SLOTS; ++i) {
+		ThumbSlot *s = &gSlots[i];
+		if (s->state == THUMB_FREE) return s;
+		if (s->state == THUMB_RENDERING || s->frame == gFrame) continue;
+		if (!best || s->lastUsed < best->lastUsed) best = s;
+	}
+	if (best) ReleaseSlot(best);
+	return best;
+}
+
+// Find or queue the slot for `e` and mark it in use this frame
+static ThumbSlot *Request(const LevelEntry *e) {
+	ThumbSlot *s = FindSlot(e);
+	if (!s && (s = ClaimSlot()) != NULL) {
+		snprintf(s->path, sizeof(s->path), "%s", e->binPath);
+		s->mtime = e->mtime;
+		s->fileSize = e->fileSize;
+		s->state = THUMB_QUEUED;
+#ifdef LEVEL_THUMB_THREADED
+		if (WorkerRunning()) pthread_cond_signal(&gWake);
+#endif
+	}
+	if (s) {
+		s->lastUsed = ++gUseCounter;
+		s->frame = gFrame;
+	}
+	return s;
+}
+
+const Texture2D *LevelThumb_Get(const LevelEntry *e) {
+	Lock();
+	ThumbSlot *s = Request(e);
+	const Texture2D *tex = NULL;
+	if (s) {
+		s->drawFrame = gFrame;
+		if (s->state == THUMB_LOADED) tex = &s->texture;
+	}
+	Unlock();
+	return tex;
+}
+
+void LevelThumb_Prefetch(const LevelEntry *e) {
+	Lock();
+	Request(e);
+	Unlock();
+}
+
+void LevelThumb_Update(void) {
+	bool renderHere = true;
+#ifdef LEVEL_THUMB_THREADED
+	renderHere = gWorker.started && !gWorker.running;
+#endif
+	if (renderHere) {
+		ThumbSlot *s = NextQueued(); // one per frame keeps the list responsive
+		if (s) FinishSlot(s, RenderThumb(s->path));
+	}
+	Lock();
+	for (int i = 0; i < LEVEL_THUMB_SLOTS; ++i) {
+		ThumbSlot *s = &gSlots[i];
+		if (s->state != THUMB_READY || s->drawFrame != gFrame) continue; // not drawn: stays a CPU image
+		s->texture = LoadTextureFromImage(s->image);
+		UnloadImage(s->image);
+		s->image = (Image){0};
+		s->state = s->texture.id ? THUMB_LOADED : THUMB_FAILED;
+	}
+	Unlock();
+	gFrame++;
+}
+
+void LevelThumb_Release(void) {
+	Lock();
+	for (int i = 0; i < LEVEL_THUMB_SLOTS; ++i)
+		if (gSlots[i].state != THUMB_RENDERING) ReleaseSlot(&gSlots[i]);
+	Unlock();
+}
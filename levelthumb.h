@@ -0,0 +1,18 @@
+// Level select thumbnails: levels rasterized into small images on a worker thread, cached on disk
+// by file content, and uploaded as textures only when drawn
+#pragma once
+#include <stdbool.h>
+#include "level.h"
+#include "raylib.h"
+
+#define LEVEL_THUMB_DIR "cache" // shared with the level bakes; files named by content hash
+
+// The thumbnail texture for `e`, or NULL while it is being rendered (it is requested here).
+// Call every frame for each drawn entry; the most recently asked-for entry is rendered first.
+const Texture2D *LevelThumb_Get(const LevelEntry *e);
+// Render `e` ahead of time but keep it a CPU image until it is drawn (for neighboring rows)
+void LevelThumb_Prefetch(const LevelEntry *e);
+// Main thread, once per frame: upload finished thumbnails that were drawn this frame
+// (and render one here where there is no worker thread)
+void LevelThumb_Update(void);
+void LevelThumb_Release(void); // unload every texture (before CloseWindow)
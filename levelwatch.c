@@ -0,0 +1,258 @@
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#define _POSIX_C_SOURCE 200809L
+#define LEVEL_WATCH_THREADED 1
+#endif
+#include "levelwatch.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "config.h"
+#include "crc32.h"
+#include "filemap.h"
+#include "levelbake.h"
+#include "levelpack.h"
+#include "worker.h"
+#ifdef LEVEL_WATCH_THREADED
+#include <pthread.h>
+#endif
+#if defined(__linux__) && !defined(PLATFORM_WEB)
+#define LEVEL_WATCH_INOTIFY 1
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#ifndef PLATFORM_WEB
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+static bool gActive = false; // main thread: a file is being watched
+
+// Shared with the worker (under gLock)
+static char gPath[260];
+static unsigned gGen = 0; // bumped by Begin/End, so a parse of a file no longer watched is dropped
+static uint32_t gCrc; // content of the level being played, then of the newest parsed version
+static bool gJobPending = false;
+static bool gReady = false; // gReadyLevel holds a parsed level the main thread has not taken
+static LevelEditorState gReadyLevel;
+static GameState gReadyState;
+
+// Change detection (main thread)
+typedef struct FileStamp {
+	long long mtime, size;
+} FileStamp;
+static FileStamp gStamp;
+static double gNextPoll = 0.0;
+static bool gRecheck = false; // the last stamp was from the current second: a later write could hide in it
+#ifdef LEVEL_WATCH_INOTIFY
+static int gWatchFd = -1;
+static char gName[260]; // file name inside the watched directory
+#endif
+
+#ifdef LEVEL_WATCH_THREADED
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gWake = PTHREAD_COND_INITIALIZER; // a check was requested
+static Worker gWorker;
+#endif
+
+static inline void Lock(void) {
+#ifdef LEVEL_WATCH_THREADED
+	pthread_mutex_lock(&gLock);
+#endif
+}
+
+static inline void Unlock(void) {
+#ifdef LEVEL_WATCH_THREADED
+	pthread_mutex_unlock(&gLock);
+#endif
+}
+
+static bool ContentCrc(const char *path, uint32_t *crc) {
+	FileMap fm;
+	if (!FileMap_Open(&fm, path)) return false;
+	*crc = Crc32(0, fm.data, fm.size);
+	FileMap_Close(&fm);
+	return true;
+}
+
+// Parse the file when its bytes differ from the known version (worker side)
+static void CheckFile(unsigned gen, const char *path, uint32_t knownCrc) {
+	uint32_t crc;
+	if (!ContentCrc(path, &crc) || crc == knownCrc) return; // gone for now, or touched without a change
+	GameState state;
+	LevelEditorState level;
+	memset(&state, 0, sizeof(state));
+	memset(&level, 0, sizeof(level));
+	if (!Level_LoadStreamed(path, &state, &level)) { // half written: its final write is another change
+		Level_Free(&level);
+		return;
+	}
+	if (!level.stream) level.bake = LevelBake_Acquire(&level);
+	Lock();
+	bool current = gen == gGen;
+	if (current) {
+		if (gReady) Level_Free(&gReadyLevel); // superseded before it was taken
+		gReadyLevel = level;
+		gReadyState = state;
+		gReady = true;
+		gCrc = crc;
+	}
+	Unlock();
+	if (!current) Level_Free(&level);
+}
+
+#ifdef LEVEL_WATCH_THREADED
+static void *WorkerMain(void *arg) {
+	(void)arg;
+	pthread_mutex_lock(&gLock);
+	for (;;) {
+		while (!gJobPending) pthread_cond_wait(&gWake, &gLock);
+		gJobPending = false;
+		char path[sizeof(gPath)];
+		memcpy(path, gPath, sizeof(path));
+		unsigned gen = gGen;
+		uint32_t crc = gCrc;
+		pthread_mutex_unlock(&gLock);
+		CheckFile(gen, path, crc);
+		pthread_mutex_lock(&gLock);
+	}
+	return NULL;
+}
+
+static bool WorkerRunning(void) { return Worker_Running(&gWorker, WorkerMain); }
+#endif
+
+static void RequestCheck(void) {
+#ifdef LEVEL_WATCH_THREADED
+	if (WorkerRunning()) {
+		pthread_mutex_lock(&gLock);
+		gJobPending = true;
+		pthread_cond_signal(&gWake);
+		pthread_mutex_unlock(&gLock);
+		return;
+	}
+#endif
+	CheckFile(gGen, gPath, gCrc);
+}
+
+#ifndef PLATFORM_WEB
+static bool ReadStamp(const char *path, FileStamp *out) {
+	struct stat st;
+	if (stat(path, &st) != 0) return false;
+	out->mtime = (long long)st.st_mtime;
+	out->size = (long long)st.st_size;
+	return true;
+}
+#endif
+
+#ifdef LEVEL_WATCH_INOTIFY
+// Non-blocking: true when an event named the watched file. The directory is watched, not the
+// file, because saves replace the file by renaming a temporary over it.
+static bool DrainEvents(void) {
+	union {
+		struct inotify_event align;
+		char bytes[4096];
+	} buf;
+	bool hit = false;
+	ssize_t n;
+	while ((n = read(gWatchFd, buf.bytes, sizeof(buf.bytes))) > 0) {
+		for (char *p = buf.bytes; p < buf.bytes + n;) {
+			const struct inotify_event *ev = (const struct inotify_event *)p;
+			if ((ev->mask & IN_Q_OVERFLOW) || (ev->len > 0 && strcmp(ev->name, gName) == 0)) hit = true;
+			p += sizeof(struct inotify_event) + ev->len;
+		}
+	}
+	return hit;
+}
+
+static void StartInotify(const char *path) {
+	char dir[260];
+	const char *slash = strrchr(path, '/');
+	snprintf(dir, sizeof(dir), "%.*s", slash ? (int)(slash - path) : 1, slash ? path : ".");
+	snprintf(gName, sizeof(gName), "%s", slash ? slash + 1 : path);
+	gWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (gWatchFd < 0) return;
+	if (inotify_add_watch(gWatchFd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		close(gWatchFd);
+		gWatchFd = -1;
+	}
+}
+#endif
+
+// Polling: the file's stamp moved since the last look
+static bool StampChanged(double now) {
+#ifdef PLATFORM_WEB
+	(void)now;
+	return false;
+#else
+	if (now < gNextPoll) return false;
+	gNextPoll = now + LEVEL_WATCH_POLL_SECONDS;
+	FileStamp st;
+	if (!ReadStamp(gPath, &st)) return false;
+	bool changed = gRecheck || st.mtime != gStamp.mtime || st.size != gStamp.size;
+	gStamp = st;
+	gRecheck = st.mtime >= (long long)time(NULL);
+	return changed;
+#endif
+}
+
+void LevelWatch_Begin(const char *path) {
+	LevelWatch_End();
+#ifdef PLATFORM_WEB
+	(void)path; // levels only change through this process there
+#else
+	const unsigned char *data;
+	size_t size;
+	uint32_t crc;
+	if (LevelPack_Lookup(path, &data, &size)) return; // pack entries are read-only
+	if (!ContentCrc(path, &crc)) return;
+	Lock();
+	snprintf(gPath, sizeof(gPath), "%s", path);
+	gCrc = crc;
+	gGen++;
+	Unlock();
+	if (!ReadStamp(path, &gStamp)) memset(&gStamp, 0, sizeof(gStamp));
+	gRecheck = false;
+	gNextPoll = 0.0;
+#ifdef LEVEL_WATCH_INOTIFY
+	StartInotify(path);
+#endif
+	gActive = true;
+#endif
+}
+
+void LevelWatch_End(void) {
+	if (!gActive) return;
+	gActive = false;
+#ifdef LEVEL_WATCH_INOTIFY
+	if (gWatchFd >= 0) close(gWatchFd);
+	gWatchFd = -1;
+#endif
+	Lock();
+	gGen++;
+	gJobPending = false;
+	if (gReady) Level_Free(&gReadyLevel);
+	gReady = false;
+	Unlock();
+}
+
+bool LevelWatch_Poll(double now, LevelEditorState *level, GameState *fileState) {
+	if (!gActive) return false;
+	bool changed;
+#ifdef LEVEL_WATCH_INOTIFY
+	changed = gWatchFd >= 0 ? DrainEvents() : StampChanged(now);
+#else
+	changed = StampChanged(now);
+#endif
+	if (changed) RequestCheck();
+	Lock();
+	bool ready = gReady;
+	if (ready) {
+		*level = gReadyLevel;
+		*fileState = gReadyState;
+		memset(&gReadyLevel, 0, sizeof(gReadyLevel));
+		gReady = false;
+	}
+	Unlock();
+	return ready;
+}
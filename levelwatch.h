@@ -0,0 +1,15 @@
+// Hot reload for play: the level file being played is watched (inotify on Linux, stat polling
+// elsewhere), re-parsed on a worker thread when its content changes, and handed to the main thread
+// to swap in between ticks
+#pragma once
+#include <stdbool.h>
+#include "game.h"
+#include "level.h"
+
+// Start watching `path`, whose current content is what is being played. Pack entries and the web
+// build are not watched.
+void LevelWatch_Begin(const char *path);
+void LevelWatch_End(void);
+// Main thread, between ticks: true when the file changed and parsed; the new level moves into
+// *level (which must not own anything) and the positions from the file into *fileState
+bool LevelWatch_Poll(double now, LevelEditorState *level, GameState *fileState);
@@ -29,7 +29,6 @@ void UpdateMenu(ScreenState *screen, int *selected) {
 			*screen = SCREEN_SELECT_EDIT;
 		} else if (*selected == MENU_CREATE_NEW) {
 			gCreateNewRequested = true;
-			snprintf(gLevelBinPath, sizeof(gLevelBinPath), "%s", LEVEL_FILE_BIN);
 			*screen = SCREEN_LEVEL_EDITOR;
 		} else if (*selected == MENU_PLAY_LEVEL) {
 			*screen = SCREEN_SELECT_PLAY;
@@ -1,50 +1,28 @@
 #include "physics.h"
+#include "chunkstream.h"
 #include "config.h"
 #include "level.h"
+#include "levelbake.h"
+#include "world.h"
 #include <math.h>
 
-// Forward declaration from game.c/level.c if needed, but level.h has the helpers.
-// We need access to the current level. level.h declares `gLevel` usually?
-// Actually level.h declares `editor` but game.c had a static `gLevel`.
-// We should probably expose the current level in level.h or pass it in.
-// For now, let's assume we can use the helpers in level.h which use `gLevel` if we make it accessible,
-// OR we rely on `BlockAtCell` which was static in game.c.
-// Better approach: Move `BlockAtCell` to level.h/c or make it a helper here that calls level functions.
-
-// `level.h` has `IsSolidTile` and `gLevel` is static in `game.c`.
-// We need to access the tile data.
-// Let's look at `level.h` again. It has `LevelEditorState editor`.
-// But `game.c` used `const struct LevelEditorState *gLevel`.
-// We should probably add a `Physics_SetLevel` or similar, or just access `editor` if that's the global state.
-// However, `game.c` supports playing a level separate from the editor state potentially?
-// Let's check `level.h` content again to be sure.
-
-// Re-reading level.h from previous turn...
-// It has `extern LevelEditorState editor;`
-// It has `IsSolidTile`.
-// It DOES NOT expose the current level pointer used by the game loop if it differs from `editor`.
-// In `game.c`, `UpdateGame` takes `const struct LevelEditorState *level`.
-// So we should pass the level to these functions or set a global in physics.c.
-// Let's add `Physics_SetLevel` to `physics.h` and a static global in `physics.c`.
-
-static const LevelEditorState *gPhysicsLevel = NULL;
-
-void Physics_SetLevel(const LevelEditorState *level) {
-	gPhysicsLevel = level;
-}
+// All queries read the level owned by the world passed in; there is no module-level state,
+// so several worlds can be simulated concurrently.
 
-bool Physics_BlockAtCell(int cx, int cy) {
-	if (!gPhysicsLevel) return false;
-	if (!InBoundsCell(cx, cy)) return true; // Out of bounds is solid
-	return IsSolidTile(gPhysicsLevel->tiles[cy][cx]);
+bool Physics_BlockAtCell(const World *world, int cx, int cy) {
+	if (!world) return false;
+	if (!InBoundsCell(&world->level, cx, cy)) return true; // Out of bounds is solid
+	if (world->level.stream) return ChunkStream_SolidAt(world->level.stream, cx, cy);
+	if (world->level.bake) return LevelBake_SolidAt(world->level.bake, cx, cy);
+	return IsSolidTile(LevelTile(&world->level, cx, cy));
 }
 
-static bool BlockAtCell(int cx, int cy) {
-	return Physics_BlockAtCell(cx, cy);
+static bool BlockAtCell(const World *world, int cx, int cy) {
+	return Physics_BlockAtCell(world, cx, cy);
 }
 
-bool AABBOverlapsSolid(float x, float y, float w, float h) {
-	if (!gPhysicsLevel) return false;
+bool AABBOverlapsSolid(const World *world, float x, float y, float w, float h) {
+	if (!world) return false;
 	// Check against per-tile solid collision rectangles
 	Rectangle pr = (Rectangle){x, y, w, h};
 	int left = WorldToCellX(x);
@@ -53,8 +31,8 @@ bool AABBOverlapsSolid(float x, float y, float w, float h) {
 	int bottom = WorldToCellY(y + h - 0.001f);
 	for (int cy = top; cy <= bottom; ++cy) {
 		for (int cx = left; cx <= right; ++cx) {
-			if (!InBoundsCell(cx, cy)) return true; // out of bounds treated as solid
-			TileType t = gPhysicsLevel->tiles[cy][cx];
+			if (!InBoundsCell(&world->level, cx, cy)) return true; // out of bounds treated as solid
+			TileType t = LevelTile(&world->level, cx, cy);
 			if (!IsSolidTile(t)) continue;
 			Rectangle tr = TileSolidCollisionRect(cx, cy, t);
 			if (tr.width > 0.0f && tr.height > 0.0f && CheckCollisionRecs(pr, tr)) return true;
@@ -63,7 +41,7 @@ bool AABBOverlapsSolid(float x, float y, float w, float h) {
 	return false;
 }
 
-void MoveEntity(Vector2 *pos, Vector2 *vel, float w, float h, float dt, bool *hitLeft, bool *hitRight, bool *hitTop, bool *hitBottom) {
+void MoveEntity(const World *world, Vector2 *pos, Vector2 *vel, float w, float h, float dt, bool *hitLeft, bool *hitRight, bool *hitTop, bool *hitBottom) {
 	if (hitLeft) *hitLeft = false;
 	if (hitRight) *hitRight = false;
 	if (hitTop) *hitTop = false;
@@ -83,7 +61,7 @@ void MoveEntity(Vector2 *pos, Vector2 *vel, float w, float h, float dt, bool *hi
 
 		bool collision = false;
 		for (int cy = startCellY; cy <= endCellY; ++cy) {
-			if (BlockAtCell(cellX, cy)) {
+			if (BlockAtCell(world, cellX, cy)) {
 				collision = true;
 				break;
 			}
@@ -115,7 +93,7 @@ void MoveEntity(Vector2 *pos, Vector2 *vel, float w, float h, float dt, bool *hi
 
 		bool collision = false;
 		for (int cx = startCellX; cx <= endCellX; ++cx) {
-			if (BlockAtCell(cx, cellY)) {
+			if (BlockAtCell(world, cx, cellY)) {
 				collision = true;
 				break;
 			}
@@ -137,10 +115,10 @@ void MoveEntity(Vector2 *pos, Vector2 *vel, float w, float h, float dt, bool *hi
 	}
 }
 
-void PushEntityOutOfSolids(Vector2 *pos, Vector2 *vel, float w, float h) {
+void PushEntityOutOfSolids(const World *world, Vector2 *pos, Vector2 *vel, float w, float h) {
 	float left = pos->x - w * 0.5f;
 	float top = pos->y - h * 0.5f;
-	if (!AABBOverlapsSolid(left, top, w, h)) return;
+	if (!AABBOverlapsSolid(world, left, top, w, h)) return;
 
 	float bestDx = 0.0f, bestDy = 0.0f;
 	bool haveDx = false, haveDy = false;
@@ -151,7 +129,7 @@ void PushEntityOutOfSolids(Vector2 *pos, Vector2 *vel, float w, float h) {
 	for (int i = 0; i < maxHorizontal; ++i) {
 		float dx = dirX * (float)(i + 1);
 		float candidateLeft = left + dx;
-		if (!AABBOverlapsSolid(candidateLeft, top, w, h)) {
+		if (!AABBOverlapsSolid(world, candidateLeft, top, w, h)) {
 			bestDx = dx;
 			haveDx = true;
 			break;
@@ -164,7 +142,7 @@ void PushEntityOutOfSolids(Vector2 *pos, Vector2 *vel, float w, float h) {
 	for (int i = 0; i < maxVertical; ++i) {
 		float dy = dirY * (float)(i + 1);
 		float candidateTop = top + dy;
-		if (!AABBOverlapsSolid(left, candidateTop, w, h)) {
+		if (!AABBOverlapsSolid(world, left, candidateTop, w, h)) {
 			bestDy = dy;
 			haveDy = true;
 			break;
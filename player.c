@@ -5,6 +5,7 @@
 #include "audio.h"
 #include "render.h"
 #include "input_config.h"
+#include "world.h"
 #include <math.h>
 
 // Dimensions
@@ -31,14 +32,13 @@ static const float kWallStickBuffer = 0.10f;
 static const float kLedgeHandSampleFrac = 0.35f; // fraction down from head to sample for hand position
 static const float kLedgeSnapPadding = 2.0f; // offset to keep the player clear of the ledge when hanging
 
-static WarriorClipDims WarriorDimsForState(const GameState *g) {
+static WarriorClipDims WarriorDimsForState(const GameState *g, bool dying) {
 	float speed = fabsf(g->playerVel.x);
 	float maxSpeedXNow = g->crouching ? MAX_SPEED_X_CROUCH : MAX_SPEED_X;
 	bool running = g->onGround && speed > (0.4f * maxSpeedXNow);
 	bool falling = !g->onGround && g->playerVel.y > 80.0f;
 	bool rising = !g->onGround && g->playerVel.y < -60.0f;
 	bool transitioning = !g->onGround && !rising && !falling;
-	bool dying = Game_IsDying();
 	bool hurt = g->hurtTimer > 0.0f;
 
 	if (dying) return kDimsDeath;
@@ -61,90 +61,52 @@ static WarriorClipDims WarriorDimsForState(const GameState *g) {
 	return kDimsIdle;
 }
 
-static WarriorClipDims WarriorDimsForCrouchState(const GameState *g, bool crouching) {
+static WarriorClipDims WarriorDimsForCrouchState(const GameState *g, bool dying, bool crouching) {
 	GameState tmp = *g;
 	tmp.crouching = crouching;
 	tmp.crouchAnimDir = 0;
-	return WarriorDimsForState(&tmp);
+	return WarriorDimsForState(&tmp, dying);
 }
 
-void Game_CurrentAABBDims(const GameState *g, float *outW, float *outH) {
-	if (!g) {
+void Game_CurrentAABBDims(const World *w, float *outW, float *outH) {
+	if (!w) {
 		if (outW) *outW = 0.0f;
 		if (outH) *outH = 0.0f;
 		return;
 	}
-	WarriorClipDims d = WarriorDimsForState(g);
+	WarriorClipDims d = WarriorDimsForState(&w->game, w->death);
 	float scale = 1.0f;
-	float w = d.w * scale;
-	float h = d.h * scale;
-	if (outW) *outW = w;
-	if (outH) *outH = h;
+	float width = d.w * scale;
+	float height = d.h * scale;
+	if (outW) *outW = width;
+	if (outH) *outH = height;
 }
 
-Rectangle PlayerAABB(const GameState *game) {
-	float w, h;
-	Game_CurrentAABBDims(game, &w, &h);
-	return (Rectangle){game->playerPos.x - w * 0.5f, game->playerPos.y - h * 0.5f, w, h};
+Rectangle PlayerAABB(const World *w) {
+	float width, height;
+	Game_CurrentAABBDims(w, &width, &height);
+	const GameState *game = &w->game;
+	return (Rectangle){game->playerPos.x - width * 0.5f, game->playerPos.y - height * 0.5f, width, height};
 }
 
-void TriggerDeath(GameState *game) {
-	// We need to access the static `death` variable in game.c?
-	// Or we should move `death` state to `GameState`?
-	// `game.h` has `Game_Death()` etc accessors but the state is static in `game.c`.
-	// This is a problem. `death` should probably be in `GameState`.
-	// But `GameState` is passed around.
-	// Let's assume for now we can't easily move `death` to `GameState` without breaking other things (like `Game_IsDying` accessors).
-	// Actually, `game.h` defines `GameState`.
-	// Let's add `bool death` to `GameState`?
-	// The current `game.c` has `static bool death = false;`.
-	// If we move it to `GameState`, we need to update all accessors.
-	// Given the scope, let's expose `Game_SetDeath` in `game.h` and implement it in `game.c`.
-	// Wait, `TriggerDeath` was in `game.c`.
-	// If we move `TriggerDeath` to `player.c`, it needs to modify the global death state.
-	// Let's declare `Game_TriggerDeath` in `game.h` and keep the implementation in `game.c`?
-	// But `TakeDamage` calls `TriggerDeath`.
-	// `TakeDamage` is logic we want in `player.c` (or `game.c`).
-	// If `TakeDamage` is in `player.c`, it needs to call `Game_TriggerDeath`.
-	// Let's rename `TriggerDeath` to `Game_TriggerDeath` and keep it in `game.c` (exposed in `game.h`).
-	// And `TakeDamage` can be in `player.c`.
+void Player_PollInput(PlayerInput *out) {
+	out->jumpPressed = InputPressed(ACT_JUMP);
+	out->jumpDown = InputDown(ACT_JUMP);
+	out->left = InputDown(ACT_LEFT);
+	out->right = InputDown(ACT_RIGHT);
+	out->down = InputDown(ACT_DOWN);
 }
 
-// Wait, I can't easily implement `TriggerDeath` here if it modifies static state in `game.c`.
-// I will implement `TakeDamage` here but call `Game_TriggerDeath` which I will add to `game.h`.
-
-// Also `BlockAtCell` is needed for `CanGrabLedge`.
-// We made `BlockAtCell` static in `physics.c`.
-// We should expose `Physics_BlockAtCell` or similar?
-// Or just use `AABBOverlapsSolid`?
-// `CanGrabLedge` checks specific cells.
-// Let's add `Physics_IsBlockAt(int cx, int cy)` to `physics.h`.
-
-// Re-implementing CanGrabLedge requires BlockAtCell.
-// I'll add `Physics_BlockAtCell` to `physics.h` in the next step or just assume it exists and add it.
-// Actually, I can just include `level.h` and use `gPhysicsLevel` if I exposed it? No.
-// I'll use `IsSolidTile` and `editor` from `level.h`?
-// `level.h` has `extern LevelEditorState editor;`.
-// But the game might be running a level that is NOT `editor`.
-// `physics.c` has `gPhysicsLevel`.
-// I should expose `Physics_BlockAtCell` in `physics.h`.
-
-// For now, I will comment out `TriggerDeath` implementation here and `TakeDamage` and `UpdatePlayer`
-// until I fix the dependencies in `game.h` / `physics.h`.
-// Actually, I should write `player.c` assuming `Game_TriggerDeath` and `Physics_BlockAtCell` exist,
-// and then update `game.h` and `physics.h` and `game.c` accordingly.
-
-extern void Game_TriggerDeath(GameState *game);
-extern bool Physics_BlockAtCell(int cx, int cy);
-
-static bool TouchingWall(const GameState *g, bool leftSide, float aabbW, float aabbH) {
+static bool TouchingWall(const World *w, bool leftSide, float aabbW, float aabbH) {
+	const GameState *g = &w->game;
 	float left = g->playerPos.x - aabbW * 0.5f;
 	float x = leftSide ? (left - 1.0f) : (left + aabbW);
 	float top = g->playerPos.y - aabbH * 0.5f;
-	return AABBOverlapsSolid(x, top, 1.0f, aabbH);
+	return AABBOverlapsSolid(w, x, top, 1.0f, aabbH);
 }
 
-static bool CanGrabLedge(const GameState *g, bool leftSide, float aabbW, float aabbH, float *outSnapY) {
+static bool CanGrabLedge(const World *w, bool leftSide, float aabbW, float aabbH, float *outSnapY) {
+	const GameState *g = &w->game;
 	if (g->playerVel.y < -40.0f) return false;
 
 	float top = g->playerPos.y - aabbH * 0.5f;
@@ -155,8 +117,8 @@ static bool CanGrabLedge(const GameState *g, bool leftSide, float aabbW, float a
 	int aboveCellY = handCellY - 1;
 	float blockTop = CellToWorld(handCellY);
 
-	if (!Physics_BlockAtCell(wallCellX, handCellY)) return false;
-	if (Physics_BlockAtCell(wallCellX, aboveCellY)) return false;
+	if (!Physics_BlockAtCell(w, wallCellX, handCellY)) return false;
+	if (Physics_BlockAtCell(w, wallCellX, aboveCellY)) return false;
 	if (top > blockTop + 6.0f) return false;
 	float maxHandY = blockTop + (float)SQUARE_SIZE * 0.7f;
 	if (handY > maxHandY) return false;
@@ -167,7 +129,8 @@ static bool CanGrabLedge(const GameState *g, bool leftSide, float aabbW, float a
 	return true;
 }
 
-void TakeDamage(GameState *game, Vector2 sourcePos) {
+void TakeDamage(World *w, Vector2 sourcePos) {
+	GameState *game = &w->game;
 	if (game->invincibilityTimer > 0.0f) return;
 	if (game->health <= 0) return;
 
@@ -182,11 +145,12 @@ void TakeDamage(GameState *game, Vector2 sourcePos) {
 	game->onGround = false;
 
 	if (game->health <= 0) {
-		Game_TriggerDeath(game);
+		Game_TriggerDeath(w);
 	}
 }
 
-void UpdatePlayer(GameState *game, float dt) {
+void UpdatePlayer(World *w, float dt) {
+	GameState *game = &w->game;
 	if (game->hurtTimer > 0.0f) {
 		game->hurtTimer -= dt;
 		if (game->hurtTimer < 0.0f) game->hurtTimer = 0.0f;
@@ -214,24 +178,24 @@ void UpdatePlayer(GameState *game, float dt) {
 	if (game->groundStickTimer > 0.0f) game->groundStickTimer -= dt;
 	if (game->wallCoyoteTimer > 0.0f) game->wallCoyoteTimer -= dt;
 
-	bool wantJumpPress = InputPressed(ACT_JUMP);
-	bool jumpDown = InputDown(ACT_JUMP);
-	bool left = InputDown(ACT_LEFT);
-	bool right = InputDown(ACT_RIGHT);
-	bool down = InputDown(ACT_DOWN);
+	bool wantJumpPress = w->input.jumpPressed;
+	bool jumpDown = w->input.jumpDown;
+	bool left = w->input.left;
+	bool right = w->input.right;
+	bool down = w->input.down;
 
 	if (wantJumpPress) game->jumpBufferTimer = JUMP_BUFFER_TIME;
 
 	// Handle crouch transitions
-	WarriorClipDims prevDims = WarriorDimsForState(game);
+	WarriorClipDims prevDims = WarriorDimsForState(game, w->death);
 	float prevBottom = game->playerPos.y + prevDims.h * 0.5f;
 	bool prevCrouch = game->crouching;
 	bool wantCrouch = down;
 	if (prevCrouch && !wantCrouch) {
-		WarriorClipDims standDims = WarriorDimsForCrouchState(game, false);
+		WarriorClipDims standDims = WarriorDimsForCrouchState(game, w->death, false);
 		float standY = prevBottom - standDims.h;
 		float standX = game->playerPos.x - standDims.w * 0.5f;
-		if (AABBOverlapsSolid(standX, standY, standDims.w, standDims.h)) {
+		if (AABBOverlapsSolid(w, standX, standY, standDims.w, standDims.h)) {
 			wantCrouch = true; // blocked overhead
 		}
 	}
@@ -240,17 +204,17 @@ void UpdatePlayer(GameState *game, float dt) {
 		game->crouchAnimTime = 0.0f;
 		game->crouchAnimDir = game->crouching ? 1 : -1;
 	}
-	WarriorClipDims newDims = WarriorDimsForState(game);
+	WarriorClipDims newDims = WarriorDimsForState(game, w->death);
 	if (fabsf(newDims.h - prevDims.h) > 0.001f) {
 		game->playerPos.y = prevBottom - newDims.h * 0.5f;
 	}
 
 	float maxSpeedX = game->crouching ? MAX_SPEED_X_CROUCH : MAX_SPEED_X;
 	float aabbW = 0.0f, aabbH = 0.0f;
-	Game_CurrentAABBDims(game, &aabbW, &aabbH);
+	Game_CurrentAABBDims(w, &aabbW, &aabbH);
 
-	bool touchingLeft = TouchingWall(game, true, aabbW, aabbH);
-	bool touchingRight = TouchingWall(game, false, aabbW, aabbH);
+	bool touchingLeft = TouchingWall(w, true, aabbW, aabbH);
+	bool touchingRight = TouchingWall(w, false, aabbW, aabbH);
 
 	float accel = game->onGround ? MOVE_ACCEL : AIR_ACCEL;
 	bool pushingLeft = left && !right;
@@ -323,8 +287,8 @@ void UpdatePlayer(GameState *game, float dt) {
 		game->jumpBufferTimer = 0.0f;
 		game->coyoteTimer = 0.0f;
 		game->wallCoyoteTimer = 0.0f;
-		Audio_PlayJump();
-		Render_SpawnWallJumpDust(game, dir);
+		if (!w->headless) Audio_PlayJump();
+		Render_SpawnWallJumpDust(w, dir);
 	}
 
 	if (game->jumpPrevDown && !jumpDown && game->playerVel.y < 0.0f) {
@@ -335,7 +299,7 @@ void UpdatePlayer(GameState *game, float dt) {
 	bool hitLeft = false, hitRight = false, hitTop = false, hitBottom = false;
 	bool wasGround = game->onGround;
 	
-	MoveEntity(&game->playerPos, &game->playerVel, aabbW, aabbH, dt, &hitLeft, &hitRight, &hitTop, &hitBottom);
+	MoveEntity(w, &game->playerPos, &game->playerVel, aabbW, aabbH, dt, &hitLeft, &hitRight, &hitTop, &hitBottom);
 
 	float halfW = aabbW * 0.5f;
 	float halfH = aabbH * 0.5f;
@@ -346,7 +310,7 @@ void UpdatePlayer(GameState *game, float dt) {
 	game->onGround = hitBottom;
 	if (!game->onGround) {
 		for (int cx = leftCell; cx <= rightCell; ++cx) {
-			if (Physics_BlockAtCell(cx, belowCellY)) {
+			if (Physics_BlockAtCell(w, cx, belowCellY)) {
 				game->onGround = true;
 				break;
 			}
@@ -354,9 +318,9 @@ void UpdatePlayer(GameState *game, float dt) {
 	}
 	bool landedThisFrame = (!wasGround) && game->onGround;
 	float contactW = 0.0f, contactH = 0.0f;
-	Game_CurrentAABBDims(game, &contactW, &contactH);
-	bool overlapLeft = TouchingWall(game, true, contactW, contactH);
-	bool overlapRight = TouchingWall(game, false, contactW, contactH);
+	Game_CurrentAABBDims(w, &contactW, &contactH);
+	bool overlapLeft = TouchingWall(w, true, contactW, contactH);
+	bool overlapRight = TouchingWall(w, false, contactW, contactH);
 	game->wallContactLeft = hitLeft || overlapLeft;
 	game->wallContactRight = hitRight || overlapRight;
 	if (game->groundStickTimer > 0.0f) game->onGround = true;
@@ -385,7 +349,7 @@ void UpdatePlayer(GameState *game, float dt) {
 		}
 		if (!game->edgeHang && game->wallContactLeft) {
 			float snapY = 0.0f;
-			if (CanGrabLedge(game, true, contactW, contactH, &snapY)) {
+			if (CanGrabLedge(w, true, contactW, contactH, &snapY)) {
 				game->edgeHang = true;
 				game->edgeHangDir = -1;
 				game->playerPos.y = snapY;
@@ -394,7 +358,7 @@ void UpdatePlayer(GameState *game, float dt) {
 			}
 		} else if (!game->edgeHang && game->wallContactRight) {
 			float snapY = 0.0f;
-			if (CanGrabLedge(game, false, contactW, contactH, &snapY)) {
+			if (CanGrabLedge(w, false, contactW, contactH, &snapY)) {
 				game->edgeHang = true;
 				game->edgeHangDir = +1;
 				game->playerPos.y = snapY;
@@ -427,8 +391,8 @@ void UpdatePlayer(GameState *game, float dt) {
 	game->wallSliding = slideActive;
 	game->jumpPrevDown = jumpDown;
 	if (didGroundJumpThisFrame) {
-		Audio_PlayJump();
-		Render_SpawnJumpDust(game);
+		if (!w->headless) Audio_PlayJump();
+		Render_SpawnJumpDust(w);
 	}
 	if (game->playerVel.x > 1.0f)
 		game->facingRight = true;
@@ -441,7 +405,7 @@ void UpdatePlayer(GameState *game, float dt) {
 	game->animLadder = ladderHold;
 	if (game->onGround) game->coyoteTimer = COYOTE_TIME;
 	if (landedThisFrame) {
-		Render_SpawnLandDust(game);
+		Render_SpawnLandDust(w);
 	}
 	float targetSink = game->onGround ? 1.0f : 0.0f;
 	game->groundSink += (targetSink - game->groundSink) * (12.0f * dt);
@@ -1,17 +1,29 @@
 #pragma once
+#include <stdbool.h>
 #include "game.h"
 
+struct World;
+
+// Per-tick player intent, sampled by the host so worlds never poll devices themselves
+typedef struct PlayerInput {
+	bool left;
+	bool right;
+	bool down;
+	bool jumpDown;
+	bool jumpPressed;
+} PlayerInput;
+
+// Sample the bound keys/touch controls into a PlayerInput
+void Player_PollInput(PlayerInput *out);
+
 // Player AABB for collision
-Rectangle PlayerAABB(const GameState *game);
+Rectangle PlayerAABB(const struct World *w);
 
 // Handle player input and physics
-void UpdatePlayer(GameState *game, float dt);
+void UpdatePlayer(struct World *w, float dt);
 
 // Render player sprite and effects
-void RenderPlayer(const GameState *game);
+void RenderPlayer(const struct World *w);
 
 // Apply damage to player
-void TakeDamage(GameState *game, Vector2 sourcePos);
-
-// Trigger death sequence
-void TriggerDeath(GameState *game);
+void TakeDamage(struct World *w, Vector2 sourcePos);
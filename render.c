@@ -2,7 +2,10 @@
 #include <math.h>
 #include <string.h>
 #include "autotiler.h"
+#include "levelbake.h"
 #include "raylib.h"
+#include "rng.h"
+#include "world.h"
 
 static Texture2D gBlockTileset = {0};
 static const int BLOCK_TILE_SIZE = 32;
@@ -40,8 +43,8 @@ Rectangle LaserCollisionRect(Vector2 laserPos) {
 // Callback function for autotiler to check if a block exists
 static bool CheckBlockForAutotiler(const void *context, int cx, int cy) {
 	const LevelEditorState *ed = (const LevelEditorState *)context;
-	if (!InBoundsCell(cx, cy)) return false;
-	return IsSolidTile(ed->tiles[cy][cx]);
+	if (!InBoundsCell(ed, cx, cy)) return false;
+	return IsSolidTile(LevelTile(ed, cx, cy));
 }
 
 static Rectangle ChooseBlockSrc(const LevelEditorState *ed, int cx, int cy) {
@@ -58,51 +61,80 @@ static void DrawBlock(Rectangle dest, Rectangle srcOverride) {
 	DrawTexturePro(gBlockTileset, src, dest, (Vector2){0, 0}, 0.0f, WHITE);
 }
 
-void RenderTiles(const LevelEditorState *ed) {
-	for (int y = 0; y < GRID_ROWS; ++y) {
-		for (int x = 0; x < GRID_COLS; ++x) {
-			TileType t = ed->tiles[y][x];
-			if (IsSolidTile(t)) {
-				Rectangle r = TileRect(x, y);
-				Rectangle src = ChooseBlockSrc(ed, x, y);
-				DrawBlock(r, src);
-			} else if (IsHazardTile(t)) {
-				Rectangle lr = LaserStripeRect((Vector2){CellToWorld(x), CellToWorld(y)});
-				DrawRectangleRec(lr, RED);
-			} else if (IsSpawnerTile(t)) {
-				Rectangle r = TileRect(x, y);
-				Color c = (Color){120, 40, 200, 255};
-				DrawRectangleRounded(r, 0.35f, 6, c);
-				DrawRectangleLinesEx(r, 2.0f, (Color){90, 20, 160, 255});
-			}
-		}
+Rectangle Render_ViewRect(Camera2D cam) {
+	float zoom = cam.zoom > 0.0f ? cam.zoom : 1.0f;
+	return (Rectangle){cam.target.x - cam.offset.x / zoom, cam.target.y - cam.offset.y / zoom,
+	                   (float)WINDOW_WIDTH / zoom, (float)WINDOW_HEIGHT / zoom};
+}
+
+static float ClampCameraAxis(float focus, float view, float level) {
+	// Levels smaller than the view stay centered instead of pinned to the top-left
+	if (level <= view) return level * 0.5f;
+	float half = view * 0.5f;
+	if (focus < half) return half;
+	if (focus > level - half) return level - half;
+	return focus;
+}
+
+void Render_FollowCamera(World *w, Vector2 focus) {
+	Camera2D *cam = &w->camera;
+	cam->offset = (Vector2){WINDOW_WIDTH * 0.5f, WINDOW_HEIGHT * 0.5f};
+	cam->rotation = 0.0f;
+	cam->zoom = 1.0f;
+	cam->target.x = ClampCameraAxis(focus.x, (float)WINDOW_WIDTH, LevelPixelWidth(&w->level));
+	cam->target.y = ClampCameraAxis(focus.y, (float)WINDOW_HEIGHT, LevelPixelHeight(&w->level));
+}
+
+// Visible cell range [x0, x1] x [y0, y1], clamped to the level
+static void ViewCells(const LevelEditorState *ed, Rectangle view, int *x0, int *y0, int *x1, int *y1) {
+	*x0 = WorldToCellX(view.x);
+	*y0 = WorldToCellY(view.y);
+	*x1 = WorldToCellX(view.x + view.width);
+	*y1 = WorldToCellY(view.y + view.height);
+	if (*x0 < 0) *x0 = 0;
+	if (*y0 < 0) *y0 = 0;
+	if (*x1 > ed->cols - 1) *x1 = ed->cols - 1;
+	if (*y1 > ed->rows - 1) *y1 = ed->rows - 1;
+}
+
+static void DrawTile(const LevelEditorState *ed, int x, int y, float sinkY) {
+	TileType t = LevelTile(ed, x, y);
+	if (IsSolidTile(t)) {
+		Rectangle r = TileRect(x, y);
+		r.y += sinkY;
+		Rectangle src = ed->bake ? Autotiler_TileForMask(ed->bake->autotile[(size_t)y * ed->cols + x]) : ChooseBlockSrc(ed, x, y);
+		DrawBlock(r, src);
+	} else if (IsHazardTile(t)) {
+		Rectangle lr = LaserStripeRect((Vector2){CellToWorld(x), CellToWorld(y)});
+		DrawRectangleRec(lr, RED);
+	} else if (IsSpawnerTile(t)) {
+		Rectangle r = TileRect(x, y);
+		Color c = (Color){120, 40, 200, 255};
+		DrawRectangleRounded(r, 0.35f, 6, c);
+		DrawRectangleLinesEx(r, 2.0f, (Color){90, 20, 160, 255});
 	}
 }
 
-void RenderTilesGameplay(const LevelEditorState *ed, const GameState *g) {
-	Rectangle aabb = PlayerAABB(g);
+void RenderTiles(const LevelEditorState *ed, Rectangle view) {
+	int x0, y0, x1, y1;
+	ViewCells(ed, view, &x0, &y0, &x1, &y1);
+	for (int y = y0; y <= y1; ++y)
+		for (int x = x0; x <= x1; ++x) DrawTile(ed, x, y, 0.0f);
+}
+
+void RenderTilesGameplay(const World *w) {
+	const LevelEditorState *ed = &w->level;
+	const GameState *g = &w->game;
+	Rectangle aabb = PlayerAABB(w);
 	int leftCell = WorldToCellX(aabb.x + 1.0f);
 	int rightCell = WorldToCellX(aabb.x + aabb.width - 2.0f);
 	int footCellY = WorldToCellY(aabb.y + aabb.height + 0.5f);
-	for (int y = 0; y < GRID_ROWS; ++y) {
-		for (int x = 0; x < GRID_COLS; ++x) {
-			TileType t = ed->tiles[y][x];
-			if (IsSolidTile(t)) {
-				Rectangle r = TileRect(x, y);
-				if (g->onGround && y == footCellY && x >= leftCell && x <= rightCell) {
-					r.y += 1.0f;
-				}
-				Rectangle src = ChooseBlockSrc(ed, x, y);
-				DrawBlock(r, src);
-			} else if (IsHazardTile(t)) {
-				Rectangle lr = LaserStripeRect((Vector2){CellToWorld(x), CellToWorld(y)});
-				DrawRectangleRec(lr, RED);
-			} else if (IsSpawnerTile(t)) {
-				Rectangle r = TileRect(x, y);
-				Color c = (Color){120, 40, 200, 255};
-				DrawRectangleRounded(r, 0.35f, 6, c);
-				DrawRectangleLinesEx(r, 2.0f, (Color){90, 20, 160, 255});
-			}
+	int x0, y0, x1, y1;
+	ViewCells(ed, Render_ViewRect(w->camera), &x0, &y0, &x1, &y1);
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			bool underFoot = g->onGround && y == footCellY && x >= leftCell && x <= rightCell;
+			DrawTile(ed, x, y, underFoot ? 1.0f : 0.0f);
 		}
 	}
 }
@@ -132,98 +164,91 @@ void DrawStats(const GameState *g) {
 static float gRunDustTimer = 0.0f;
 
 // --- Dust particles ---
-typedef struct DustParticle {
-	Vector2 pos;
-	Vector2 vel;
-	float radius;
-	float lifetime;
-	float age;
-	Color color;
-	bool active;
-} DustParticle;
-
-static DustParticle gDust[DUST_MAX];
-static int gDustCursor = 0;
-
-static float RandRange(float min, float max) {
-	float t = (float)GetRandomValue(0, 1000000) / 1000000.0f;
-	return min + t * (max - min);
-}
+// Largest single burst we spawn (death explosion); sizes the bulk random buffers
+#define DUST_BURST_MAX 64
 
-static void Dust_Reset(void) {
-	memset(gDust, 0, sizeof(gDust));
-	gDustCursor = 0;
+// Cosmetic stream only: particle spawns must never shift gameplay randomness
+static void RandFill(World *w, float *out, int count, float min, float max) {
+	Rng_FillRange(&w->rng.streams[RNG_STREAM_COSMETIC], out, count, min, max);
 }
 
-static void Dust_SpawnOne(Vector2 pos, Vector2 vel, float radius, float life) {
-	int idx = gDustCursor;
-	gDustCursor = (gDustCursor + 1) % DUST_MAX;
-	gDust[idx].pos = pos;
-	gDust[idx].vel = vel;
-	gDust[idx].radius = radius;
-	gDust[idx].lifetime = life;
-	gDust[idx].age = 0.0f;
-	gDust[idx].color = (Color){200, 200, 200, 255};
-	gDust[idx].active = true;
+static DustParticle *Dust_SpawnOne(World *w, Vector2 pos, Vector2 vel, float radius, float life) {
+	DustParticle *p = &w->dust[w->dustCursor];
+	w->dustCursor = (w->dustCursor + 1) % DUST_MAX;
+	p->pos = pos;
+	p->vel = vel;
+	p->radius = radius;
+	p->lifetime = life;
+	p->age = 0.0f;
+	p->color = (Color){200, 200, 200, 255};
+	p->active = true;
+	return p;
 }
 
-static void Dust_Burst(Vector2 origin, float dirSign, int count, float baseSpeed) {
+static void Dust_Burst(World *w, Vector2 origin, float dirSign, int count, float baseSpeed) {
+	if (count > DUST_BURST_MAX) count = DUST_BURST_MAX;
+	float speedMul[DUST_BURST_MAX], jitterX[DUST_BURST_MAX], lift[DUST_BURST_MAX];
+	float radius[DUST_BURST_MAX], life[DUST_BURST_MAX];
+	RandFill(w, speedMul, count, 0.55f, 0.95f);
+	RandFill(w, jitterX, count, -40.0f, 40.0f);
+	RandFill(w, lift, count, 0.35f, 0.55f);
+	RandFill(w, radius, count, 3.0f, 7.0f);
+	RandFill(w, life, count, 0.35f, 0.60f);
 	for (int i = 0; i < count; ++i) {
-		float vx = (baseSpeed * RandRange(0.55f, 0.95f)) * dirSign + RandRange(-40.0f, 40.0f);
-		float vy = -fabsf(baseSpeed) * RandRange(0.35f, 0.55f);
-		Vector2 vel = (Vector2){vx, vy};
-		float radius = RandRange(3.0f, 7.0f);
-		float life = RandRange(0.35f, 0.60f);
-		Dust_SpawnOne(origin, vel, radius, life);
+		float vx = (baseSpeed * speedMul[i]) * dirSign + jitterX[i];
+		float vy = -fabsf(baseSpeed) * lift[i];
+		Dust_SpawnOne(w, origin, (Vector2){vx, vy}, radius[i], life[i]);
 	}
 }
 
-void Render_SpawnJumpDust(const GameState *g) {
-	Rectangle aabb = PlayerAABB(g);
+void Render_SpawnJumpDust(World *w) {
+	Rectangle aabb = PlayerAABB(w);
 	float footY = aabb.y + aabb.height * 1.5f;
 	Vector2 center = (Vector2){aabb.x + aabb.width * 0.5f, footY};
 	// Burst straight out from under the player to keep dust under the feet
-	Dust_Burst(center, -0.4f, 12, 200.0f);
-	Dust_Burst(center, 0.4f, 12, 200.0f);
+	Dust_Burst(w, center, -0.4f, 12, 200.0f);
+	Dust_Burst(w, center, 0.4f, 12, 200.0f);
 	// Slightly upward puff to fill between feet
-	Dust_Burst(center, 0.0f, 12, 180.0f);
+	Dust_Burst(w, center, 0.0f, 12, 180.0f);
 }
 
-void Render_SpawnLandDust(const GameState *g) {
-	Rectangle aabb = PlayerAABB(g);
+void Render_SpawnLandDust(World *w) {
+	const GameState *g = &w->game;
+	Rectangle aabb = PlayerAABB(w);
 	Vector2 left = (Vector2){aabb.x + aabb.width * 0.2f, aabb.y + aabb.height * 1.5f};
 	Vector2 right = (Vector2){aabb.x + aabb.width * 0.8f, left.y};
 	float speed = 240.0f + fabsf(g->playerVel.x) * 0.2f;
-	Dust_Burst(left, -1.0f, 8, speed);
-	Dust_Burst(right, 1.0f, 8, speed);
+	Dust_Burst(w, left, -1.0f, 8, speed);
+	Dust_Burst(w, right, 1.0f, 8, speed);
 }
 
-void Render_SpawnWallJumpDust(const GameState *g, int wallDir) {
-	Rectangle aabb = PlayerAABB(g);
+void Render_SpawnWallJumpDust(World *w, int wallDir) {
+	Rectangle aabb = PlayerAABB(w);
 	float x = (wallDir < 0) ? aabb.x - 2.0f : (aabb.x + aabb.width + 2.0f);
 	float midY = aabb.y + aabb.height * 0.6f;
 	Vector2 origin = (Vector2){x, midY};
 	float dir = (wallDir < 0) ? -1.0f : 1.0f;
-	Dust_Burst(origin, dir, 10, 240.0f);
+	Dust_Burst(w, origin, dir, 10, 240.0f);
 }
 
-void Render_SpawnDeathExplosion(const GameState *g) {
-	Rectangle aabb = PlayerAABB(g);
+void Render_SpawnDeathExplosion(World *w) {
+	Rectangle aabb = PlayerAABB(w);
 	Vector2 center = (Vector2){aabb.x + aabb.width * 0.5f, aabb.y + aabb.height * 0.5f};
-	for (int i = 0; i < 64; ++i) {
-		float angle = RandRange(0.0f, 6.28318f);
-		float speed = RandRange(180.0f, 360.0f);
-		Vector2 vel = (Vector2){cosf(angle) * speed, sinf(angle) * speed};
-		float r = RandRange(3.5f, 6.5f);
-		float life = RandRange(0.35f, 0.6f);
-		Dust_SpawnOne(center, vel, r, life);
-		gDust[(gDustCursor + DUST_MAX - 1) % DUST_MAX].color = (Color){220, 40, 40, 255};
+	float angle[DUST_BURST_MAX], speed[DUST_BURST_MAX], radius[DUST_BURST_MAX], life[DUST_BURST_MAX];
+	RandFill(w, angle, DUST_BURST_MAX, 0.0f, 6.28318f);
+	RandFill(w, speed, DUST_BURST_MAX, 180.0f, 360.0f);
+	RandFill(w, radius, DUST_BURST_MAX, 3.5f, 6.5f);
+	RandFill(w, life, DUST_BURST_MAX, 0.35f, 0.6f);
+	for (int i = 0; i < DUST_BURST_MAX; ++i) {
+		Vector2 vel = (Vector2){cosf(angle[i]) * speed[i], sinf(angle[i]) * speed[i]};
+		DustParticle *p = Dust_SpawnOne(w, center, vel, radius[i], life[i]);
+		p->color = (Color){220, 40, 40, 255};
 	}
 }
 
-static void Dust_Update(float dt) {
+static void Dust_Update(World *w, float dt) {
 	for (int i = 0; i < DUST_MAX; ++i) {
-		DustParticle *p = &gDust[i];
+		DustParticle *p = &w->dust[i];
 		if (!p->active) continue;
 		p->age += dt;
 		if (p->age >= p->lifetime) {
@@ -237,10 +262,13 @@ static void Dust_Update(float dt) {
 	}
 }
 
-static void Dust_Draw(void) {
+static void Dust_Draw(const World *w) {
+	Rectangle view = Render_ViewRect(w->camera);
 	for (int i = 0; i < DUST_MAX; ++i) {
-		const DustParticle *p = &gDust[i];
+		const DustParticle *p = &w->dust[i];
 		if (!p->active) continue;
+		if (p->pos.x + p->radius < view.x || p->pos.x - p->radius > view.x + view.width) continue;
+		if (p->pos.y + p->radius < view.y || p->pos.y - p->radius > view.y + view.height) continue;
 		float t = p->age / p->lifetime;
 		if (t < 0.0f) t = 0.0f;
 		if (t > 1.0f) t = 1.0f;
@@ -252,9 +280,9 @@ static void Dust_Draw(void) {
 	}
 }
 
-void Render_DrawDust(float dt) {
-	Dust_Update(dt);
-	Dust_Draw();
+void Render_DrawDust(World *w, float dt) {
+	Dust_Update(w, dt);
+	Dust_Draw(w);
 }
 
 typedef struct {
@@ -312,7 +340,8 @@ static Rectangle WarriorFrameRect(int frameIndex) {
 	return (Rectangle){(float)(col * WARRIOR_FRAME_W), (float)(row * WARRIOR_FRAME_H), (float)WARRIOR_FRAME_W, (float)WARRIOR_FRAME_H};
 }
 
-static void RenderPlayerWarrior(const GameState *g) {
+static void RenderPlayerWarrior(const World *w) {
+	const GameState *g = &w->game;
 	if (g->hidden || gWarriorSheet.id == 0) return;
 	static int sLastAnim = -1;
 	static float sAnimTime = 0.0f;
@@ -339,7 +368,7 @@ static void RenderPlayerWarrior(const GameState *g) {
 	bool atPeak = (!g->onGround) && !rising && !falling;
 	bool edgeHang = g->edgeHang;
 	bool wallStick = (!g->onGround) && !edgeHang && (g->wallSliding || g->wallContactLeft || g->wallContactRight || g->wallStickTimer > 0.0f);
-	bool dying = Game_IsDying();
+	bool dying = Game_IsDying(w);
 	bool hurt = g->hurtTimer > 0.0f;
 	float overrideT = -1.0f;
 	float slideExitDuration = (float)gWarriorAnims[WA_SLIDE_EXIT].frameCount / gWarriorAnims[WA_SLIDE_EXIT].fps;
@@ -437,7 +466,7 @@ static void RenderPlayerWarrior(const GameState *g) {
 		src.width = -src.width;
 		src.x -= pivotSrcX * 0.5f;
 	}
-	Rectangle aabb = PlayerAABB(g);
+	Rectangle aabb = PlayerAABB(w);
 
 	float dstX = g->playerPos.x - dstW * 0.5f + pivotWorldX * 1.2f;
 	// float dstY = g->playerPos.y - dstH * 0.5f + pivotWorldY; // + g->groundSink;
@@ -525,7 +554,6 @@ bool Render_Init(void) {
 	    .checkBlock = CheckBlockForAutotiler,
 	    .layout = layout};
 	bool autotilerReady = Autotiler_Init(&autotilerConfig);
-	Dust_Reset();
 	// Return success if at least one of the core sprites loaded; fallback drawing still works
 	bool spritesReady = (gWarriorSheet.id != 0);
 	return spritesReady && autotilerReady;
@@ -542,12 +570,11 @@ void Render_Deinit(void) {
 		gWarriorSheet.id = 0;
 	}
 	gRunDustTimer = 0.0f;
-	Dust_Reset();
 }
 
-void RenderPlayer(const GameState *g) {
+void RenderPlayer(const World *w) {
 	// Choose animation based on simple state: running vs idle
-	if (g->hidden) return;
+	if (w->game.hidden) return;
 
-	RenderPlayerWarrior(g);
+	RenderPlayerWarrior(w);
 }
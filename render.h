@@ -8,22 +8,40 @@
 #define LASER_STRIPE_THICKNESS 3.0f
 #define LASER_STRIPE_OFFSET 1.0f
 
-Rectangle PlayerAABB(const GameState *g);
+struct World;
+
+// --- Dust particles (cosmetic, owned by the World) ---
+typedef struct DustParticle {
+	Vector2 pos;
+	Vector2 vel;
+	float radius;
+	float lifetime;
+	float age;
+	Color color;
+	bool active;
+} DustParticle;
+
+Rectangle PlayerAABB(const struct World *w);
 Rectangle ExitAABB(const GameState *g);
 Rectangle TileRect(int cx, int cy);
 Rectangle LaserStripeRect(Vector2 laserPos);
 Rectangle LaserCollisionRect(Vector2 laserPos);
 
-void RenderTiles(const LevelEditorState *ed);
-void RenderTilesGameplay(const LevelEditorState *ed, const GameState *g);
+// Camera: world-space rectangle currently on screen, and follow-with-clamp to the level bounds
+Rectangle Render_ViewRect(Camera2D cam);
+void Render_FollowCamera(struct World *w, Vector2 focus);
+
+// Tile drawing is culled to the cells overlapping the view rectangle
+void RenderTiles(const LevelEditorState *ed, Rectangle view);
+void RenderTilesGameplay(const struct World *w);
 void DrawStats(const GameState *g);
 
 // Sprites and animated rendering
 bool Render_Init(void);
 void Render_Deinit(void);
-void RenderPlayer(const GameState *g);
-void Render_DrawDust(float dt);
-void Render_SpawnJumpDust(const GameState *g);
-void Render_SpawnLandDust(const GameState *g);
-void Render_SpawnWallJumpDust(const GameState *g, int wallDir);
-void Render_SpawnDeathExplosion(const GameState *g);
+void RenderPlayer(const struct World *w);
+void Render_DrawDust(struct World *w, float dt);
+void Render_SpawnJumpDust(struct World *w);
+void Render_SpawnLandDust(struct World *w);
+void Render_SpawnWallJumpDust(struct World *w, int wallDir);
+void Render_SpawnDeathExplosion(struct World *w);
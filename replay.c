@@ -0,0 +1,195 @@
+#include "replay.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "world.h"
+
+// File layout (little-endian):
+//   "GRRP" u16 version, u16 pathLen, path bytes, u64 seed, u32 hashInterval, u32 enemyCapacity,
+//   u32 tickCount, tickCount input bytes, u32 hashCount, hashCount x (u32 tick, HASH_SUB_COUNT x u64)
+// Version 1 has no enemyCapacity; those runs used ENEMY_DEFAULT_CAPACITY.
+static const char REPLAY_MAGIC[4] = {'G', 'R', 'R', 'P'};
+#define REPLAY_VERSION 2
+
+enum {
+	INPUT_BIT_LEFT = 1 << 0,
+	INPUT_BIT_RIGHT = 1 << 1,
+	INPUT_BIT_DOWN = 1 << 2,
+	INPUT_BIT_JUMP_DOWN = 1 << 3,
+	INPUT_BIT_JUMP_PRESSED = 1 << 4,
+};
+
+static uint8_t PackInput(const PlayerInput *in) {
+	uint8_t b = 0;
+	if (in->left) b |= INPUT_BIT_LEFT;
+	if (in->right) b |= INPUT_BIT_RIGHT;
+	if (in->down) b |= INPUT_BIT_DOWN;
+	if (in->jumpDown) b |= INPUT_BIT_JUMP_DOWN;
+	if (in->jumpPressed) b |= INPUT_BIT_JUMP_PRESSED;
+	return b;
+}
+
+static void UnpackInput(uint8_t b, PlayerInput *out) {
+	out->left = (b & INPUT_BIT_LEFT) != 0;
+	out->right = (b & INPUT_BIT_RIGHT) != 0;
+	out->down = (b & INPUT_BIT_DOWN) != 0;
+	out->jumpDown = (b & INPUT_BIT_JUMP_DOWN) != 0;
+	out->jumpPressed = (b & INPUT_BIT_JUMP_PRESSED) != 0;
+}
+
+static bool WriteLE(FILE *f, uint64_t v, int bytes) {
+	unsigned char buf[8];
+	for (int i = 0; i < bytes; i++) buf[i] = (unsigned char)(v >> (8 * i));
+	return fwrite(buf, 1, (size_t)bytes, f) == (size_t)bytes;
+}
+
+static bool ReadLE(FILE *f, uint64_t *v, int bytes) {
+	unsigned char buf[8];
+	if (fread(buf, 1, (size_t)bytes, f) != (size_t)bytes) return false;
+	uint64_t x = 0;
+	for (int i = 0; i < bytes; i++) x |= (uint64_t)buf[i] << (8 * i);
+	*v = x;
+	return true;
+}
+
+static void AppendHash(Replay *r, const World *w) {
+	if (r->hashCount >= sizeof(r->hashes) / sizeof(r->hashes[0])) return;
+	World_Hash(w, &r->hashes[r->hashCount++]);
+}
+
+void Replay_Begin(Replay *r, const World *w) {
+	snprintf(r->levelPath, sizeof(r->levelPath), "%s", w->levelPath);
+	r->seed = RNG_DEFAULT_SEED;
+	r->hashInterval = STATE_HASH_INTERVAL;
+	r->enemyCapacity = (uint32_t)w->enemyCapacity;
+	r->tickCount = 0;
+	r->truncated = false;
+	r->hashCount = 0;
+	AppendHash(r, w);
+}
+
+void Replay_TruncateTo(Replay *r, uint32_t tick) {
+	if (r->tickCount > tick) r->tickCount = tick;
+	while (r->hashCount > 0 && r->hashes[r->hashCount - 1].tick > tick) r->hashCount--;
+}
+
+void Replay_RecordTick(Replay *r, const World *w) {
+	uint32_t t = w->tick;
+	if (t == 0) return;
+	if (t > REPLAY_MAX_TICKS) {
+		r->truncated = true;
+		return;
+	}
+	// Keyed by tick, so re-recording after a rewind overwrites the abandoned branch
+	Replay_TruncateTo(r, t - 1);
+	r->inputs[t - 1] = PackInput(&w->input);
+	r->tickCount = t;
+	if (t % r->hashInterval == 0) AppendHash(r, w);
+}
+
+bool Replay_Save(const Replay *r, const char *path) {
+	FILE *f = fopen(path, "wb");
+	if (!f) return false;
+	size_t pathLen = strlen(r->levelPath);
+	bool ok = fwrite(REPLAY_MAGIC, 1, 4, f) == 4;
+	ok = ok && WriteLE(f, REPLAY_VERSION, 2);
+	ok = ok && WriteLE(f, pathLen, 2);
+	ok = ok && fwrite(r->levelPath, 1, pathLen, f) == pathLen;
+	ok = ok && WriteLE(f, r->seed, 8);
+	ok = ok && WriteLE(f, r->hashInterval, 4);
+	ok = ok && WriteLE(f, r->enemyCapacity, 4);
+	ok = ok && WriteLE(f, r->tickCount, 4);
+	ok = ok && fwrite(r->inputs, 1, r->tickCount, f) == r->tickCount;
+	ok = ok && WriteLE(f, r->hashCount, 4);
+	for (uint32_t i = 0; ok && i < r->hashCount; i++) {
+		ok = WriteLE(f, r->hashes[i].tick, 4);
+		for (int s = 0; ok && s < HASH_SUB_COUNT; s++) ok = WriteLE(f, r->hashes[i].sub[s], 8);
+	}
+	if (fclose(f) != 0) ok = false;
+	return ok;
+}
+
+bool Replay_Load(Replay *r, const char *path) {
+	FILE *f = fopen(path, "rb");
+	if (!f) return false;
+	char magic[4];
+	uint64_t version = 0, pathLen = 0, v = 0;
+	bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, REPLAY_MAGIC, 4) == 0;
+	ok = ok && ReadLE(f, &version, 2) && version >= 1 && version <= REPLAY_VERSION;
+	ok = ok && ReadLE(f, &pathLen, 2) && pathLen < sizeof(r->levelPath);
+	ok = ok && fread(r->levelPath, 1, (size_t)pathLen, f) == pathLen;
+	if (ok) r->levelPath[pathLen] = '\0';
+	ok = ok && ReadLE(f, &r->seed, 8);
+	ok = ok && ReadLE(f, &v, 4) && v > 0;
+	r->hashInterval = (uint32_t)v;
+	v = ENEMY_DEFAULT_CAPACITY;
+	if (version >= 2) ok = ok && ReadLE(f, &v, 4) && v >= 1 && v <= ENEMY_MAX_CAPACITY;
+	r->enemyCapacity = (uint32_t)v;
+	ok = ok && ReadLE(f, &v, 4) && v <= REPLAY_MAX_TICKS;
+	r->tickCount = (uint32_t)v;
+	ok = ok && fread(r->inputs, 1, r->tickCount, f) == r->tickCount;
+	ok = ok && ReadLE(f, &v, 4) && v <= sizeof(r->hashes) / sizeof(r->hashes[0]);
+	r->hashCount = (uint32_t)v;
+	for (uint32_t i = 0; ok && i < r->hashCount; i++) {
+		ok = ReadLE(f, &v, 4);
+		r->hashes[i].tick = (uint32_t)v;
+		for (int s = 0; ok && s < HASH_SUB_COUNT; s++) ok = ReadLE(f, &r->hashes[i].sub[s], 8);
+	}
+	r->truncated = false;
+	fclose(f);
+	return ok;
+}
+
+bool Replay_WriteTrace(const Replay *r, const char *path) {
+	FILE *f = fopen(path, "w");
+	if (!f) return false;
+	fprintf(f, "# level %s\n# seed %016" PRIx64 "\n# enemies %u\n# tick", r->levelPath, r->seed, (unsigned)r->enemyCapacity);
+	for (int s = 0; s < HASH_SUB_COUNT; s++) fprintf(f, " %s", WorldHash_SubsystemName(s));
+	fprintf(f, "\n");
+	for (uint32_t i = 0; i < r->hashCount; i++) {
+		fprintf(f, "%u", (unsigned)r->hashes[i].tick);
+		for (int s = 0; s < HASH_SUB_COUNT; s++) fprintf(f, " %016" PRIx64, r->hashes[i].sub[s]);
+		fprintf(f, "\n");
+	}
+	return fclose(f) == 0;
+}
+
+bool Replay_Verify(const Replay *r, World *w, ReplayVerifyResult *out) {
+	memset(out, 0, sizeof(*out));
+	out->mismatchSubsystem = -1;
+	World_Init(w);
+	w->headless = true;
+	if (!Enemy_SetCapacity(w, (int)r->enemyCapacity)) return false; // out of memory: not verified either way
+	snprintf(w->levelPath, sizeof(w->levelPath), "%s", r->levelPath);
+	if (!LoadLevelBinary(w->levelPath, &w->game, &w->level)) {
+		out->levelMissing = true;
+		return false;
+	}
+	Game_StartRun(w);
+	Rng_SeedAll(&w->rng, r->seed);
+
+	uint32_t next = 0;
+	for (uint32_t t = 0;; t++) {
+		for (; next < r->hashCount && r->hashes[next].tick <= t; next++) {
+			if (r->hashes[next].tick != t) continue;
+			WorldHash got;
+			World_Hash(w, &got);
+			int sub = WorldHash_FirstMismatch(&r->hashes[next], &got);
+			if (sub >= 0) {
+				out->mismatchTick = t;
+				out->mismatchSubsystem = sub;
+				out->expected = r->hashes[next].sub[sub];
+				out->actual = got.sub[sub];
+				return false;
+			}
+			out->hashesMatched++;
+			out->lastMatchTick = t;
+		}
+		if (t >= r->tickCount) break;
+		UnpackInput(r->inputs[t], &w->input);
+		UpdateGame(w, BASE_DT);
+		out->ticksSimulated = t + 1;
+	}
+	out->ok = true;
+	return true;
+}
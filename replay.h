@@ -0,0 +1,46 @@
+// Input replays with periodic state hashes; playback reports the first desync
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "statehash.h"
+
+#define REPLAY_DIR "replays"
+#define REPLAY_LAST_FILE REPLAY_DIR "/last.grr"
+#define REPLAY_LAST_TRACE REPLAY_DIR "/last.trace"
+
+struct World;
+
+typedef struct Replay {
+	char levelPath[260];
+	uint64_t seed;
+	uint32_t hashInterval;
+	uint32_t enemyCapacity; // pool size the run was played with (--enemies); the enemies hash covers it
+	uint32_t tickCount; // inputs[0..tickCount) drive ticks 1..tickCount
+	bool truncated; // the run outlasted REPLAY_MAX_TICKS
+	uint8_t inputs[REPLAY_MAX_TICKS]; // packed PlayerInput per tick
+	uint32_t hashCount;
+	WorldHash hashes[REPLAY_MAX_TICKS / STATE_HASH_INTERVAL + 1]; // ascending by tick, starting at tick 0
+} Replay;
+
+typedef struct ReplayVerifyResult {
+	bool ok;
+	bool levelMissing; // the recorded level file could not be loaded
+	uint32_t ticksSimulated;
+	uint32_t hashesMatched;
+	uint32_t lastMatchTick; // divergence happened after this tick
+	uint32_t mismatchTick;
+	int mismatchSubsystem; // HashSubsystem, -1 when ok
+	uint64_t expected, actual;
+} ReplayVerifyResult;
+
+void Replay_Begin(Replay *r, const struct World *w); // start recording at the current (level-start) state
+void Replay_RecordTick(Replay *r, const struct World *w); // after each UpdateGame
+void Replay_TruncateTo(Replay *r, uint32_t tick); // forget input and hashes past `tick` (after a rewind)
+
+bool Replay_Save(const Replay *r, const char *path);
+bool Replay_Load(Replay *r, const char *path);
+bool Replay_WriteTrace(const Replay *r, const char *path); // text dump of the recorded hashes, one line per sample
+
+// Re-simulate headless in `scratch` and compare every recorded hash
+bool Replay_Verify(const Replay *r, struct World *scratch, ReplayVerifyResult *out);
@@ -0,0 +1,203 @@
+#include "rewind.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Record encoding: a stream of tokens over the XOR of the state against its base
+// (the previous tick for deltas, all zeroes for keyframes).
+//   0x80 | (n - 1)        -> n zero bytes (1..128)
+//   (n - 1), b0 .. b(n-1) -> n literal bytes (1..128)
+// Most of the state is unchanged between ticks (idle enemy slots, spawners, GameState
+// fields that only change on events), so deltas collapse to a few dozen bytes.
+#define RLE_ZERO_FLAG 0x80
+#define RLE_MAX_RUN 128
+
+static inline unsigned char XorAt(const unsigned char *cur, const unsigned char *base, size_t i) {
+	return base ? (unsigned char)(cur[i] ^ base[i]) : cur[i];
+}
+
+static size_t EncodeXorRle(const unsigned char *cur, const unsigned char *base, size_t n, unsigned char *out) {
+	size_t o = 0, i = 0;
+	while (i < n) {
+		size_t run = 0;
+		while (i + run < n && run < RLE_MAX_RUN && XorAt(cur, base, i + run) == 0) run++;
+		if (run > 0) {
+			out[o++] = (unsigned char)(RLE_ZERO_FLAG | (run - 1));
+			i += run;
+			continue;
+		}
+		// Literal run: stop at a pair of zero bytes so they can start a zero run instead
+		size_t start = i, len = 0;
+		while (i < n && len < RLE_MAX_RUN) {
+			if (XorAt(cur, base, i) == 0 && (i + 1 >= n || XorAt(cur, base, i + 1) == 0)) break;
+			i++;
+			len++;
+		}
+		out[o++] = (unsigned char)(len - 1);
+		for (size_t k = 0; k < len; k++) out[o++] = XorAt(cur, base, start + k);
+	}
+	return o;
+}
+
+// XOR the decoded bytes into dst
+static void DecodeXorRle(const unsigned char *in, size_t size, unsigned char *dst, size_t n) {
+	size_t i = 0, o = 0;
+	while (i < size && o < n) {
+		unsigned char t = in[i++];
+		size_t len = (size_t)(t & (RLE_ZERO_FLAG - 1)) + 1;
+		if (o + len > n) len = n - o;
+		if (t & RLE_ZERO_FLAG) {
+			o += len;
+			continue;
+		}
+		for (size_t k = 0; k < len; k++) dst[o + k] ^= in[i + k];
+		i += len;
+		o += len;
+	}
+}
+
+static inline int EntryIndex(const RewindBuffer *rb, int i) {
+	return (rb->first + i) % REWIND_MAX_TICKS;
+}
+
+// Drop the oldest keyframe and the deltas that depend on it, so the oldest entry is a keyframe again
+static void EvictOldest(RewindBuffer *rb) {
+	do {
+		rb->first = (rb->first + 1) % REWIND_MAX_TICKS;
+		rb->count--;
+	} while (rb->count > 0 && !rb->entries[rb->first].keyframe);
+	if (rb->count == 0) {
+		rb->first = 0;
+		rb->writeOffset = 0;
+	}
+}
+
+// Records are laid out back to back and wrap to offset 0 when they do not fit at the end
+static bool FindSpace(const RewindBuffer *rb, uint32_t size, uint32_t *outOffset) {
+	if (rb->count == 0) {
+		*outOffset = 0;
+		return size <= REWIND_BUFFER_BYTES;
+	}
+	uint32_t tail = rb->entries[rb->first].offset;
+	uint32_t head = rb->writeOffset;
+	if (head > tail) {
+		if (size <= REWIND_BUFFER_BYTES - head) {
+			*outOffset = head;
+			return true;
+		}
+		*outOffset = 0;
+		return size <= tail;
+	}
+	*outOffset = head;
+	return size <= tail - head;
+}
+
+static void RecountSinceKeyframe(RewindBuffer *rb) {
+	int n = 0;
+	for (int i = rb->count - 1; i >= 0; i--) {
+		n++;
+		if (rb->entries[EntryIndex(rb, i)].keyframe) break;
+	}
+	rb->sinceKeyframe = n;
+}
+
+void Rewind_Reset(RewindBuffer *rb) {
+	rb->first = 0;
+	rb->count = 0;
+	rb->writeOffset = 0;
+	rb->sinceKeyframe = 0;
+}
+
+void Rewind_Free(RewindBuffer *rb) {
+	free(rb->current);
+	free(rb->encoded);
+	rb->current = rb->encoded = NULL;
+	rb->stateBytes = 0;
+	Rewind_Reset(rb);
+}
+
+static size_t EnemyBytes(const World *w) { return (size_t)w->enemyCapacity * sizeof(Enemy); }
+
+// Size the state buffers for w; a different pool size makes the recorded ticks unusable
+static bool FitState(RewindBuffer *rb, const World *w) {
+	size_t bytes = WORLD_SIM_BYTES + EnemyBytes(w);
+	if (bytes == rb->stateBytes) return true;
+	Rewind_Free(rb);
+	rb->current = malloc(bytes);
+	rb->encoded = malloc(bytes + bytes / 128 + 32); // worst case per region: a token per 128 literals
+	if (!rb->current || !rb->encoded) {
+		Rewind_Free(rb);
+		return false;
+	}
+	rb->stateBytes = bytes;
+	return true;
+}
+
+// The two regions encode back to back; decoding the stream fills `current` in the same order
+static size_t EncodeState(const RewindBuffer *rb, const World *w, bool keyframe) {
+	size_t n = EncodeXorRle((const unsigned char *)w + WORLD_SIM_OFFSET, keyframe ? NULL : rb->current, WORLD_SIM_BYTES, rb->encoded);
+	if (EnemyBytes(w) == 0) return n;
+	return n + EncodeXorRle((const unsigned char *)w->enemies, keyframe ? NULL : rb->current + WORLD_SIM_BYTES, EnemyBytes(w), rb->encoded + n);
+}
+
+void Rewind_Push(RewindBuffer *rb, const World *w) {
+	if (!FitState(rb, w)) return;
+	if (rb->count == REWIND_MAX_TICKS) EvictOldest(rb);
+	bool keyframe = rb->count == 0 || rb->sinceKeyframe >= REWIND_KEYFRAME_TICKS;
+	uint32_t size = (uint32_t)EncodeState(rb, w, keyframe);
+	uint32_t offset = 0;
+	while (!FindSpace(rb, size, &offset)) {
+		if (rb->count == 0) return; // a single record exceeds the whole budget
+		EvictOldest(rb);
+		if (rb->count == 0 && !keyframe) {
+			// Everything the delta was relative to is gone; store this tick in full
+			keyframe = true;
+			size = (uint32_t)EncodeState(rb, w, true);
+		}
+	}
+	memcpy(rb->bytes + offset, rb->encoded, size);
+	RewindEntry *e = &rb->entries[EntryIndex(rb, rb->count)];
+	e->offset = offset;
+	e->size = size;
+	e->keyframe = keyframe;
+	rb->count++;
+	rb->writeOffset = offset + size;
+	rb->sinceKeyframe = keyframe ? 1 : rb->sinceKeyframe + 1;
+	memcpy(rb->current, (const unsigned char *)w + WORLD_SIM_OFFSET, WORLD_SIM_BYTES);
+	if (EnemyBytes(w) > 0) memcpy(rb->current + WORLD_SIM_BYTES, w->enemies, EnemyBytes(w));
+}
+
+bool Rewind_StepBack(RewindBuffer *rb, World *w) {
+	if (rb->count < 2 || rb->stateBytes != WORLD_SIM_BYTES + EnemyBytes(w)) return false;
+	const RewindEntry *newest = &rb->entries[EntryIndex(rb, rb->count - 1)];
+	if (!newest->keyframe) {
+		// XOR is its own inverse: applying the newest delta to its state yields the previous tick
+		DecodeXorRle(rb->bytes + newest->offset, newest->size, rb->current, rb->stateBytes);
+	} else {
+		// Crossing a keyframe: rebuild the previous tick forward from the keyframe before it
+		int k = rb->count - 2;
+		while (k > 0 && !rb->entries[EntryIndex(rb, k)].keyframe) k--;
+		memset(rb->current, 0, rb->stateBytes);
+		for (int i = k; i <= rb->count - 2; i++) {
+			const RewindEntry *e = &rb->entries[EntryIndex(rb, i)];
+			DecodeXorRle(rb->bytes + e->offset, e->size, rb->current, rb->stateBytes);
+		}
+	}
+	rb->count--;
+	const RewindEntry *prev = &rb->entries[EntryIndex(rb, rb->count - 1)];
+	rb->writeOffset = prev->offset + prev->size;
+	RecountSinceKeyframe(rb);
+	memcpy((unsigned char *)w + WORLD_SIM_OFFSET, rb->current, WORLD_SIM_BYTES);
+	if (EnemyBytes(w) > 0) memcpy(w->enemies, rb->current + WORLD_SIM_BYTES, EnemyBytes(w));
+	w->enemyFreeHint = 0;
+	return true;
+}
+
+int Rewind_TickCount(const RewindBuffer *rb) {
+	return rb->count;
+}
+
+size_t Rewind_BytesUsed(const RewindBuffer *rb) {
+	size_t total = 0;
+	for (int i = 0; i < rb->count; i++) total += rb->entries[EntryIndex(rb, i)].size;
+	return total;
+}
@@ -0,0 +1,34 @@
+// Rewind history: ring buffer of per-tick world states, XOR-delta + RLE compressed
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "world.h"
+
+typedef struct RewindEntry {
+	uint32_t offset; // start of the encoded record in `bytes`
+	uint32_t size; // encoded size in bytes
+	bool keyframe; // record holds the full state instead of a delta against the previous tick
+} RewindEntry;
+
+typedef struct RewindBuffer {
+	unsigned char bytes[REWIND_BUFFER_BYTES];
+	RewindEntry entries[REWIND_MAX_TICKS];
+	int first; // index of the oldest entry (always a keyframe)
+	int count;
+	uint32_t writeOffset; // end of the newest record
+	int sinceKeyframe; // ticks pushed since the last keyframe
+	// A tick's state is the World's simulation block followed by its enemy pool, so these are sized
+	// on the first push and again whenever the pool is resized (which drops the history)
+	size_t stateBytes;
+	unsigned char *current; // decoded state of the newest entry (delta base)
+	unsigned char *encoded;
+} RewindBuffer;
+
+void Rewind_Reset(RewindBuffer *rb); // drop all history
+void Rewind_Free(RewindBuffer *rb);
+void Rewind_Push(RewindBuffer *rb, const World *w); // record the world state after a tick
+bool Rewind_StepBack(RewindBuffer *rb, World *w); // restore the previous tick; false when history is exhausted
+int Rewind_TickCount(const RewindBuffer *rb);
+size_t Rewind_BytesUsed(const RewindBuffer *rb);
@@ -0,0 +1,95 @@
+#include "rng.h"
+
+// Below this many values the lane setup costs more than it saves
+#define RNG_BULK_MIN 16
+#define RNG_LANES 4
+
+static inline uint32_t Rotl32(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+static uint64_t SplitMix64(uint64_t *x) {
+	uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static inline float ToUnitFloat(uint32_t x) { return (float)(x >> 8) * 0x1p-24f; }
+
+void Rng_Seed(Rng *r, uint64_t seed) {
+	uint64_t sm = seed;
+	uint64_t a = SplitMix64(&sm);
+	uint64_t b = SplitMix64(&sm);
+	r->s[0] = (uint32_t)a;
+	r->s[1] = (uint32_t)(a >> 32);
+	r->s[2] = (uint32_t)b;
+	r->s[3] = (uint32_t)(b >> 32);
+	if ((r->s[0] | r->s[1] | r->s[2] | r->s[3]) == 0) r->s[0] = 1; // all-zero is a fixed point
+}
+
+uint32_t Rng_Next(Rng *r) {
+	uint32_t *s = r->s;
+	uint32_t result = Rotl32(s[1] * 5u, 7) * 9u;
+	uint32_t t = s[1] << 9;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = Rotl32(s[3], 11);
+	return result;
+}
+
+float Rng_Float01(Rng *r) { return ToUnitFloat(Rng_Next(r)); }
+
+float Rng_Range(Rng *r, float min, float max) { return min + Rng_Float01(r) * (max - min); }
+
+int Rng_RangeInt(Rng *r, int min, int max) {
+	if (max <= min) return min;
+	uint32_t span = (uint32_t)(max - min) + 1u;
+	// Multiply-shift maps to [0, span) without a division
+	return min + (int)(((uint64_t)Rng_Next(r) * span) >> 32);
+}
+
+void Rng_FillRange(Rng *r, float *out, int count, float min, float max) {
+	if (!out || count <= 0) return;
+	float span = max - min;
+	if (count < RNG_BULK_MIN) {
+		for (int i = 0; i < count; ++i) out[i] = min + Rng_Float01(r) * span;
+		return;
+	}
+	// Structure-of-arrays lane state: no dependency between lanes inside the step
+	uint32_t s0[RNG_LANES], s1[RNG_LANES], s2[RNG_LANES], s3[RNG_LANES];
+	for (int l = 0; l < RNG_LANES; ++l) {
+		const uint32_t hi = Rng_Next(r); // two statements: operand evaluation order is unspecified
+		const uint32_t lo = Rng_Next(r);
+		uint64_t sm = ((uint64_t)hi << 32) | lo;
+		uint64_t a = SplitMix64(&sm);
+		uint64_t b = SplitMix64(&sm);
+		s0[l] = (uint32_t)a | 1u;
+		s1[l] = (uint32_t)(a >> 32);
+		s2[l] = (uint32_t)b;
+		s3[l] = (uint32_t)(b >> 32);
+	}
+	int i = 0;
+	for (; i + RNG_LANES <= count; i += RNG_LANES) {
+		for (int l = 0; l < RNG_LANES; ++l) {
+			uint32_t res = s0[l] + s3[l]; // xoshiro128+: upper bits are what we keep
+			uint32_t t = s1[l] << 9;
+			s2[l] ^= s0[l];
+			s3[l] ^= s1[l];
+			s1[l] ^= s2[l];
+			s0[l] ^= s3[l];
+			s2[l] ^= t;
+			s3[l] = (s3[l] << 11) | (s3[l] >> 21);
+			out[i + l] = min + ToUnitFloat(res) * span;
+		}
+	}
+	for (; i < count; ++i) out[i] = min + Rng_Float01(r) * span;
+}
+
+void Rng_SeedAll(RngState *st, uint64_t seed) {
+	for (int i = 0; i < RNG_STREAM_COUNT; ++i) {
+		// Distinct per-stream seeds: mixing in the stream id keeps streams uncorrelated
+		Rng_Seed(&st->streams[i], seed ^ ((uint64_t)(i + 1) * 0xD1B54A32D192ED03ull));
+	}
+}
@@ -0,0 +1,35 @@
+// Seeded deterministic random streams (xoshiro128**; the bulk fill uses xoshiro128+) with serializable state
+#pragma once
+#include <stdint.h>
+
+// Independent streams so cosmetic effects never perturb gameplay randomness
+typedef enum {
+	RNG_STREAM_GAMEPLAY = 0,
+	RNG_STREAM_ENEMIES,
+	RNG_STREAM_COSMETIC,
+	RNG_STREAM_COUNT
+} RngStreamId;
+
+typedef struct Rng {
+	uint32_t s[4];
+} Rng;
+
+// Plain data: safe to memcpy, hash or write to disk as-is
+typedef struct RngState {
+	Rng streams[RNG_STREAM_COUNT];
+} RngState;
+
+void Rng_Seed(Rng *r, uint64_t seed);
+uint32_t Rng_Next(Rng *r);
+float Rng_Float01(Rng *r); // [0, 1)
+float Rng_Range(Rng *r, float min, float max); // [min, max)
+int Rng_RangeInt(Rng *r, int min, int max); // inclusive on both ends
+
+// Bulk fill out[0..count) with values in [min, max). Runs four independent xoshiro128+ lanes
+// so the inner loop vectorizes (+ has weak low bits, but floats only keep the top 24). Below
+// the bulk threshold it draws `count` values from the parent stream instead; above it the parent
+// advances by two draws per lane plus one per leftover value. Either way: a function of `count`.
+void Rng_FillRange(Rng *r, float *out, int count, float min, float max);
+
+// Seed every stream from one root seed (each stream gets a distinct derived seed)
+void Rng_SeedAll(RngState *st, uint64_t seed);
@@ -18,6 +18,7 @@ static const SettingItem ITEMS[] = {
     {"Left", ACT_LEFT, false},
     {"Right", ACT_RIGHT, false},
     {"Down / Crouch", ACT_DOWN, false},
+    {"Rewind", ACT_REWIND, false},
     {"Activate / Confirm", ACT_ACTIVATE, false},
     {"Back / Cancel", ACT_BACK, false},
 };
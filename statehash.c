@@ -0,0 +1,155 @@
+#include "statehash.h"
+#include <string.h>
+#include "world.h"
+
+// xxHash64-style accumulator: one multiply-rotate round per 64-bit word, avalanche at the end
+#define HASH_P1 0x9E3779B185EBCA87ull
+#define HASH_P2 0xC2B2AE3D27D4EB4Full
+#define HASH_P3 0x165667B19E3779F9ull
+
+typedef struct Hasher {
+	uint64_t acc;
+} Hasher;
+
+static inline uint64_t Rotl64(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+static inline void Hash_U64(Hasher *h, uint64_t v) {
+	h->acc ^= Rotl64(v * HASH_P2, 31) * HASH_P1;
+	h->acc = Rotl64(h->acc, 27) * HASH_P1 + HASH_P3;
+}
+
+static inline void Hash_U32(Hasher *h, uint32_t v) { Hash_U64(h, v); }
+static inline void Hash_Int(Hasher *h, int v) { Hash_U64(h, (uint32_t)v); }
+static inline void Hash_Bool(Hasher *h, bool v) { Hash_U64(h, v ? 1u : 0u); }
+
+// Bit pattern, not value: -0.0f vs 0.0f or a different rounding must show up as a mismatch
+static inline void Hash_Float(Hasher *h, float v) {
+	uint32_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	Hash_U64(h, bits);
+}
+
+static inline void Hash_Vec2(Hasher *h, Vector2 v) {
+	Hash_Float(h, v.x);
+	Hash_Float(h, v.y);
+}
+
+static uint64_t Hash_Finish(const Hasher *h) {
+	uint64_t x = h->acc;
+	x ^= x >> 33;
+	x *= HASH_P2;
+	x ^= x >> 29;
+	x *= HASH_P3;
+	x ^= x >> 32;
+	return x;
+}
+
+static uint64_t HashPlayer(const World *w) {
+	const GameState *g = &w->game;
+	Hasher h = {HASH_P1};
+	Hash_Int(&h, g->score);
+	Hash_Float(&h, g->runTime);
+	Hash_Vec2(&h, g->playerPos);
+	Hash_Vec2(&h, g->playerVel);
+	Hash_Bool(&h, g->onGround);
+	Hash_Float(&h, g->coyoteTimer);
+	Hash_Float(&h, g->jumpBufferTimer);
+	Hash_Vec2(&h, g->exitPos);
+	Hash_Bool(&h, g->crouching);
+	Hash_Float(&h, g->groundStickTimer);
+	Hash_Bool(&h, g->facingRight);
+	Hash_Bool(&h, g->jumpPrevDown);
+	Hash_Float(&h, g->wallCoyoteTimer);
+	Hash_Int(&h, g->wallCoyoteDir);
+	Hash_Bool(&h, g->wallSliding);
+	Hash_Bool(&h, g->wallContactLeft);
+	Hash_Bool(&h, g->wallContactRight);
+	Hash_Float(&h, g->wallStickTimer);
+	Hash_Bool(&h, g->edgeHang);
+	Hash_Int(&h, g->edgeHangDir);
+	Hash_Int(&h, g->health);
+	Hash_Int(&h, g->maxHealth);
+	Hash_Float(&h, g->invincibilityTimer);
+	// Animation state that picks the collision box (WarriorDimsForState)
+	Hash_Float(&h, g->hurtTimer);
+	Hash_Bool(&h, g->animDash);
+	Hash_Bool(&h, g->animSlide);
+	Hash_Bool(&h, g->animLadder);
+	Hash_Float(&h, g->crouchAnimTime); // decides the tick crouchAnimDir drops back to 0
+	Hash_Int(&h, g->crouchAnimDir);
+	Hash_Bool(&h, w->victory);
+	Hash_Bool(&h, w->death);
+	Hash_Float(&h, w->deathAnimTimer);
+	return Hash_Finish(&h);
+}
+
+static uint64_t HashEnemies(const World *w) {
+	Hasher h = {HASH_P1};
+	Hash_Int(&h, w->enemyCapacity); // a fuller pool spawns where a smaller one would refuse
+	for (int i = 0; i < w->enemyCapacity; i++) {
+		const Enemy *e = &w->enemies[i];
+		if (!e->active) continue;
+		Hash_Int(&h, i); // slot matters: it decides spawn reuse and resolution order
+		Hash_Vec2(&h, e->pos);
+		Hash_Vec2(&h, e->vel);
+		Hash_Int(&h, e->navLink);
+		Hash_Bool(&h, e->navAir);
+		Hash_U32(&h, e->lastTick);
+		Hash_Bool(&h, e->asleep);
+	}
+	return Hash_Finish(&h);
+}
+
+static uint64_t HashSpawners(const World *w) {
+	Hasher h = {HASH_P1};
+	Hash_Int(&h, w->spawnerCount);
+	for (int i = 0; i < w->spawnerCount; i++) {
+		Hash_Vec2(&h, w->spawners[i].pos);
+		Hash_U32(&h, w->spawners[i].intervalTicks);
+		Hash_U32(&h, w->spawners[i].nextTick);
+	}
+	Hash_Int(&h, w->waveCount);
+	for (int i = 0; i < w->waveCount; i++) {
+		Hash_Vec2(&h, w->waves[i].pos);
+		Hash_U32(&h, w->waves[i].nextTick);
+	}
+	return Hash_Finish(&h);
+}
+
+static uint64_t HashRng(const World *w) {
+	Hasher h = {HASH_P1};
+	for (int s = 0; s < RNG_STREAM_COUNT; s++) {
+		if (s == RNG_STREAM_COSMETIC) continue; // advanced by presentation, not by the simulation
+		for (int i = 0; i < 4; i++) Hash_U32(&h, w->rng.streams[s].s[i]);
+	}
+	return Hash_Finish(&h);
+}
+
+void World_Hash(const World *w, WorldHash *out) {
+	out->tick = w->tick;
+	out->sub[HASH_SUB_PLAYER] = HashPlayer(w);
+	out->sub[HASH_SUB_ENEMIES] = HashEnemies(w);
+	out->sub[HASH_SUB_SPAWNERS] = HashSpawners(w);
+	out->sub[HASH_SUB_RNG] = HashRng(w);
+}
+
+int WorldHash_FirstMismatch(const WorldHash *a, const WorldHash *b) {
+	for (int i = 0; i < HASH_SUB_COUNT; i++)
+		if (a->sub[i] != b->sub[i]) return i;
+	return -1;
+}
+
+const char *WorldHash_SubsystemName(int sub) {
+	switch (sub) {
+	case HASH_SUB_PLAYER:
+		return "player";
+	case HASH_SUB_ENEMIES:
+		return "enemies";
+	case HASH_SUB_SPAWNERS:
+		return "spawners";
+	case HASH_SUB_RNG:
+		return "rng";
+	default:
+		return "?";
+	}
+}
@@ -0,0 +1,27 @@
+// Per-subsystem hashes of the simulation state, for desync and determinism regression checks
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+struct World;
+
+typedef enum {
+	HASH_SUB_PLAYER = 0, // GameState sim fields + run outcome
+	HASH_SUB_ENEMIES, // active enemies
+	HASH_SUB_SPAWNERS, // spawner and wave positions and next firings
+	HASH_SUB_RNG, // RNG stream states
+	HASH_SUB_COUNT
+} HashSubsystem;
+
+typedef struct WorldHash {
+	uint32_t tick;
+	uint64_t sub[HASH_SUB_COUNT];
+} WorldHash;
+
+// Hash exactly the fields the simulation reads back, field by field, so struct padding and
+// presentation-only fields (sprite rotation, animation frames) never cause false mismatches. The
+// animation flags that choose the player's collision box are simulation state and are hashed.
+void World_Hash(const struct World *w, WorldHash *out);
+
+int WorldHash_FirstMismatch(const WorldHash *a, const WorldHash *b); // subsystem index, or -1 when equal
+const char *WorldHash_SubsystemName(int sub);
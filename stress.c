@@ -0,0 +1,159 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "stress.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "config.h"
+#include "enemy.h"
+#include "game.h"
+#include "levelbake.h"
+#include "physics.h"
+#include "render.h"
+#include "rng.h"
+#include "world.h"
+
+double Stress_Now(void) {
+#if defined(_WIN32)
+	return (double)clock() / CLOCKS_PER_SEC;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+typedef struct StressResult {
+	int requested, placed, activeAtEnd;
+	int cols, rows;
+	double placeSeconds, updateSeconds, renderSeconds;
+	EnemyPhaseTimes phases;
+	long long visible; // summed over ticks
+	bool ok;
+} StressResult;
+
+// Scatter `count` enemies over the open cells of the level, several to a cell once there are more
+// enemies than cells; the pool's overlap resolution spreads them out from there
+static int PlaceEnemies(World *w, int count) {
+	const LevelEditorState *ed = &w->level;
+	int *open = malloc((size_t)ed->cols * ed->rows * sizeof(int));
+	if (!open) return 0;
+	int openCount = 0;
+	for (int cy = 0; cy < ed->rows; ++cy)
+		for (int cx = 0; cx < ed->cols; ++cx)
+			if (!Physics_BlockAtCell(w, cx, cy)) open[openCount++] = cy * ed->cols + cx;
+	Rng rng;
+	Rng_Seed(&rng, RNG_DEFAULT_SEED);
+	int placed = 0;
+	const float slack = (float)SQUARE_SIZE - ROGUE_ENEMY_W;
+	for (int i = 0; i < count && openCount > 0; ++i) {
+		int cell = open[Rng_RangeInt(&rng, 0, openCount - 1)];
+		Vector2 pos = {CellToWorld(cell % ed->cols) + Rng_Range(&rng, 0.0f, slack), CellToWorld(cell / ed->cols) + Rng_Range(&rng, 0.0f, slack)};
+		if (Enemy_Spawn(w, pos)) placed++;
+	}
+	free(open);
+	return placed;
+}
+
+// Generated level for `count` enemies at a fixed density, so the runs compare how the pipeline
+// scales rather than how deep enemies stack: a walled box of floors STRESS_FLOOR_SPACING rows apart,
+// each with a gap every 24 columns to drop through, player bottom-left and exit bottom-right
+static void BuildArena(World *w, int count) {
+	LevelEditorState *ed = &w->level;
+	CreateDefaultLevel(&w->game, ed);
+	int rows = (int)ceilf(sqrtf((float)count * STRESS_CELLS_PER_ENEMY * 0.5f));
+	if (rows < GRID_ROWS) rows = GRID_ROWS;
+	if (rows > LEVEL_MAX_ROWS) rows = LEVEL_MAX_ROWS;
+	int cols = rows * 2 > LEVEL_MAX_COLS ? LEVEL_MAX_COLS : rows * 2;
+	if (!Level_Resize(ed, cols, rows)) return; // keeps the default level
+	Level_BeginBulk(ed);
+	for (int y = 0; y < rows; ++y)
+		for (int x = 0; x < cols; ++x) SetTile(ed, x, y, TILE_EMPTY);
+	FillPerimeter(ed);
+	for (int y = rows - 1 - STRESS_FLOOR_SPACING; y > 2; y -= STRESS_FLOOR_SPACING)
+		for (int x = 1; x < cols - 1; ++x)
+			if (x % 24 >= 3) SetTile(ed, x, y, TILE_BLOCK);
+	SetUniqueTile(ed, 1, rows - 2, TILE_PLAYER);
+	SetUniqueTile(ed, cols - 2, rows - 2, TILE_EXIT);
+	Level_EndBulk(ed);
+	w->game.playerPos = (Vector2){CellToWorld(1) + (float)SQUARE_SIZE * 0.5f, CellToWorld(rows - 2) + (float)SQUARE_SIZE * 0.5f};
+	w->game.exitPos = (Vector2){CellToWorld(cols - 2), CellToWorld(rows - 2)};
+}
+
+static void RunOne(const char *levelPath, int count, StressResult *r) {
+	static World w; // large: keep it off the stack
+	memset(r, 0, sizeof(*r));
+	r->requested = count;
+	World_Init(&w);
+	w.headless = true;
+	if (levelPath) {
+		snprintf(w.levelPath, sizeof(w.levelPath), "%s", levelPath);
+		if (!LoadLevelBinary(levelPath, &w.game, &w.level)) CreateDefaultLevel(&w.game, &w.level);
+	} else {
+		BuildArena(&w, count);
+	}
+	r->cols = w.level.cols;
+	r->rows = w.level.rows;
+	w.level.bake = LevelBake_Build(&w.level); // in memory: the run must not touch the bake cache
+	if (!Enemy_SetCapacity(&w, count > 0 ? count : 1)) {
+		World_Free(&w);
+		return;
+	}
+	Game_StartRun(&w);
+
+	double t = Stress_Now();
+	r->placed = PlaceEnemies(&w, count);
+	r->placeSeconds = Stress_Now() - t;
+
+	w.enemyProfile = &r->phases;
+	for (int tick = 0; tick < STRESS_TICKS; ++tick) {
+		memset(&w.input, 0, sizeof(w.input));
+		w.game.invincibilityTimer = ROGUE_INVINCIBILITY_TIME; // the player stands still and must outlive the horde
+		t = Stress_Now();
+		UpdateGame(&w, BASE_DT);
+		double mid = Stress_Now();
+		Render_FollowCamera(&w, w.game.playerPos);
+		r->visible += Enemy_CountVisible(&w, Render_ViewRect(w.camera));
+		r->updateSeconds += mid - t;
+		r->renderSeconds += Stress_Now() - mid;
+	}
+	w.enemyProfile = NULL;
+	for (int i = 0; i < w.enemyCapacity; ++i) r->activeAtEnd += w.enemies[i].active;
+	r->ok = r->placed == count;
+	World_Free(&w);
+}
+
+static void WriteJsonString(FILE *out, const char *s) {
+	fputc('"', out);
+	for (; *s; ++s) {
+		if (*s == '"' || *s == '\\') fputc('\\', out);
+		if ((unsigned char)*s < 0x20) fprintf(out, "\\u%04x", (unsigned char)*s);
+		else fputc(*s, out);
+	}
+	fputc('"', out);
+}
+
+int Stress_Run(const char *levelPath, const int *counts, int countCount, FILE *out) {
+	int failed = 0;
+	fprintf(out, "{\n  \"level\": ");
+	if (levelPath) WriteJsonString(out, levelPath);
+	else fprintf(out, "\"arena\"");
+	fprintf(out, ",\n  \"ticks\": %d,\n  \"runs\": [", STRESS_TICKS);
+	for (int i = 0; i < countCount; ++i) {
+		StressResult r;
+		RunOne(levelPath, counts[i], &r);
+		if (!r.ok) failed++;
+		const double perTick = 1000.0 / STRESS_TICKS;
+		fprintf(out, "%s\n    {\"enemies\": %d, \"cols\": %d, \"rows\": %d, \"placed\": %d, \"active_at_end\": %d, \"place_ms\": %.3f,", i ? "," : "",
+		        r.requested, r.cols, r.rows, r.placed, r.activeAtEnd, r.placeSeconds * 1000.0);
+		fprintf(out, " \"ticks_per_sec\": %.1f, \"visible_per_tick\": %.1f,\n", r.updateSeconds > 0.0 ? STRESS_TICKS / r.updateSeconds : 0.0,
+		        (double)r.visible / STRESS_TICKS);
+		fprintf(out, "     \"ms_per_tick\": {\"spawn\": %.4f, \"integrate\": %.4f, \"resolve\": %.4f, \"contacts\": %.4f, \"render\": %.4f, \"total\": %.4f}}",
+		        r.phases.spawn * perTick, r.phases.integrate * perTick, r.phases.resolve * perTick, r.phases.contacts * perTick,
+		        r.renderSeconds * perTick, (r.updateSeconds + r.renderSeconds) * perTick);
+	}
+	fprintf(out, "\n  ]\n}\n");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,11 @@
+// Horde stress mode: fill a level with N enemies, run it headless for STRESS_TICKS and report the
+// enemy pipeline's throughput and per-phase times as JSON
+#pragma once
+#include <stdio.h>
+
+double Stress_Now(void); // monotonic seconds, for timing phases without a window
+
+// One run per entry of `counts`, written to `out` as a single JSON object. Each run plays the level
+// at `levelPath` (the default level when it cannot be loaded), or with NULL a generated arena sized
+// to the enemy count. Returns 0 when every run placed all of its enemies.
+int Stress_Run(const char *levelPath, const int *counts, int countCount, FILE *out);
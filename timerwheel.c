@@ -0,0 +1,88 @@
+#include "timerwheel.h"
+
+#define NEAR_MASK (TIMER_WHEEL_NEAR - 1)
+#define FAR_MASK (TIMER_WHEEL_FAR - 1)
+#define FAR_SHIFT (TIMER_WHEEL_NEAR_BITS + TIMER_WHEEL_FAR_BITS)
+
+void TimerWheel_Reset(TimerWheel *tw, uint32_t now) {
+	tw->now = now;
+	for (int i = 0; i < TIMER_WHEEL_NEAR; ++i) tw->near[i] = -1;
+	for (int i = 0; i < TIMER_WHEEL_FAR; ++i) tw->far[i] = -1;
+	tw->overflow = -1;
+	for (int i = 0; i < TIMER_WHEEL_MAX_EVENTS; ++i) tw->events[i] = (TimerEvent){0, (int16_t)(i + 1), 0, 0};
+	tw->events[TIMER_WHEEL_MAX_EVENTS - 1].next = -1;
+	tw->freeList = 0;
+}
+
+// Slot list for an event due after tw->now: the near wheel within the current 256 ticks, the far
+// wheel within the current 16384, the overflow list beyond
+static int16_t *SlotFor(TimerWheel *tw, uint32_t due) {
+	if ((due >> TIMER_WHEEL_NEAR_BITS) == (tw->now >> TIMER_WHEEL_NEAR_BITS)) return &tw->near[due & NEAR_MASK];
+	if ((due >> FAR_SHIFT) == (tw->now >> FAR_SHIFT)) return &tw->far[(due >> TIMER_WHEEL_NEAR_BITS) & FAR_MASK];
+	return &tw->overflow;
+}
+
+static void Link(TimerWheel *tw, int16_t id) {
+	int16_t *slot = SlotFor(tw, tw->events[id].due);
+	tw->events[id].next = *slot;
+	*slot = id;
+}
+
+bool TimerWheel_Schedule(TimerWheel *tw, uint32_t due, uint8_t kind, uint16_t arg) {
+	int16_t id = tw->freeList;
+	if (id < 0) return false;
+	tw->freeList = tw->events[id].next;
+	if (due <= tw->now) due = tw->now + 1;
+	tw->events[id] = (TimerEvent){due, -1, kind, arg};
+	Link(tw, id);
+	return true;
+}
+
+// Move a coarser list's events down now that the wheel below has reached their range
+static void Cascade(TimerWheel *tw, int16_t *list) {
+	int16_t id = *list;
+	*list = -1;
+	while (id >= 0) {
+		int16_t next = tw->events[id].next;
+		Link(tw, id);
+		id = next;
+	}
+}
+
+static bool FiresBefore(const TimerEvent *a, const TimerEvent *b) {
+	return a->kind != b->kind ? a->kind < b->kind : a->arg < b->arg;
+}
+
+int TimerWheel_Advance(TimerWheel *tw, uint32_t tick, TimerEvent *out, int cap) {
+	int n = 0;
+	while ((int32_t)(tick - tw->now) > 0) {
+		uint32_t now = ++tw->now;
+		if ((now & NEAR_MASK) == 0) {
+			if (((now >> TIMER_WHEEL_NEAR_BITS) & FAR_MASK) == 0) Cascade(tw, &tw->overflow);
+			Cascade(tw, &tw->far[(now >> TIMER_WHEEL_NEAR_BITS) & FAR_MASK]);
+		}
+		int16_t *slot = &tw->near[now & NEAR_MASK];
+		int16_t id = *slot;
+		*slot = -1;
+		while (id >= 0) {
+			TimerEvent *ev = &tw->events[id];
+			int16_t next = ev->next;
+			if (n < cap) {
+				// Insertion sort: a tick fires a handful of events
+				int j = n++;
+				while (j > 0 && FiresBefore(ev, &out[j - 1])) {
+					out[j] = out[j - 1];
+					j--;
+				}
+				out[j] = *ev;
+				ev->next = tw->freeList;
+				tw->freeList = id;
+			} else {
+				ev->due = now + 1;
+				Link(tw, id);
+			}
+			id = next;
+		}
+	}
+	return n;
+}
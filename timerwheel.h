@@ -0,0 +1,37 @@
+// Hierarchical timer wheel keyed on the simulation tick: scheduling and firing cost O(1) per event
+// however many timers are pending. Plain data (indices, no pointers), so it lives in the World's
+// snapshotted block and rewinds with it.
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_MAX_EVENTS 128 // pending at once: one per spawner and per wave
+#define TIMER_WHEEL_NEAR_BITS 8 // 256 one-tick slots
+#define TIMER_WHEEL_FAR_BITS 6 // 64 slots of 256 ticks; anything later waits in the overflow list
+#define TIMER_WHEEL_NEAR (1 << TIMER_WHEEL_NEAR_BITS)
+#define TIMER_WHEEL_FAR (1 << TIMER_WHEEL_FAR_BITS)
+
+typedef struct TimerEvent {
+	uint32_t due; // tick it fires on
+	int16_t next; // next event in the same slot (or the free list), -1 ends it
+	uint8_t kind; // owner-defined, e.g. spawner or wave
+	uint16_t arg; // owner-defined, e.g. the spawner's index
+} TimerEvent;
+
+typedef struct TimerWheel {
+	uint32_t now; // last tick advanced to
+	int16_t near[TIMER_WHEEL_NEAR];
+	int16_t far[TIMER_WHEEL_FAR];
+	int16_t overflow;
+	int16_t freeList;
+	TimerEvent events[TIMER_WHEEL_MAX_EVENTS];
+} TimerWheel;
+
+// Drop every pending event and start counting from `now`
+void TimerWheel_Reset(TimerWheel *tw, uint32_t now);
+// Fire (kind, arg) on tick `due`; due ticks that already passed fire on the next advance. False when
+// TIMER_WHEEL_MAX_EVENTS are already pending.
+bool TimerWheel_Schedule(TimerWheel *tw, uint32_t due, uint8_t kind, uint16_t arg);
+// Step to `tick` and copy out the events that came due, ordered by (kind, arg) so handling them does
+// not depend on scheduling order. Events past `cap` stay pending for the next call.
+int TimerWheel_Advance(TimerWheel *tw, uint32_t tick, TimerEvent *out, int cap);
@@ -13,7 +13,7 @@ static Vector2 gUiLastMouse = {-9999.0f, -9999.0f};
 // Input gate
 static InputGateState gInputGate = IG_FREE;
 
-static Rectangle UiListItemRect(const UiListSpec *spec, int index) {
+Rectangle UiListItemRect(const UiListSpec *spec, int index) {
 	float x = 20.0f;
 	float y = spec->startY + index * spec->stepY;
 	float w = (float)(GetScreenWidth() - 40);
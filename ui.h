@@ -14,6 +14,7 @@ typedef struct {
 typedef const char *(*LabelAtFn)(int index, void *ud);
 
 void UiListHandle(const UiListSpec *spec, int *selected, int itemCount, bool *outActivated);
+Rectangle UiListItemRect(const UiListSpec *spec, int index); // row `index`, in screen space
 void UiListRenderCB(const UiListSpec *spec, int selected, int itemCount, LabelAtFn labelAt, void *ud, const char *title, const char *emptyMsg, const char *hint);
 
 void RenderMessageScreen(const char *firstText, Color firstColor, int firstFontSize, ...);
@@ -0,0 +1,23 @@
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#define _POSIX_C_SOURCE 200809L
+#define WORKER_THREADED 1
+#endif
+#include "worker.h"
+#ifdef WORKER_THREADED
+#include <pthread.h>
+#endif
+
+// Never joined: jobs finish or are flushed by their owner, and process exit ends the thread
+bool Worker_Running(Worker *w, void *(*main)(void *arg)) {
+	if (!w->started) {
+		w->started = true;
+#ifdef WORKER_THREADED
+		pthread_t thread;
+		w->running = pthread_create(&thread, NULL, main, NULL) == 0;
+		if (w->running) pthread_detach(thread);
+#else
+		(void)main;
+#endif
+	}
+	return w->running;
+}
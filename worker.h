@@ -0,0 +1,12 @@
+// Background workers: one detached thread per subsystem (saves, thumbnails, reachability, file
+// watching), started on first use and left running for the rest of the process
+#pragma once
+#include <stdbool.h>
+
+typedef struct Worker {
+	bool started; // a start was attempted
+	bool running; // the thread exists; false where there are no threads (web, Windows) or it failed
+} Worker;
+
+// Start `main` on its own thread the first time. False when there is none: do the work inline.
+bool Worker_Running(Worker *w, void *(*main)(void *arg));
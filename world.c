@@ -0,0 +1,47 @@
+#include "world.h"
+#include "enemynav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void World_Init(World *w) {
+	memset(w, 0, sizeof(*w));
+	snprintf(w->levelPath, sizeof(w->levelPath), "%s", LEVEL_FILE_BIN);
+	Rng_SeedAll(&w->rng, RNG_DEFAULT_SEED);
+	w->camera.zoom = 1.0f;
+}
+
+void World_Free(World *w) {
+	EnemyNav_Free(w);
+	Enemy_Free(w);
+	Level_Free(&w->level);
+}
+
+void World_Snapshot(const World *w, WorldSnapshot *out) {
+	out->valid = false;
+	if (out->enemyCapacity != w->enemyCapacity) {
+		free(out->enemies);
+		out->enemies = w->enemyCapacity > 0 ? malloc((size_t)w->enemyCapacity * sizeof(Enemy)) : NULL;
+		out->enemyCapacity = out->enemies ? w->enemyCapacity : 0;
+		if (out->enemyCapacity != w->enemyCapacity) return;
+	}
+	memcpy(out->bytes, (const unsigned char *)w + WORLD_SIM_OFFSET, WORLD_SIM_BYTES);
+	if (w->enemyCapacity > 0) memcpy(out->enemies, w->enemies, (size_t)w->enemyCapacity * sizeof(Enemy));
+	out->valid = true;
+}
+
+bool World_Restore(World *w, const WorldSnapshot *snap) {
+	if (!snap || !snap->valid) return false;
+	if (w->enemyCapacity != snap->enemyCapacity && !Enemy_SetCapacity(w, snap->enemyCapacity)) return false;
+	memcpy((unsigned char *)w + WORLD_SIM_OFFSET, snap->bytes, WORLD_SIM_BYTES);
+	if (snap->enemyCapacity > 0) memcpy(w->enemies, snap->enemies, (size_t)snap->enemyCapacity * sizeof(Enemy));
+	w->enemyFreeHint = 0;
+	return true;
+}
+
+void WorldSnapshot_Free(WorldSnapshot *snap) {
+	free(snap->enemies);
+	snap->enemies = NULL;
+	snap->enemyCapacity = 0;
+	snap->valid = false;
+}
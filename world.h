@@ -0,0 +1,80 @@
+// Simulation world: every piece of per-run state, so independent worlds can be stepped side by side
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "enemy.h"
+#include "game.h"
+#include "level.h"
+#include "player.h"
+#include "render.h"
+#include "rng.h"
+#include "timerwheel.h"
+
+typedef struct World {
+	// --- Level ---
+	// Tiles live on the heap and are read-only during play, so snapshots and rewind skip them.
+	LevelEditorState level; // tiles + editor cursor/tool
+
+	// --- Simulation state ---
+	// Everything from `game` up to `levelPath` is captured by WorldSnapshot and the rewind
+	// history as one contiguous block, so keep new simulation fields inside this section.
+	GameState game;
+
+	// Run outcome
+	bool victory;
+	bool death;
+	float deathAnimTimer;
+
+	// Enemies
+	EnemySpawner spawners[MAX_SPAWNERS];
+	int spawnerCount;
+	EnemyWave waves[LEVEL_MAX_WAVES];
+	int waveCount;
+	TimerWheel timers; // spawner and wave firings
+
+	RngState rng;
+	uint32_t tick; // fixed steps simulated since the level started
+
+	// --- Host / presentation state (not snapshotted) ---
+	char levelPath[260]; // file backing `level`
+	PlayerInput input; // sampled by the host before each tick
+
+	// Cosmetic particles (never read back by the simulation)
+	DustParticle dust[DUST_MAX];
+	int dustCursor;
+
+	Camera2D camera; // follows the player in play and the cursor in the editor
+
+	bool headless; // skip audio and other process-wide side effects (batch/threaded stepping)
+
+	struct EnemyNav *nav; // derived from `level` at load (enemynav.h); NULL: enemies chase directly
+
+	// Enemy pool: simulation state, but sized at run time (Enemy_SetCapacity), so it lives on the
+	// heap and World_Snapshot, the rewind history and the state hash carry it next to the block above
+	Enemy *enemies;
+	int enemyCapacity;
+	int enemyFreeHint; // no free slot below this index; reset to 0 whenever the pool is restored
+	struct EnemyScratch *enemyScratch; // enemy.c per-tick buffers, sized with the pool
+	EnemyPhaseTimes *enemyProfile; // --stress: Enemy_Update adds its phase times here; NULL otherwise
+} World;
+
+#define WORLD_SIM_OFFSET offsetof(World, game)
+#define WORLD_SIM_BYTES (offsetof(World, levelPath) - offsetof(World, game))
+
+// Everything a restart on the same level needs, restored with a single memcpy (no disk access)
+typedef struct WorldSnapshot {
+	bool valid;
+	unsigned char bytes[WORLD_SIM_BYTES];
+	Enemy *enemies; // copy of the pool, owned by the snapshot
+	int enemyCapacity;
+} WorldSnapshot;
+
+// Zero the world, set the default level path and seed its RNG streams
+void World_Init(World *w);
+void World_Free(World *w); // release the heap-owned level tiles and enemy pool
+
+void World_Snapshot(const World *w, WorldSnapshot *out);
+bool World_Restore(World *w, const WorldSnapshot *snap); // false if the snapshot was never taken
+void WorldSnapshot_Free(WorldSnapshot *snap);